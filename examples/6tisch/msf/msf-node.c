@@ -37,6 +37,12 @@
 #include "net/ipv6/simple-udp.h"
 #include "net/mac/tsch/sdn-statis.h"
 #include "net/routing/rpl-lite/rpl.h"
+#if WITH_TSCH_MONITOR
+#include "services/lwm2m/lwm2m-engine.h"
+#include "services/lwm2m/lwm2m-device.h"
+#include "services/lwm2m/lwm2m-server.h"
+#include "services/lwm2m/lwm2m-security.h"
+#endif
 
 
 #include "lib/sensors.h"
@@ -94,8 +100,15 @@ PROCESS_THREAD(msf_node_process, ev, data)
   PROCESS_BEGIN();
 
   serial_shell_init();
+#if WITH_TSCH_MONITOR
+  /* SNMP is started by the system, LwM2M is started here */
+  lwm2m_engine_init();
+  lwm2m_device_init();
+  lwm2m_security_init();
+  lwm2m_server_init();
+#endif
   sixtop_add_sf(&msf);
-  LOG_INFO("APP1_SEND_INTERVAL: %u\n", APP1_SEND_INTERVAL);
+  LOG_INFO("APP1_SEND_INTERVAL: %u\n", (unsigned)APP1_SEND_INTERVAL);
   if(APP1_SEND_INTERVAL > 0) {
     etimer_set(&et, APP1_SEND_INTERVAL);
 
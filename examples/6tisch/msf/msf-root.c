@@ -85,7 +85,7 @@ udp_rx_callback(struct simple_udp_connection *c,
              (uint8_t)data[9] << 24;
   
   LOG_INFO("11111111 |sr %d%d sr|d %d%d d|s %u s|as 0x%lx as|ar 0x%lx ar|c %d c|p %d p|", src_addr.u8[0], src_addr.u8[1], dest_addr.u8[0],
-                                                                                   dest_addr.u8[1], seq_num, sent_asn, tsch_current_asn.ls4b,
+                                                                                   dest_addr.u8[1], seq_num, (unsigned long)sent_asn, (unsigned long)tsch_current_asn.ls4b,
                                                                                    packetbuf_attr(PACKETBUF_ATTR_CHANNEL), sender_port);
   LOG_INFO_("\n");
 /*  if(linkaddr_cmp(&src_addr, &ter_dest) && seq_num > 500 && print_schedule == 0) {
@@ -123,8 +123,17 @@ points to simulate the MSF:
 //#define RPL_CONF_DEFAULT_LIFETIME_UNIT  120
 
 #define RPL_OF0_CONF_SR     RPL_OF0_FIXED_SR
+#if WITH_MSF_RPL_OF
+/* Prefer parents with spare schedule capacity */
+#define RPL_CONF_WITH_MC    1
+#define RPL_CONF_OF_OCP     RPL_OCP_MSF_CAPACITY
+#define RPL_CONF_SUPPORTED_OFS {&rpl_mrhof, &msf_rpl_of}
+struct rpl_of;
+extern struct rpl_of msf_rpl_of;
+#else /* WITH_MSF_RPL_OF */
 #define RPL_CONF_OF_OCP     RPL_OCP_OF0 /* tells to use OF0 for DAGs rooted at this node */
 #define RPL_CONF_SUPPORTED_OFS {&rpl_of0, &rpl_mrhof} /* tells to compile in support for both OF0 and MRHOF */
+#endif /* WITH_MSF_RPL_OF */
 
 //#define TSCH_CONF_DESYNC_THRESHOLD     (30 * TSCH_MAX_KEEPALIVE_TIMEOUT)
 //#define RPL_CONF_DELAY_BEFORE_LEAVING  (60 * 60 * CLOCK_SECOND)
@@ -136,6 +145,13 @@ points to simulate the MSF:
 
 #define COMP_SDN_LOG_LEVEL                         LOG_LEVEL_INFO
 
+#if WITH_TSCH_MONITOR
+/* Export the TSCH, MSF and 6P counters over SNMP and LwM2M */
+#define TSCH_STATS_CONF_ON 1
+#define SNMP_CONF_TSCH_MIB 1
+#define LWM2M_TSCH_OBJECT_CONF_ENABLED 1
+#endif /* WITH_TSCH_MONITOR */
+
 #define LOG_CONF_LEVEL_MSF                         LOG_LEVEL_INFO
 #define LOG_CONF_LEVEL_RPL                         LOG_LEVEL_WARN
 
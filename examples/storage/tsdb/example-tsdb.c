@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026, agent <agent@local>.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*---------------------------------------------------------------------------*/
+/**
+ * \file
+ *         Example on how to use the time-series store.
+ */
+/*---------------------------------------------------------------------------*/
+#include <stdio.h>
+#include "contiki.h"
+#include "tsdb.h"
+/*---------------------------------------------------------------------------*/
+PROCESS(example_tsdb_process, "Time-series store example");
+AUTOSTART_PROCESSES(&example_tsdb_process);
+/*---------------------------------------------------------------------------*/
+#define SERIES_NAME "temp"
+#define SAMPLES     1000
+#define PERIOD      30
+
+static tsdb_t db;
+static tsdb_iterator_t it;
+/*---------------------------------------------------------------------------*/
+/* A slowly changing sawtooth, as from a sensor. */
+static int32_t
+sample_value(uint32_t i)
+{
+  return 2000 + (int32_t)(i % 64) * 3 - (int32_t)(i % 7);
+}
+/*---------------------------------------------------------------------------*/
+static int
+append_samples(uint32_t first, uint32_t last)
+{
+  uint32_t i;
+
+  for(i = first; i < last; i++) {
+    if(tsdb_append(&db, i * PERIOD, sample_value(i)) < 0) {
+      printf("failed to append sample %lu\n", (unsigned long)i);
+      return -1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_range(uint32_t from, uint32_t to)
+{
+  tsdb_sample_t sample;
+  uint32_t i;
+  uint32_t first;
+  uint32_t count;
+  int errors;
+
+  if(tsdb_range(&it, &db, from, to) < 0) {
+    printf("failed to read the range\n");
+    return;
+  }
+
+  count = 0;
+  errors = 0;
+  first = 0;
+  i = 0;
+  while(tsdb_next(&it, &sample) > 0) {
+    if(count == 0) {
+      first = sample.time;
+      i = first / PERIOD;
+    }
+    if(sample.time != i * PERIOD || sample.value != sample_value(i)) {
+      errors++;
+    }
+    count++;
+    i++;
+  }
+  printf("range %lu-%lu: %lu samples from %lu, %d errors\n",
+         (unsigned long)from, (unsigned long)to,
+         (unsigned long)count, (unsigned long)first, errors);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(example_tsdb_process, ev, data)
+{
+  tsdb_bucket_t bucket;
+
+  PROCESS_BEGIN();
+
+  /* Start from an empty series. */
+  if(tsdb_open(&db, SERIES_NAME) < 0) {
+    printf("failed to open the series\n");
+    PROCESS_EXIT();
+  }
+  tsdb_remove(&db);
+
+  if(tsdb_open(&db, SERIES_NAME) < 0 ||
+     append_samples(0, SAMPLES / 2) < 0) {
+    PROCESS_EXIT();
+  }
+  tsdb_close(&db);
+
+  /* Reopening the series continues after the last sample. */
+  if(tsdb_open(&db, SERIES_NAME) < 0 ||
+     append_samples(SAMPLES / 2, SAMPLES) < 0) {
+    PROCESS_EXIT();
+  }
+
+  /* The oldest segments have been reused, so the first samples are
+     gone. */
+  check_range(0, SAMPLES * PERIOD);
+  check_range((SAMPLES - 100) * PERIOD + 1, (SAMPLES - 10) * PERIOD);
+
+  /* Aggregate the last samples into ten-minute intervals. */
+  if(tsdb_range(&it, &db, (SAMPLES - 100) * PERIOD, SAMPLES * PERIOD) == 0) {
+    while(tsdb_downsample(&it, 600, &bucket) > 0) {
+      printf("%lu: count %lu min %ld max %ld mean %ld\n",
+             (unsigned long)bucket.start, (unsigned long)bucket.count,
+             (long)bucket.min, (long)bucket.max, (long)bucket.mean);
+    }
+  }
+
+  tsdb_close(&db);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
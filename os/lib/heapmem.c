@@ -103,9 +103,509 @@
 #define HEAPMEM_ALIGNMENT sizeof(int)
 #endif /* HEAPMEM_CONF_ALIGNMENT */
 
+/*
+ * The HEAPMEM_CONF_TLSF parameter selects a Two-Level Segregated Fit
+ * allocator (non-zero value) instead of the default first-fit chunk
+ * allocator (zero value). TLSF allocates and frees in bounded time,
+ * regardless of the number of chunks in the heap.
+ */
+#ifdef HEAPMEM_CONF_TLSF
+#define HEAPMEM_TLSF HEAPMEM_CONF_TLSF
+#else
+#define HEAPMEM_TLSF 0
+#endif /* HEAPMEM_CONF_TLSF */
+
+/*
+ * The HEAPMEM_CONF_TLSF_SL_LOG2 parameter sets the number of free lists
+ * that each power-of-two size class is divided into for TLSF, as a
+ * power of two. More lists waste less space and cost more RAM.
+ */
+#ifdef HEAPMEM_CONF_TLSF_SL_LOG2
+#define TLSF_SL_LOG2 HEAPMEM_CONF_TLSF_SL_LOG2
+#else
+#define TLSF_SL_LOG2 2
+#endif /* HEAPMEM_CONF_TLSF_SL_LOG2 */
+
 #define ALIGN(size)						\
   (((size) + (HEAPMEM_ALIGNMENT - 1)) & ~(HEAPMEM_ALIGNMENT - 1))
 
+/* All allocated space is located within an "heap", which is statically
+   allocated with a pre-configured size. */
+static char heap_base[HEAPMEM_ARENA_SIZE] CC_ALIGN(HEAPMEM_ALIGNMENT);
+
+/* Bytes currently handed out, and the most that has ever been. */
+static size_t allocated_now;
+static size_t allocated_max;
+
+static void
+account(size_t added, size_t removed)
+{
+  allocated_now += added;
+  allocated_now -= removed;
+  if(allocated_now > allocated_max) {
+    allocated_max = allocated_now;
+  }
+}
+
+#if HEAPMEM_TLSF
+/*
+ * Two-Level Segregated Fit (TLSF) allocator.
+ *
+ * Every block, free or allocated, starts with a header that records
+ * its payload size and the block physically before it. This lets a
+ * freed block be merged with both of its neighbours in constant time.
+ * Free blocks are kept on segregated free lists. The first level
+ * splits sizes by power of two and the second level divides each of
+ * those into SL_COUNT equal ranges. Two bitmaps record which lists are
+ * non-empty, so finding a list with a block large enough takes two
+ * bit scans instead of a search.
+ */
+typedef struct block {
+  struct block *prev_phys;
+  size_t size;
+  uint8_t flags;
+#if HEAPMEM_DEBUG
+  const char *file;
+  unsigned line;
+#endif
+} block_t;
+
+/* The free list links are stored in the payload of free blocks. */
+typedef struct free_links {
+  block_t *next;
+  block_t *prev;
+} free_links_t;
+
+#define BLOCK_FLAG_ALLOCATED		0x1
+
+#define BLOCK_HEADER ALIGN(sizeof(block_t))
+#define BLOCK_MIN ALIGN(sizeof(free_links_t))
+#define BLOCK_FREE(block) (~(block)->flags & BLOCK_FLAG_ALLOCATED)
+
+#define GET_BLOCK(ptr) ((block_t *)((char *)(ptr) - BLOCK_HEADER))
+#define GET_PTR(block) ((char *)(block) + BLOCK_HEADER)
+#define NEXT_BLOCK(block) ((block_t *)(GET_PTR(block) + (block)->size))
+#define LINKS(block) ((free_links_t *)GET_PTR(block))
+
+/* The usable arena, ending with a zero-sized allocated sentinel block. */
+#define ARENA_END (HEAPMEM_ARENA_SIZE & ~(HEAPMEM_ALIGNMENT - 1))
+
+#if TLSF_SL_LOG2 > 3
+#error "HEAPMEM_CONF_TLSF_SL_LOG2 must be at most 3"
+#endif
+#define SL_COUNT (1 << TLSF_SL_LOG2)
+/* Sizes below SMALL_BLOCK all belong to the first first-level class. */
+#define FL_SHIFT (TLSF_SL_LOG2 + 2)
+#define SMALL_BLOCK ((size_t)1 << FL_SHIFT)
+
+/* The number of bits needed for a size within the arena. */
+#if HEAPMEM_ARENA_SIZE <= 0x100UL
+#define ARENA_BITS 8
+#elif HEAPMEM_ARENA_SIZE <= 0x200UL
+#define ARENA_BITS 9
+#elif HEAPMEM_ARENA_SIZE <= 0x400UL
+#define ARENA_BITS 10
+#elif HEAPMEM_ARENA_SIZE <= 0x800UL
+#define ARENA_BITS 11
+#elif HEAPMEM_ARENA_SIZE <= 0x1000UL
+#define ARENA_BITS 12
+#elif HEAPMEM_ARENA_SIZE <= 0x2000UL
+#define ARENA_BITS 13
+#elif HEAPMEM_ARENA_SIZE <= 0x4000UL
+#define ARENA_BITS 14
+#elif HEAPMEM_ARENA_SIZE <= 0x8000UL
+#define ARENA_BITS 15
+#elif HEAPMEM_ARENA_SIZE <= 0x10000UL
+#define ARENA_BITS 16
+#elif HEAPMEM_ARENA_SIZE <= 0x100000UL
+#define ARENA_BITS 20
+#elif HEAPMEM_ARENA_SIZE <= 0x1000000UL
+#define ARENA_BITS 24
+#else
+#define ARENA_BITS 31
+#endif
+#define FL_COUNT (ARENA_BITS - FL_SHIFT + 1)
+
+static uint32_t fl_bitmap;
+static uint8_t sl_bitmap[FL_COUNT];
+static block_t *free_heads[FL_COUNT][SL_COUNT];
+static uint8_t initialized;
+
+/* tlsf_ffs: The index of the least significant set bit of a non-zero word. */
+static unsigned
+tlsf_ffs(uint32_t word)
+{
+#ifdef __GNUC__
+  return __builtin_ctzl(word);
+#else
+  unsigned bit;
+
+  for(bit = 0; !(word & 1); bit++) {
+    word >>= 1;
+  }
+  return bit;
+#endif
+}
+
+/* tlsf_fls: The index of the most significant set bit of a non-zero size. */
+static unsigned
+tlsf_fls(size_t size)
+{
+#ifdef __GNUC__
+  return sizeof(unsigned long) * 8 - 1 - __builtin_clzl((unsigned long)size);
+#else
+  unsigned bit;
+
+  for(bit = 0; size > 1; bit++) {
+    size >>= 1;
+  }
+  return bit;
+#endif
+}
+
+/* mapping: Find the free list that a block of the given size belongs to. */
+static void
+mapping(size_t size, unsigned *fl, unsigned *sl)
+{
+  unsigned bit;
+
+  if(size < SMALL_BLOCK) {
+    *fl = 0;
+    *sl = size / (SMALL_BLOCK / SL_COUNT);
+  } else {
+    bit = tlsf_fls(size);
+    *fl = bit - FL_SHIFT + 1;
+    *sl = (size >> (bit - TLSF_SL_LOG2)) - SL_COUNT;
+  }
+}
+
+static void
+insert_free(block_t *block)
+{
+  unsigned fl, sl;
+
+  mapping(block->size, &fl, &sl);
+  LINKS(block)->prev = NULL;
+  LINKS(block)->next = free_heads[fl][sl];
+  if(free_heads[fl][sl] != NULL) {
+    LINKS(free_heads[fl][sl])->prev = block;
+  }
+  free_heads[fl][sl] = block;
+  fl_bitmap |= (uint32_t)1 << fl;
+  sl_bitmap[fl] |= 1 << sl;
+}
+
+static void
+remove_free(block_t *block)
+{
+  unsigned fl, sl;
+
+  mapping(block->size, &fl, &sl);
+  if(LINKS(block)->next != NULL) {
+    LINKS(LINKS(block)->next)->prev = LINKS(block)->prev;
+  }
+  if(LINKS(block)->prev != NULL) {
+    LINKS(LINKS(block)->prev)->next = LINKS(block)->next;
+  } else {
+    free_heads[fl][sl] = LINKS(block)->next;
+    if(free_heads[fl][sl] == NULL) {
+      sl_bitmap[fl] &= ~(1 << sl);
+      if(sl_bitmap[fl] == 0) {
+        fl_bitmap &= ~((uint32_t)1 << fl);
+      }
+    }
+  }
+}
+
+/*
+ * find_free: Take a free block of at least the given size off its
+ * free list. The size is rounded up to the next list boundary first, so
+ * that any block on the list found is large enough.
+ */
+static block_t *
+find_free(size_t size)
+{
+  unsigned fl, sl;
+  uint32_t map;
+  block_t *block;
+
+  if(size < SMALL_BLOCK) {
+    size += SMALL_BLOCK / SL_COUNT - 1;
+  } else {
+    size += ((size_t)1 << (tlsf_fls(size) - TLSF_SL_LOG2)) - 1;
+  }
+  mapping(size, &fl, &sl);
+  if(fl >= FL_COUNT) {
+    return NULL;
+  }
+
+  map = sl_bitmap[fl] & (~0U << sl);
+  if(map == 0) {
+    map = fl_bitmap & (~(uint32_t)0 << fl << 1);
+    if(map == 0) {
+      return NULL;
+    }
+    fl = tlsf_ffs(map);
+    map = sl_bitmap[fl];
+  }
+  sl = tlsf_ffs(map);
+
+  block = free_heads[fl][sl];
+  remove_free(block);
+  return block;
+}
+
+/* release: Merge a block that has become free with its free neighbours,
+   and put the result on a free list. */
+static void
+release(block_t *block)
+{
+  block_t *neighbour;
+
+  block->flags &= ~BLOCK_FLAG_ALLOCATED;
+
+  neighbour = NEXT_BLOCK(block);
+  if(BLOCK_FREE(neighbour)) {
+    remove_free(neighbour);
+    block->size += BLOCK_HEADER + neighbour->size;
+    NEXT_BLOCK(block)->prev_phys = block;
+  }
+
+  neighbour = block->prev_phys;
+  if(neighbour != NULL && BLOCK_FREE(neighbour)) {
+    remove_free(neighbour);
+    neighbour->size += BLOCK_HEADER + block->size;
+    NEXT_BLOCK(neighbour)->prev_phys = neighbour;
+    block = neighbour;
+  }
+
+  insert_free(block);
+}
+
+/* split_block: Give back the part of an allocated block beyond size, if
+   it is large enough to form a block of its own. */
+static void
+split_block(block_t *block, size_t size)
+{
+  block_t *rest;
+
+  if(block->size >= size + BLOCK_HEADER + BLOCK_MIN) {
+    rest = (block_t *)(GET_PTR(block) + size);
+    rest->size = block->size - size - BLOCK_HEADER;
+    rest->prev_phys = block;
+    NEXT_BLOCK(rest)->prev_phys = rest;
+    block->size = size;
+    release(rest);
+  }
+}
+
+/* init_heap: Turn the arena into one free block and the sentinel. */
+static void
+init_heap(void)
+{
+  block_t *block;
+
+  initialized = 1;
+  if(ARENA_END < 2 * BLOCK_HEADER + BLOCK_MIN) {
+    return;
+  }
+
+  block = (block_t *)heap_base;
+  block->prev_phys = NULL;
+  block->size = ARENA_END - 2 * BLOCK_HEADER;
+  block->flags = 0;
+
+  NEXT_BLOCK(block)->prev_phys = block;
+  NEXT_BLOCK(block)->size = 0;
+  NEXT_BLOCK(block)->flags = BLOCK_FLAG_ALLOCATED;
+
+  insert_free(block);
+}
+
+static size_t
+request_size(size_t size)
+{
+  size = ALIGN(size);
+  return size < BLOCK_MIN ? BLOCK_MIN : size;
+}
+
+/*
+ * heapmem_alloc: Allocate an object of the specified size, returning
+ * a pointer to it in case of success, and NULL in case of failure.
+ *
+ * The smallest free list that is certain to hold a large enough block
+ * is located through the bitmaps, and the block is split if it is
+ * larger than needed.
+ */
+void *
+#if HEAPMEM_DEBUG
+heapmem_alloc_debug(size_t size, const char *file, const unsigned line)
+#else
+heapmem_alloc(size_t size)
+#endif
+{
+  block_t *block;
+
+  /* Fail early on too large allocation requests to prevent wrapping values. */
+  if(size > HEAPMEM_ARENA_SIZE) {
+    return NULL;
+  }
+
+  if(!initialized) {
+    init_heap();
+  }
+
+  size = request_size(size);
+  block = find_free(size);
+  if(block == NULL) {
+    return NULL;
+  }
+
+  block->flags = BLOCK_FLAG_ALLOCATED;
+  split_block(block, size);
+  account(block->size, 0);
+
+#if HEAPMEM_DEBUG
+  block->file = file;
+  block->line = line;
+#endif
+
+  PRINTF("%s ptr %p size %lu\n", __func__, GET_PTR(block), (unsigned long)size);
+
+  return GET_PTR(block);
+}
+
+/*
+ * heapmem_free: Deallocate a previously allocated object.
+ *
+ * The pointer must exactly match one returned from an earlier call
+ * from heapmem_alloc or heapmem_realloc, without any call to
+ * heapmem_free in between.
+ */
+void
+#if HEAPMEM_DEBUG
+heapmem_free_debug(void *ptr, const char *file, const unsigned line)
+#else
+heapmem_free(void *ptr)
+#endif
+{
+  block_t *block;
+
+  if(ptr) {
+    block = GET_BLOCK(ptr);
+
+    PRINTF("%s ptr %p, allocated at %s:%u\n", __func__, ptr,
+           block->file, block->line);
+
+    account(0, block->size);
+    release(block);
+  }
+}
+
+#if HEAPMEM_REALLOC
+/*
+ * heapmem_realloc: Reallocate an object with a different size,
+ * possibly moving it in memory. In case of success, the function
+ * returns a pointer to the objects new location. In case of failure,
+ * it returns NULL.
+ *
+ * An object is shrunk or grown in place when possible, growing into
+ * the following block if that one is free. Otherwise it is moved.
+ */
+void *
+#if HEAPMEM_DEBUG
+heapmem_realloc_debug(void *ptr, size_t size,
+		      const char *file, const unsigned line)
+#else
+heapmem_realloc(void *ptr, size_t size)
+#endif
+{
+  void *newptr;
+  block_t *block;
+  block_t *next;
+  size_t old_size;
+
+  PRINTF("%s ptr %p size %u at %s:%u\n",
+         __func__, ptr, (unsigned)size, file, line);
+
+  /* Fail early on too large allocation requests to prevent wrapping values. */
+  if(size > HEAPMEM_ARENA_SIZE) {
+    return NULL;
+  }
+
+  /* Special cases in which we can hand off the execution to other functions. */
+  if(ptr == NULL) {
+    return heapmem_alloc(size);
+  } else if(size == 0) {
+    heapmem_free(ptr);
+    return NULL;
+  }
+
+  block = GET_BLOCK(ptr);
+#if HEAPMEM_DEBUG
+  block->file = file;
+  block->line = line;
+#endif
+
+  size = request_size(size);
+  old_size = block->size;
+
+  if(size > block->size) {
+    next = NEXT_BLOCK(block);
+    if(!BLOCK_FREE(next) || block->size + BLOCK_HEADER + next->size < size) {
+      /* No room to grow in place, move the object. */
+      newptr = heapmem_alloc(size);
+      if(newptr == NULL) {
+        return NULL;
+      }
+      memcpy(newptr, ptr, block->size);
+      account(0, block->size);
+      release(block);
+      return newptr;
+    }
+    remove_free(next);
+    block->size += BLOCK_HEADER + next->size;
+    NEXT_BLOCK(block)->prev_phys = block;
+  }
+
+  split_block(block, size);
+  account(block->size, old_size);
+  return ptr;
+}
+#endif /* HEAPMEM_REALLOC */
+
+/* heapmem_stats: Calculate statistics regarding memory usage. */
+void
+heapmem_stats(heapmem_stats_t *stats)
+{
+  block_t *block;
+
+  memset(stats, 0, sizeof(*stats));
+
+  if(!initialized) {
+    init_heap();
+  }
+
+  if(ARENA_END >= 2 * BLOCK_HEADER + BLOCK_MIN) {
+    for(block = (block_t *)heap_base; block->size > 0; block = NEXT_BLOCK(block)) {
+      if(BLOCK_FREE(block)) {
+        stats->available += block->size;
+        if(block->size > stats->largest_free) {
+          stats->largest_free = block->size;
+        }
+      } else {
+        stats->allocated += block->size;
+        stats->footprint = (char *)NEXT_BLOCK(block) - heap_base;
+      }
+      stats->overhead += BLOCK_HEADER;
+      stats->chunks++;
+    }
+  }
+  stats->max_allocated = allocated_max;
+}
+
+#else /* HEAPMEM_TLSF */
+
 /* Macros for chunk iteration. */
 #define NEXT_CHUNK(chunk)						\
   ((chunk_t *)((char *)(chunk) + sizeof(chunk_t) + (chunk)->size))
@@ -143,9 +643,6 @@ typedef struct chunk {
 #endif
 } chunk_t;
 
-/* All allocated space is located within an "heap", which is statically
-   allocated with a pre-configured size. */
-static char heap_base[HEAPMEM_ARENA_SIZE] CC_ALIGN(HEAPMEM_ALIGNMENT);
 static size_t heap_usage;
 
 static chunk_t *first_chunk = (chunk_t *)heap_base;
@@ -348,6 +845,7 @@ heapmem_alloc(size_t size)
   }
 
   chunk->flags = CHUNK_FLAG_ALLOCATED;
+  account(chunk->size, 0);
 
 #if HEAPMEM_DEBUG
   chunk->file = file;
@@ -386,6 +884,7 @@ heapmem_free(void *ptr)
     PRINTF("%s ptr %p, allocated at %s:%u\n", __func__, ptr,
            chunk->file, chunk->line);
 
+    account(0, chunk->size);
     free_chunk(chunk);
   }
 }
@@ -418,6 +917,7 @@ heapmem_realloc(void *ptr, size_t size)
   void *newptr;
   chunk_t *chunk;
   int size_adj;
+  size_t old_size;
 
   PRINTF("%s ptr %p size %u at %s:%u\n",
          __func__, ptr, (unsigned)size, file, line);
@@ -443,11 +943,13 @@ heapmem_realloc(void *ptr, size_t size)
 
   size = ALIGN(size);
   size_adj = size - chunk->size;
+  old_size = chunk->size;
 
   if(size_adj <= 0) {
     /* Request to make the object smaller or to keep its size.
        In the former case, the chunk will be split if possible. */
     split_chunk(chunk, size);
+    account(chunk->size, old_size);
     return ptr;
   }
 
@@ -460,6 +962,7 @@ heapmem_realloc(void *ptr, size_t size)
      */
     if(extend_space(size_adj) != NULL) {
       chunk->size = size;
+      account(chunk->size, old_size);
       return ptr;
     }
   } else {
@@ -469,10 +972,14 @@ heapmem_realloc(void *ptr, size_t size)
      * coalesce chunks in order to make as much room as possible.
      */
     coalesce_chunks(chunk);
+    /* The chunk owns any space it coalesced, even if it has to move. */
+    account(chunk->size, old_size);
     if(chunk->size >= size) {
       /* There was enough free adjacent space to extend the chunk in
 	 its current place. */
+      old_size = chunk->size;
       split_chunk(chunk, size);
+      account(chunk->size, old_size);
       return ptr;
     }
   }
@@ -489,6 +996,7 @@ heapmem_realloc(void *ptr, size_t size)
   }
 
   memcpy(newptr, ptr, chunk->size);
+  account(0, chunk->size);
   free_chunk(chunk);
 
   return newptr;
@@ -511,10 +1019,18 @@ heapmem_stats(heapmem_stats_t *stats)
     } else {
       coalesce_chunks(chunk);
       stats->available += chunk->size;
+      if(chunk->size > stats->largest_free) {
+        stats->largest_free = chunk->size;
+      }
     }
     stats->overhead += sizeof(chunk_t);
   }
   stats->available += HEAPMEM_ARENA_SIZE - heap_usage;
+  if(HEAPMEM_ARENA_SIZE - heap_usage > stats->largest_free) {
+    stats->largest_free = HEAPMEM_ARENA_SIZE - heap_usage;
+  }
   stats->footprint = heap_usage;
   stats->chunks = stats->overhead / sizeof(chunk_t);
+  stats->max_allocated = allocated_max;
 }
+#endif /* HEAPMEM_TLSF */
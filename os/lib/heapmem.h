@@ -82,6 +82,8 @@ typedef struct heapmem_stats {
   size_t available;
   size_t footprint;
   size_t chunks;
+  size_t max_allocated; /* High-water mark of allocated */
+  size_t largest_free;  /* Largest object that can currently be allocated */
 } heapmem_stats_t;
 
 #if HEAPMEM_DEBUG
@@ -47,12 +47,54 @@
 #include "contiki.h"
 #include "lib/memb.h"
 
+#if MEMB_STATS
+/* All pools that have been initialized. */
+static struct memb *pools;
+#endif /* MEMB_STATS */
+/*---------------------------------------------------------------------------*/
+/* Get the index of the block that ptr points to, or -1 if there is none. */
+static int
+block_index(struct memb *m, void *ptr)
+{
+  size_t offset;
+
+  if(!memb_inmemb(m, ptr)) {
+    return -1;
+  }
+  offset = (char *)ptr - (char *)m->mem;
+  if(offset % m->size != 0) {
+    return -1;
+  }
+  return offset / m->size;
+}
 /*---------------------------------------------------------------------------*/
 void
 memb_init(struct memb *m)
 {
+#if MEMB_STATS
+  struct memb *p;
+#endif /* MEMB_STATS */
+
   memset(m->used, 0, m->num);
   memset(m->mem, 0, m->size * m->num);
+
+#if MEMB_FREE_LIST
+  m->free_top = 0;
+  m->fresh = 0;
+#endif /* MEMB_FREE_LIST */
+
+#if MEMB_STATS
+  m->count = 0;
+  m->max_count = 0;
+  m->failed = 0;
+  for(p = pools; p != NULL; p = p->next) {
+    if(p == m) {
+      return;
+    }
+  }
+  m->next = pools;
+  pools = m;
+#endif /* MEMB_STATS */
 }
 /*---------------------------------------------------------------------------*/
 void *
@@ -60,17 +102,39 @@ memb_alloc(struct memb *m)
 {
   int i;
 
+#if MEMB_FREE_LIST
+  if(m->free_top > 0) {
+    i = m->free[--m->free_top];
+  } else if(m->fresh < m->num) {
+    i = m->fresh++;
+  } else {
+    i = m->num;
+  }
+#else /* MEMB_FREE_LIST */
   for(i = 0; i < m->num; ++i) {
     if(m->used[i] == false) {
-      /* If this block was unused, we set the used flag on
-	 and return a pointer to the memory block. */
-      m->used[i] = true;
-      return (void *)((char *)m->mem + (i * m->size));
+      break;
     }
   }
+#endif /* MEMB_FREE_LIST */
+
+  if(i < m->num) {
+    /* If this block was unused, we set the used flag on
+       and return a pointer to the memory block. */
+    m->used[i] = true;
+#if MEMB_STATS
+    if(++m->count > m->max_count) {
+      m->max_count = m->count;
+    }
+#endif /* MEMB_STATS */
+    return (void *)((char *)m->mem + (i * m->size));
+  }
 
   /* No free block was found, so we return NULL to indicate failure to
      allocate block. */
+#if MEMB_STATS
+  m->failed++;
+#endif /* MEMB_STATS */
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
@@ -78,23 +142,22 @@ int
 memb_free(struct memb *m, void *ptr)
 {
   int i;
-  char *ptr2;
 
-  /* Walk through the list of blocks and try to find the block to
-     which the pointer "ptr" points to. */
-  ptr2 = (char *)m->mem;
-  for(i = 0; i < m->num; ++i) {
-    if(ptr2 == (char *)ptr) {
-      /* We've found the block to which "ptr" points, so we check the allocation
-         status to detect the double-free error and free the block. */
-      if (m->used[i] == false)
-        return -1;
-      m->used[i] = false;
-      return 0;
-    }
-    ptr2 += m->size;
+  /* Find the block to which "ptr" points, and check the allocation
+     status to detect the double-free error. */
+  i = block_index(m, ptr);
+  if(i < 0 || m->used[i] == false) {
+    return -1;
   }
-  return -1;
+
+  m->used[i] = false;
+#if MEMB_FREE_LIST
+  m->free[m->free_top++] = i;
+#endif /* MEMB_FREE_LIST */
+#if MEMB_STATS
+  m->count--;
+#endif /* MEMB_STATS */
+  return 0;
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -107,6 +170,9 @@ memb_inmemb(struct memb *m, void *ptr)
 int
 memb_numfree(struct memb *m)
 {
+#if MEMB_FREE_LIST
+  return m->free_top + m->num - m->fresh;
+#else /* MEMB_FREE_LIST */
   int i;
   int num_free = 0;
 
@@ -117,5 +183,20 @@ memb_numfree(struct memb *m)
   }
 
   return num_free;
+#endif /* MEMB_FREE_LIST */
+}
+/*---------------------------------------------------------------------------*/
+#if MEMB_STATS
+struct memb *
+memb_stats_head(void)
+{
+  return pools;
+}
+/*---------------------------------------------------------------------------*/
+struct memb *
+memb_stats_next(struct memb *m)
+{
+  return m->next;
 }
+#endif /* MEMB_STATS */
 /** @} */
@@ -66,6 +66,43 @@
 #include <stdbool.h>
 #include "sys/cc.h"
 
+/**
+ * MEMB_CONF_FREE_LIST: Keep the indices of freed blocks on a stack, so
+ * that allocation takes constant time instead of a scan of the pool.
+ * This costs two bytes of RAM per block.
+ */
+#ifdef MEMB_CONF_FREE_LIST
+#define MEMB_FREE_LIST MEMB_CONF_FREE_LIST
+#else
+#define MEMB_FREE_LIST 0
+#endif
+
+/**
+ * MEMB_CONF_STATS: Count current, peak and failed allocations for each
+ * pool, and keep every initialized pool on a list that can be walked
+ * with memb_stats_head() and memb_stats_next().
+ */
+#ifdef MEMB_CONF_STATS
+#define MEMB_STATS MEMB_CONF_STATS
+#else
+#define MEMB_STATS 0
+#endif
+
+#if MEMB_FREE_LIST
+#define MEMB_FREE_LIST_DECLARE(name, num) \
+        static unsigned short CC_CONCAT(name,_memb_free)[num];
+#define MEMB_FREE_LIST_FIELDS(name) , CC_CONCAT(name,_memb_free), 0, 0
+#else
+#define MEMB_FREE_LIST_DECLARE(name, num)
+#define MEMB_FREE_LIST_FIELDS(name)
+#endif
+
+#if MEMB_STATS
+#define MEMB_STATS_FIELDS(name) , #name, 0, 0, 0, NULL
+#else
+#define MEMB_STATS_FIELDS(name)
+#endif
+
 /**
  * Declare a memory block.
  *
@@ -90,15 +127,32 @@ MEMB(connections, struct connection, 16);
 #define MEMB(name, structure, num) \
         static bool CC_CONCAT(name,_memb_used)[num]; \
         static structure CC_CONCAT(name,_memb_mem)[num]; \
+        MEMB_FREE_LIST_DECLARE(name, num) \
         static struct memb name = {sizeof(structure), num, \
                                           CC_CONCAT(name,_memb_used), \
-                                          (void *)CC_CONCAT(name,_memb_mem)}
+                                          (void *)CC_CONCAT(name,_memb_mem) \
+                                          MEMB_FREE_LIST_FIELDS(name) \
+                                          MEMB_STATS_FIELDS(name)}
 
 struct memb {
   unsigned short size;
   unsigned short num;
   bool *used;
   void *mem;
+#if MEMB_FREE_LIST
+  /* Stack of freed block indices. Blocks that have never been handed
+     out are taken from fresh onwards, so no initialization is needed. */
+  unsigned short *free;
+  unsigned short free_top;
+  unsigned short fresh;
+#endif /* MEMB_FREE_LIST */
+#if MEMB_STATS
+  const char *name;
+  unsigned short count;
+  unsigned short max_count;
+  unsigned short failed;
+  struct memb *next;
+#endif /* MEMB_STATS */
 };
 
 /**
@@ -149,6 +203,25 @@ int memb_inmemb(struct memb *m, void *ptr);
  */
 int  memb_numfree(struct memb *m);
 
+#if MEMB_STATS
+/**
+ * Get the first memory block pool that has been initialized with
+ * memb_init().
+ *
+ * \return the first pool, or NULL if no pool has been initialized
+ */
+struct memb *memb_stats_head(void);
+
+/**
+ * Get the next initialized memory block pool.
+ *
+ * \param m A pool returned by memb_stats_head() or memb_stats_next().
+ *
+ * \return the next pool, or NULL if m is the last one
+ */
+struct memb *memb_stats_next(struct memb *m);
+#endif /* MEMB_STATS */
+
 /** @} */
 /** @} */
 
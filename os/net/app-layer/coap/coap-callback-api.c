@@ -55,6 +55,7 @@
 #define LOG_MODULE "coap"
 #define LOG_LEVEL  LOG_LEVEL_COAP
 
+#if COAP_BLOCK2_WINDOW <= 1
 static void coap_request_callback(void *callback_data, coap_message_t *response);
 
 /*---------------------------------------------------------------------------*/
@@ -143,7 +144,156 @@ coap_request_callback(void *callback_data, coap_message_t *response)
     callback_state->callback(callback_state);
   }
 }
+#endif /* COAP_BLOCK2_WINDOW <= 1 */
 
+#if COAP_BLOCK2_WINDOW > 1
+/*---------------------------------------------------------------------------*/
+/*
+ * Windowed Block2 transfer: once the first response announces more
+ * blocks, up to COAP_BLOCK2_WINDOW consecutive blocks of a GET are
+ * requested at the same time, each in its own transaction. A block of a
+ * GET that times out is asked for again, other requests are never
+ * repeated. A 4.02 for a block beyond the end of the resource only
+ * closes the window.
+ */
+static void coap_window_callback(void *callback_data, coap_message_t *response);
+
+static int
+send_block(coap_request_block_t *b, uint32_t num)
+{
+  coap_request_state_t *state = b->state;
+  coap_message_t *request = state->request;
+  coap_transaction_t *transaction;
+
+  request->mid = coap_get_mid();
+  if((transaction =
+      coap_new_transaction(request->mid, state->remote_endpoint)) == NULL) {
+    return 0;
+  }
+  transaction->callback = coap_window_callback;
+  transaction->callback_data = b;
+  b->num = num;
+  b->mid = request->mid;
+  b->busy = 1;
+  state->transaction = transaction;
+
+  if(num > 0) {
+    coap_set_header_block2(request, num, 0, COAP_MAX_CHUNK_SIZE);
+  }
+  transaction->message_len =
+    coap_serialize_message(request, transaction->message);
+
+  coap_send_transaction(transaction);
+  LOG_DBG("Requested #%"PRIu32" (MID %u)\n", num, request->mid);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Request the next blocks in the free slots, returns the number of busy
+   slots */
+static int
+fill_window(coap_request_state_t *state)
+{
+  int i;
+  int busy = 0;
+  int size = state->request->code == COAP_GET ? COAP_BLOCK2_WINDOW : 1;
+
+  for(i = 0; i < size; i++) {
+    if(!state->window[i].busy && state->block_num < state->end_block
+       && send_block(&state->window[i], state->block_num)) {
+      state->block_num++;
+    }
+    busy += state->window[i].busy;
+  }
+  return busy;
+}
+/*---------------------------------------------------------------------------*/
+static void
+close_window(coap_request_state_t *state)
+{
+  int i;
+
+  for(i = 0; i < COAP_BLOCK2_WINDOW; i++) {
+    if(state->window[i].busy) {
+      state->window[i].busy = 0;
+      coap_clear_transaction(coap_get_transaction_by_mid(state->window[i].mid));
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+finish_window(coap_callback_request_state_t *callback_state,
+              coap_request_status_t status)
+{
+  coap_request_state_t *state = &callback_state->state;
+
+  close_window(state);
+  state->status = status;
+  state->response = NULL;
+  callback_state->callback(callback_state);
+}
+/*---------------------------------------------------------------------------*/
+static void
+coap_window_callback(void *callback_data, coap_message_t *response)
+{
+  coap_request_block_t *b = (coap_request_block_t *)callback_data;
+  coap_callback_request_state_t *callback_state =
+    (coap_callback_request_state_t *)b->state;
+  coap_request_state_t *state = &callback_state->state;
+
+  b->busy = 0;
+
+  if(response == NULL) {
+    /* missing block, ask for it again if that is safe */
+    if(state->request->code == COAP_GET
+       && ++(state->block_error) < COAP_MAX_ATTEMPTS
+       && send_block(b, b->num)) {
+      return;
+    }
+    LOG_WARN("Server not responding giving up...\n");
+    finish_window(callback_state, COAP_REQUEST_STATUS_TIMEOUT);
+    return;
+  }
+
+  state->response = response;
+  state->res_block = 0;
+  state->more = 0;
+  coap_get_header_block2(response, &state->res_block, &state->more, NULL, NULL);
+
+  LOG_DBG("Received #%lu%s (%u bytes)\n", (unsigned long)state->res_block,
+          (unsigned)state->more ? "+" : "", response->payload_len);
+
+  if(b->num > 0 && response->code == BAD_OPTION_4_02) {
+    /* asked beyond the end of the resource */
+    state->end_block = MIN(state->end_block, b->num);
+  } else if(state->res_block != b->num) {
+    LOG_WARN("WRONG BLOCK %"PRIu32"/%"PRIu32"\n", state->res_block, b->num);
+    if(++(state->block_error) >= COAP_MAX_ATTEMPTS || !send_block(b, b->num)) {
+      finish_window(callback_state, COAP_REQUEST_STATUS_BLOCK_ERROR);
+    }
+    return;
+  } else {
+    if(state->more) {
+      if(b->num == 0) {
+        /* the resource is blockwise, open the window */
+        state->end_block = UINT32_MAX;
+      }
+    } else {
+      state->end_block = MIN(state->end_block, b->num + 1);
+    }
+    state->received++;
+    state->status = state->more ? COAP_REQUEST_STATUS_MORE
+      : COAP_REQUEST_STATUS_RESPONSE;
+    callback_state->callback(callback_state);
+  }
+
+  if(state->received >= state->end_block) {
+    finish_window(callback_state, COAP_REQUEST_STATUS_FINISHED);
+  } else if(fill_window(state) == 0) {
+    /* a block is missing and cannot be requested */
+    finish_window(callback_state, COAP_REQUEST_STATUS_BLOCK_ERROR);
+  }
+}
+#endif /* COAP_BLOCK2_WINDOW > 1 */
 /*---------------------------------------------------------------------------*/
 
 int
@@ -162,7 +312,21 @@ coap_send_request(coap_callback_request_state_t *callback_state, coap_endpoint_t
   state->remote_endpoint = endpoint;
   callback_state->callback = callback;
 
+#if COAP_BLOCK2_WINDOW > 1
+  {
+    int i;
+    for(i = 0; i < COAP_BLOCK2_WINDOW; i++) {
+      state->window[i].state = state;
+      state->window[i].busy = 0;
+    }
+    state->received = 0;
+    /* only block 0 until the response tells if there are more */
+    state->end_block = 1;
+    return fill_window(state);
+  }
+#else
   return progress_request(callback_state);
+#endif /* COAP_BLOCK2_WINDOW > 1 */
 }
 /*---------------------------------------------------------------------------*/
 /** @} */
@@ -93,6 +93,75 @@
 #define COAP_MAX_HEADER_SIZE           (4 + COAP_TOKEN_LEN + 3 + 1 + COAP_ETAG_LEN + 4 + 4 + 30)  /* 65 */
 #endif /* COAP_MAX_HEADER_SIZE */
 
+/* Number of hash buckets for looking transactions up by MID (power of two) */
+#ifdef COAP_CONF_TRANSACTION_HASH_SIZE
+#define COAP_TRANSACTION_HASH_SIZE COAP_CONF_TRANSACTION_HASH_SIZE
+#else
+#define COAP_TRANSACTION_HASH_SIZE 8
+#endif /* COAP_TRANSACTION_HASH_SIZE */
+
+/* Slots and slot length in milliseconds of the timer wheel that schedules
+   the retransmissions of all transactions */
+#ifdef COAP_CONF_RETRANSMIT_WHEEL_SLOTS
+#define COAP_RETRANSMIT_WHEEL_SLOTS COAP_CONF_RETRANSMIT_WHEEL_SLOTS
+#else
+#define COAP_RETRANSMIT_WHEEL_SLOTS 16
+#endif /* COAP_RETRANSMIT_WHEEL_SLOTS */
+
+#ifdef COAP_CONF_RETRANSMIT_WHEEL_TICK
+#define COAP_RETRANSMIT_WHEEL_TICK COAP_CONF_RETRANSMIT_WHEEL_TICK
+#else
+#define COAP_RETRANSMIT_WHEEL_TICK 250
+#endif /* COAP_RETRANSMIT_WHEEL_TICK */
+
+/* Per-endpoint congestion control: CoCoA retransmission timeout
+   estimation and at most COAP_NSTART outstanding CON messages per
+   endpoint, further ones are queued */
+#ifdef COAP_CONF_WITH_CONGESTION_CONTROL
+#define COAP_WITH_CONGESTION_CONTROL COAP_CONF_WITH_CONGESTION_CONTROL
+#else
+#define COAP_WITH_CONGESTION_CONTROL 0
+#endif /* COAP_WITH_CONGESTION_CONTROL */
+
+#ifdef COAP_CONF_NSTART
+#define COAP_NSTART COAP_CONF_NSTART
+#else
+#define COAP_NSTART 1
+#endif /* COAP_NSTART */
+
+/* Number of endpoints for which congestion control state is kept */
+#ifdef COAP_CONF_MAX_PEERS
+#define COAP_MAX_PEERS COAP_CONF_MAX_PEERS
+#else
+#define COAP_MAX_PEERS COAP_MAX_OPEN_TRANSACTIONS
+#endif /* COAP_MAX_PEERS */
+
+/* Number of Block2 requests of one transfer that the callback API keeps
+   outstanding. With more than one, blocks can reach the callback out of
+   order: the block number is in state->res_block and the transfer is
+   done on COAP_REQUEST_STATUS_FINISHED. */
+#ifdef COAP_CONF_BLOCK2_WINDOW
+#define COAP_BLOCK2_WINDOW COAP_CONF_BLOCK2_WINDOW
+#else
+#define COAP_BLOCK2_WINDOW 1
+#endif /* COAP_BLOCK2_WINDOW */
+
+/* Keep the last representation of a resource that is not aware of
+   blockwise transfers, so that following Block2 requests from the same
+   endpoint do not run the handler again */
+#ifdef COAP_CONF_BLOCK2_CACHE
+#define COAP_BLOCK2_CACHE COAP_CONF_BLOCK2_CACHE
+#else
+#define COAP_BLOCK2_CACHE 0
+#endif /* COAP_BLOCK2_CACHE */
+
+/* Milliseconds a cached representation is served */
+#ifdef COAP_CONF_BLOCK2_CACHE_LIFETIME
+#define COAP_BLOCK2_CACHE_LIFETIME COAP_CONF_BLOCK2_CACHE_LIFETIME
+#else
+#define COAP_BLOCK2_CACHE_LIFETIME 10000
+#endif /* COAP_BLOCK2_CACHE_LIFETIME */
+
 /* Number of observer slots (each takes abot xxx bytes) */
 #ifndef COAP_MAX_OBSERVERS
 #define COAP_MAX_OBSERVERS    COAP_MAX_OPEN_TRANSACTIONS - 1
@@ -105,6 +174,23 @@
 #define COAP_OBSERVE_REFRESH_INTERVAL  20
 #endif /* COAP_OBSERVE_REFRESH_INTERVAL */
 
+/* Minimal interval in milliseconds between two notifications for the same
+   URL. Changes within the interval are coalesced into one notification of
+   the latest representation at the end of it (0 to notify every change). */
+#ifdef COAP_CONF_OBSERVE_NOTIFY_INTERVAL
+#define COAP_OBSERVE_NOTIFY_INTERVAL COAP_CONF_OBSERVE_NOTIFY_INTERVAL
+#else
+#define COAP_OBSERVE_NOTIFY_INTERVAL 0
+#endif /* COAP_OBSERVE_NOTIFY_INTERVAL */
+
+/* Render the representation once per notification into a shared buffer of
+   COAP_MAX_CHUNK_SIZE bytes instead of once per observer. */
+#ifdef COAP_CONF_OBSERVE_RENDER_ONCE
+#define COAP_OBSERVE_RENDER_ONCE COAP_CONF_OBSERVE_RENDER_ONCE
+#else
+#define COAP_OBSERVE_RENDER_ONCE 1
+#endif /* COAP_OBSERVE_RENDER_ONCE */
+
 /* Maximal length of observable URL */
 #ifdef COAP_CONF_OBSERVER_URL_LEN
 #define COAP_OBSERVER_URL_LEN COAP_CONF_OBSERVER_URL_LEN
@@ -112,5 +198,13 @@
 #define COAP_OBSERVER_URL_LEN 20
 #endif
 
+/* Number of URI path segment nodes in the resource dispatch trie (0 to
+   look resources up by scanning the list of activated resources) */
+#ifdef COAP_CONF_RESOURCE_TRIE_NODES
+#define COAP_RESOURCE_TRIE_NODES COAP_CONF_RESOURCE_TRIE_NODES
+#else
+#define COAP_RESOURCE_TRIE_NODES 0
+#endif
+
 #endif /* COAP_CONF_H_ */
 /** @} */
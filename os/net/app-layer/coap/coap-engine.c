@@ -44,6 +44,7 @@
 #include "coap-engine.h"
 #include "sys/cc.h"
 #include "lib/list.h"
+#include "lib/memb.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <inttypes.h>
@@ -72,6 +73,54 @@ LIST(coap_handlers);
 LIST(coap_resource_services);
 static uint8_t is_initialized = 0;
 
+#if COAP_RESOURCE_TRIE_NODES > 0
+/*
+ * Activated resources are also kept in a trie of URI path segments, so
+ * that the resource serving a request is found in a single pass over
+ * its Uri-Path.
+ */
+typedef struct coap_trie_node coap_trie_node_t;
+struct coap_trie_node {
+  coap_trie_node_t *sibling;
+  coap_trie_node_t *child;
+  const char *segment;          /* points into the url of a resource */
+  uint16_t segment_len;
+  coap_resource_t *resource;    /* resource with this path, if any */
+  uint16_t order;               /* activation order of the resource */
+};
+
+MEMB(trie_nodes_memb, coap_trie_node_t, COAP_RESOURCE_TRIE_NODES);
+/* The root is the empty path */
+static coap_trie_node_t trie_root;
+/* Set when a resource did not fit into the trie */
+static uint8_t trie_incomplete = 0;
+/* Number of resources added to the trie */
+static uint16_t trie_resources = 0;
+#endif /* COAP_RESOURCE_TRIE_NODES > 0 */
+
+#if COAP_BLOCK2_CACHE
+/*
+ * Last representation of a resource that is unaware of blockwise
+ * transfers. Block 0 renders it, the following Block2 requests of the
+ * same endpoint for the same path, query and Accept are cut from here.
+ */
+static struct {
+  coap_endpoint_t endpoint;
+  uint64_t expires;
+  char url[COAP_OBSERVER_URL_LEN];
+  uint8_t url_len;
+  uint8_t path_len;
+  uint16_t accept;
+  uint16_t content_format;
+  uint8_t has_content_format;
+  uint8_t code;
+  uint8_t etag_len;
+  uint8_t etag[COAP_ETAG_LEN];
+  uint16_t payload_len;
+  uint8_t payload[COAP_MAX_CHUNK_SIZE];
+} block2_cache;
+#endif /* COAP_BLOCK2_CACHE */
+
 /*---------------------------------------------------------------------------*/
 /*- CoAP service handlers---------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -133,6 +182,75 @@ call_service(coap_message_t *request, coap_message_t *response,
 /*---------------------------------------------------------------------------*/
 /*- Server Part -------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
+#if COAP_BLOCK2_CACHE
+static int
+block2_cache_match(const coap_endpoint_t *src, const coap_message_t *request)
+{
+  return block2_cache.url_len > 0
+    && block2_cache.expires > coap_timer_uptime()
+    && block2_cache.accept == request->accept
+    && block2_cache.path_len == request->uri_path_len
+    && block2_cache.url_len == request->uri_path_len + request->uri_query_len
+    && memcmp(block2_cache.url, request->uri_path, request->uri_path_len) == 0
+    && memcmp(&block2_cache.url[block2_cache.path_len], request->uri_query,
+              request->uri_query_len) == 0
+    && coap_endpoint_cmp(&block2_cache.endpoint, src);
+}
+/*---------------------------------------------------------------------------*/
+/* Drop the cached representation when a request may change the resource */
+static void
+block2_cache_invalidate(const coap_message_t *request)
+{
+  if(block2_cache.url_len > 0
+     && block2_cache.path_len == request->uri_path_len
+     && memcmp(block2_cache.url, request->uri_path,
+               request->uri_path_len) == 0) {
+    block2_cache.url_len = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+block2_cache_store(const coap_endpoint_t *src, const coap_message_t *request,
+                   coap_message_t *response)
+{
+  block2_cache.url_len = 0;
+  if(request->uri_path_len + request->uri_query_len > sizeof(block2_cache.url)
+     || response->payload_len > sizeof(block2_cache.payload)) {
+    return;
+  }
+  coap_endpoint_copy(&block2_cache.endpoint, src);
+  memcpy(block2_cache.url, request->uri_path, request->uri_path_len);
+  memcpy(&block2_cache.url[request->uri_path_len], request->uri_query,
+         request->uri_query_len);
+  block2_cache.path_len = request->uri_path_len;
+  block2_cache.accept = request->accept;
+  block2_cache.has_content_format =
+    coap_is_option(response, COAP_OPTION_CONTENT_FORMAT);
+  block2_cache.content_format = response->content_format;
+  block2_cache.code = response->code;
+  block2_cache.etag_len =
+    coap_is_option(response, COAP_OPTION_ETAG) ? response->etag_len : 0;
+  memcpy(block2_cache.etag, response->etag, block2_cache.etag_len);
+  block2_cache.payload_len = response->payload_len;
+  memcpy(block2_cache.payload, response->payload, response->payload_len);
+  block2_cache.expires = coap_timer_uptime() + COAP_BLOCK2_CACHE_LIFETIME;
+  block2_cache.url_len = request->uri_path_len + request->uri_query_len;
+}
+/*---------------------------------------------------------------------------*/
+static void
+block2_cache_load(coap_message_t *response)
+{
+  coap_set_status_code(response, block2_cache.code);
+  if(block2_cache.has_content_format) {
+    coap_set_header_content_format(response, block2_cache.content_format);
+  }
+  if(block2_cache.etag_len > 0) {
+    coap_set_header_etag(response, block2_cache.etag, block2_cache.etag_len);
+  }
+  coap_set_payload(response, block2_cache.payload, block2_cache.payload_len);
+}
+#endif /* COAP_BLOCK2_CACHE */
+/*---------------------------------------------------------------------------*/
 
 /* the discover resource is automatically included for CoAP */
 extern coap_resource_t res_well_known_core;
@@ -199,11 +317,24 @@ coap_receive(const coap_endpoint_t *src,
           new_offset = block_offset;
         }
 
+#if COAP_BLOCK2_CACHE
+        if(message->code != COAP_GET) {
+          block2_cache_invalidate(message);
+        }
+#endif /* COAP_BLOCK2_CACHE */
+
         if(new_offset < 0) {
           LOG_DBG("Blockwise: block request offset overflow\n");
           coap_status_code = BAD_OPTION_4_02;
           coap_error_message = "BlockOutOfScope";
           status = COAP_HANDLER_STATUS_CONTINUE;
+#if COAP_BLOCK2_CACHE
+        } else if(block_num > 0 && message->code == COAP_GET
+                  && block2_cache_match(src, message)) {
+          LOG_DBG("Blockwise: block %"PRIu32" from cache\n", block_num);
+          block2_cache_load(response);
+          status = COAP_HANDLER_STATUS_PROCESSED;
+#endif /* COAP_BLOCK2_CACHE */
         } else {
           /* call CoAP framework and check if found and allowed */
           status = call_service(message, response,
@@ -239,6 +370,12 @@ coap_receive(const coap_endpoint_t *src,
                     response->code = BAD_OPTION_4_02;
                     coap_set_payload(response, "BlockOutOfScope", 15); /* a const char str[] and sizeof(str) produces larger code size */
                   } else {
+#if COAP_BLOCK2_CACHE
+                    if(block_num == 0 && message->code == COAP_GET
+                       && response->payload_len > block_size) {
+                      block2_cache_store(src, message, response);
+                    }
+#endif /* COAP_BLOCK2_CACHE */
                     coap_set_header_block2(response, block_num,
                                            response->payload_len -
                                            block_offset > block_size,
@@ -312,6 +449,7 @@ coap_receive(const coap_endpoint_t *src,
         coap_resource_response_handler_t callback = transaction->callback;
         void *callback_data = transaction->callback_data;
 
+        coap_transaction_response_received(transaction);
         coap_clear_transaction(transaction);
 
         /* check if someone registered for the response */
@@ -385,6 +523,104 @@ coap_engine_init(void)
   coap_transport_init();
   coap_init_connection();
 }
+#if COAP_RESOURCE_TRIE_NODES > 0
+/*---------------------------------------------------------------------------*/
+static coap_trie_node_t *
+trie_find_child(coap_trie_node_t *node, const char *segment, int len)
+{
+  coap_trie_node_t *child;
+
+  for(child = node->child; child != NULL; child = child->sibling) {
+    if(child->segment_len == len && memcmp(child->segment, segment, len) == 0) {
+      return child;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+trie_add(coap_resource_t *resource)
+{
+  coap_trie_node_t *node, *child;
+  const char *segment, *end;
+
+  node = &trie_root;
+  if(*resource->url != '\0') {
+    for(segment = resource->url;; segment = end + 1) {
+      for(end = segment; *end != '\0' && *end != '/'; end++);
+
+      child = trie_find_child(node, segment, end - segment);
+      if(child == NULL) {
+        child = memb_alloc(&trie_nodes_memb);
+        if(child == NULL) {
+          return 0;
+        }
+        child->segment = segment;
+        child->segment_len = end - segment;
+        child->resource = NULL;
+        child->child = NULL;
+        child->sibling = node->child;
+        node->child = child;
+      }
+      node = child;
+
+      if(*end == '\0') {
+        break;
+      }
+    }
+  }
+
+  /* A node holds one resource, but the list scan can pick either of
+     two resources with the same path, depending on their flags */
+  if(node->resource != NULL) {
+    return 0;
+  }
+  node->resource = resource;
+  node->order = trie_resources++;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Returns the resource that the list scan would find: of the resource
+ * with exactly this path and the resources with sub-resources whose
+ * path is a prefix of it, the one activated first.
+ */
+static coap_resource_t *
+trie_lookup(const char *url, int url_len)
+{
+  coap_trie_node_t *node;
+  coap_trie_node_t *match;
+  const char *p, *segment, *end;
+
+  node = &trie_root;
+  match = NULL;
+  p = url;
+  end = url + url_len;
+
+  for(;;) {
+    /* node matches url up to p, which is at the end or at a '/' */
+    if(node->resource != NULL
+       && (p == end || (*p == '/'
+                        && (node->resource->flags & HAS_SUB_RESOURCES)))
+       && (match == NULL || node->order < match->order)) {
+      match = node;
+    }
+    if(p == end) {
+      break;
+    }
+
+    segment = node == &trie_root ? p : p + 1;
+    for(p = segment; p < end && *p != '/'; p++);
+
+    node = trie_find_child(node, segment, p - segment);
+    if(node == NULL) {
+      break;
+    }
+  }
+
+  return match != NULL ? match->resource : NULL;
+}
+#endif /* COAP_RESOURCE_TRIE_NODES > 0 */
 /*---------------------------------------------------------------------------*/
 /**
  * \brief Makes a resource available under the given URI path
@@ -404,6 +640,14 @@ coap_activate_resource(coap_resource_t *resource, const char *path)
 
   LOG_INFO("Activating: %s\n", resource->url);
 
+#if COAP_RESOURCE_TRIE_NODES > 0
+  if(!trie_incomplete && !trie_add(resource)) {
+    LOG_WARN("Resource trie full or path %s used twice, dispatching by list scan\n",
+             resource->url);
+    trie_incomplete = 1;
+  }
+#endif /* COAP_RESOURCE_TRIE_NODES > 0 */
+
   /* Only add periodic resources with a periodic_handler and a period > 0. */
   if(resource->flags & IS_PERIODIC && resource->periodic
      && resource->periodic->periodic_handler
@@ -432,19 +676,18 @@ coap_get_next_resource(coap_resource_t *resource)
   return list_item_next(resource);
 }
 /*---------------------------------------------------------------------------*/
-static int
-invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
-                             uint8_t *buffer, uint16_t buffer_size,
-                             int32_t *offset)
+static coap_resource_t *
+find_resource(const char *url, int url_len)
 {
-  uint8_t found = 0;
-  uint8_t allowed = 1;
+  coap_resource_t *resource;
+  int res_url_len;
 
-  coap_resource_t *resource = NULL;
-  const char *url = NULL;
-  int url_len, res_url_len;
+#if COAP_RESOURCE_TRIE_NODES > 0
+  if(!trie_incomplete) {
+    return trie_lookup(url, url_len);
+  }
+#endif /* COAP_RESOURCE_TRIE_NODES > 0 */
 
-  url_len = coap_get_header_uri_path(request, &url);
   for(resource = list_head(coap_resource_services);
       resource; resource = resource->next) {
 
@@ -455,31 +698,50 @@ invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
             && (resource->flags & HAS_SUB_RESOURCES)
             && url[res_url_len] == '/'))
        && strncmp(resource->url, url, res_url_len) == 0) {
-      coap_resource_flags_t method = coap_get_method_type(request);
-      found = 1;
-
-      LOG_INFO("/%s, method %u, resource->flags %u\n", resource->url,
-               (uint16_t)method, resource->flags);
-
-      if((method & METHOD_GET) && resource->get_handler != NULL) {
-        /* call handler function */
-        resource->get_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_POST) && resource->post_handler != NULL) {
-        /* call handler function */
-        resource->post_handler(request, response, buffer, buffer_size,
+      return resource;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
+                             uint8_t *buffer, uint16_t buffer_size,
+                             int32_t *offset)
+{
+  uint8_t found = 0;
+  uint8_t allowed = 1;
+
+  coap_resource_t *resource = NULL;
+  const char *url = NULL;
+  int url_len;
+
+  url_len = coap_get_header_uri_path(request, &url);
+  resource = find_resource(url, url_len);
+  if(resource != NULL) {
+    coap_resource_flags_t method = coap_get_method_type(request);
+    found = 1;
+
+    LOG_INFO("/%s, method %u, resource->flags %u\n", resource->url,
+             (uint16_t)method, resource->flags);
+
+    if((method & METHOD_GET) && resource->get_handler != NULL) {
+      /* call handler function */
+      resource->get_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_POST) && resource->post_handler != NULL) {
+      /* call handler function */
+      resource->post_handler(request, response, buffer, buffer_size,
+                             offset);
+    } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
+      /* call handler function */
+      resource->put_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
+      /* call handler function */
+      resource->delete_handler(request, response, buffer, buffer_size,
                                offset);
-      } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
-        /* call handler function */
-        resource->put_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
-        /* call handler function */
-        resource->delete_handler(request, response, buffer, buffer_size,
-                                 offset);
-      } else {
-        allowed = 0;
-        coap_set_status_code(response, METHOD_NOT_ALLOWED_4_05);
-      }
-      break;
+    } else {
+      allowed = 0;
+      coap_set_status_code(response, METHOD_NOT_ALLOWED_4_05);
     }
   }
   if(!found) {
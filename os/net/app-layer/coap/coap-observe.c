@@ -56,6 +56,27 @@
 /*---------------------------------------------------------------------------*/
 MEMB(observers_memb, coap_observer_t, COAP_MAX_OBSERVERS);
 LIST(observers_list);
+
+#if COAP_OBSERVE_RENDER_ONCE
+/* The representation is rendered once per notification and copied into
+   the message sent to each observer */
+static uint8_t notification_buffer[COAP_MAX_CHUNK_SIZE];
+#endif /* COAP_OBSERVE_RENDER_ONCE */
+
+#if COAP_OBSERVE_NOTIFY_INTERVAL
+/* A URL notified within the last COAP_OBSERVE_NOTIFY_INTERVAL */
+typedef struct coap_notification {
+  struct coap_notification *next;  /* for LIST */
+
+  coap_resource_t *resource;
+  char url[COAP_OBSERVER_URL_LEN];
+  coap_timer_t timer;
+  uint8_t pending;                 /* changed since it was last notified */
+} coap_notification_t;
+
+MEMB(notifications_memb, coap_notification_t, COAP_MAX_OBSERVERS);
+LIST(notifications_list);
+#endif /* COAP_OBSERVE_NOTIFY_INTERVAL */
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -180,40 +201,56 @@ coap_remove_observer_by_mid(const coap_endpoint_t *endpoint, uint16_t mid)
 /*---------------------------------------------------------------------------*/
 /*- Notification ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
-void
-coap_notify_observers(coap_resource_t *resource)
+/* Runs the handler of the resource into buffer */
+static void
+render_notification(coap_resource_t *resource, coap_message_t *request,
+                    coap_message_t *notification, uint8_t *buffer)
 {
-  coap_notify_observers_sub(resource, NULL);
+  int32_t new_offset = 0;
+
+  /* Either old style get_handler or the full handler */
+  if(coap_call_handlers(request, notification, buffer,
+                        COAP_MAX_CHUNK_SIZE, &new_offset) > 0) {
+    LOG_DBG("Notification on new handlers\n");
+  } else {
+    if(resource != NULL) {
+      resource->get_handler(request, notification, buffer,
+                            COAP_MAX_CHUNK_SIZE, &new_offset);
+    } else {
+      /* What to do here? */
+      notification->code = BAD_REQUEST_4_00;
+    }
+  }
+
+  if(new_offset != 0) {
+    coap_set_header_block2(notification,
+                           0,
+                           new_offset != -1,
+                           COAP_MAX_BLOCK_SIZE);
+    coap_set_payload(notification,
+                     notification->payload,
+                     MIN(notification->payload_len,
+                         COAP_MAX_BLOCK_SIZE));
+  }
 }
-/* Can be used either for sub - or when there is not resource - just
-   a handler */
-void
-coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
+/*---------------------------------------------------------------------------*/
+/* Sends a notification of url to all observers of it and returns the
+   number of notifications sent */
+static int
+notify_url(coap_resource_t *resource, const char *url)
 {
   /* build notification */
   coap_message_t notification[1]; /* this way the message can be treated as pointer as usual */
   coap_message_t request[1]; /* this way the message can be treated as pointer as usual */
   coap_observer_t *obs = NULL;
+  coap_transaction_t *transaction;
   int url_len, obs_url_len;
-  char url[COAP_OBSERVER_URL_LEN];
   uint8_t sub_ok = 0;
+#if COAP_OBSERVE_RENDER_ONCE
+  uint8_t rendered = 0;
+#endif /* COAP_OBSERVE_RENDER_ONCE */
+  int sent = 0;
 
-  if(resource != NULL) {
-    url_len = strlen(resource->url);
-    strncpy(url, resource->url, COAP_OBSERVER_URL_LEN - 1);
-    if(url_len < COAP_OBSERVER_URL_LEN - 1 && subpath != NULL) {
-      strncpy(&url[url_len], subpath, COAP_OBSERVER_URL_LEN - url_len - 1);
-    }
-  } else if(subpath != NULL) {
-    strncpy(url, subpath, COAP_OBSERVER_URL_LEN - 1);
-  } else {
-    /* No resource, no subpath */
-    return;
-  }
-
-  /* Ensure url is null terminated because strncpy does not guarantee this */
-  url[COAP_OBSERVER_URL_LEN - 1] = '\0';
-  /* url now contains the notify URL that needs to match the observer */
   LOG_INFO("Notification from %s\n", url);
 
   coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
@@ -239,16 +276,29 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
             && sub_ok
             && obs->url[url_len] == '/'))
        && strncmp(url, obs->url, url_len) == 0) {
-      coap_transaction_t *transaction = NULL;
 
       /*TODO implement special transaction for CON, sharing the same buffer to allow for more observers */
 
       if((transaction = coap_new_transaction(coap_get_mid(), &obs->endpoint))) {
+#if COAP_OBSERVE_RENDER_ONCE
+        /* the representation is the same for all observers of url */
+        if(!rendered) {
+          rendered = 1;
+          render_notification(resource, request, notification,
+                              notification_buffer);
+        }
+#else /* COAP_OBSERVE_RENDER_ONCE */
+        render_notification(resource, request, notification,
+                            transaction->message + COAP_MAX_HEADER_SIZE);
+#endif /* COAP_OBSERVE_RENDER_ONCE */
+
         /* if COAP_OBSERVE_REFRESH_INTERVAL is zero, never send observations as confirmable messages */
         if(COAP_OBSERVE_REFRESH_INTERVAL != 0
             && (obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0)) {
           LOG_DBG("           Force Confirmable for\n");
           notification->type = COAP_TYPE_CON;
+        } else {
+          notification->type = COAP_TYPE_NON;
         }
 
         LOG_DBG("           Observer ");
@@ -258,27 +308,9 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
         /* update last MID for RST matching */
         obs->last_mid = transaction->mid;
 
-        /* prepare response */
+        /* only MID, token and Observe differ between the observers */
         notification->mid = transaction->mid;
 
-	int32_t new_offset = 0;
-
-        /* Either old style get_handler or the full handler */
-        if(coap_call_handlers(request, notification, transaction->message +
-                              COAP_MAX_HEADER_SIZE, COAP_MAX_CHUNK_SIZE,
-                              &new_offset) > 0) {
-          LOG_DBG("Notification on new handlers\n");
-        } else {
-          if(resource != NULL) {
-            resource->get_handler(request, notification,
-                                  transaction->message + COAP_MAX_HEADER_SIZE,
-                                  COAP_MAX_CHUNK_SIZE, &new_offset);
-          } else {
-            /* What to do here? */
-            notification->code = BAD_REQUEST_4_00;
-          }
-        }
-
         if(notification->code < BAD_REQUEST_4_00) {
           coap_set_header_observe(notification, (obs->obs_counter)++);
           /* mask out to keep the CoAP observe option length <= 3 bytes */
@@ -286,24 +318,105 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
         }
         coap_set_token(notification, obs->token, obs->token_len);
 
-	if(new_offset != 0) {
-	  coap_set_header_block2(notification,
-				 0,
-				 new_offset != -1,
-				 COAP_MAX_BLOCK_SIZE);
-	  coap_set_payload(notification,
-			   notification->payload,
-			   MIN(notification->payload_len,
-			       COAP_MAX_BLOCK_SIZE));
-	}
-
         transaction->message_len =
           coap_serialize_message(notification, transaction->message);
 
         coap_send_transaction(transaction);
+        sent++;
       }
     }
   }
+  return sent;
+}
+/*---------------------------------------------------------------------------*/
+#if COAP_OBSERVE_NOTIFY_INTERVAL
+static void
+notification_timer_callback(coap_timer_t *timer)
+{
+  coap_notification_t *n = coap_timer_get_user_data(timer);
+
+  if(n->pending) {
+    /* send the latest representation of the coalesced changes */
+    n->pending = 0;
+    if(notify_url(n->resource, n->url) > 0) {
+      coap_timer_set(&n->timer, COAP_OBSERVE_NOTIFY_INTERVAL);
+      return;
+    }
+  }
+  list_remove(notifications_list, n);
+  memb_free(&notifications_memb, n);
+}
+/*---------------------------------------------------------------------------*/
+/* Notifies url now, unless it was notified within the last
+   COAP_OBSERVE_NOTIFY_INTERVAL, in which case the notification is
+   deferred to the end of the interval. */
+static void
+notify_url_rate_limited(coap_resource_t *resource, const char *url)
+{
+  coap_notification_t *n;
+
+  for(n = list_head(notifications_list); n != NULL; n = n->next) {
+    if(n->resource == resource && strcmp(n->url, url) == 0) {
+      LOG_DBG("Coalescing notification from %s\n", url);
+      n->pending = 1;
+      return;
+    }
+  }
+
+  if(notify_url(resource, url) == 0) {
+    return;
+  }
+
+  n = memb_alloc(&notifications_memb);
+  if(n == NULL) {
+    /* not rate-limited until a slot is free */
+    return;
+  }
+  n->resource = resource;
+  strcpy(n->url, url);
+  n->pending = 0;
+  coap_timer_set_callback(&n->timer, notification_timer_callback);
+  coap_timer_set_user_data(&n->timer, n);
+  coap_timer_set(&n->timer, COAP_OBSERVE_NOTIFY_INTERVAL);
+  list_add(notifications_list, n);
+}
+#endif /* COAP_OBSERVE_NOTIFY_INTERVAL */
+/*---------------------------------------------------------------------------*/
+void
+coap_notify_observers(coap_resource_t *resource)
+{
+  coap_notify_observers_sub(resource, NULL);
+}
+/* Can be used either for sub - or when there is not resource - just
+   a handler */
+void
+coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
+{
+  int url_len;
+  char url[COAP_OBSERVER_URL_LEN];
+
+  if(resource != NULL) {
+    url_len = strlen(resource->url);
+    strncpy(url, resource->url, COAP_OBSERVER_URL_LEN - 1);
+    if(url_len < COAP_OBSERVER_URL_LEN - 1 && subpath != NULL) {
+      strncpy(&url[url_len], subpath, COAP_OBSERVER_URL_LEN - url_len - 1);
+    }
+  } else if(subpath != NULL) {
+    strncpy(url, subpath, COAP_OBSERVER_URL_LEN - 1);
+  } else {
+    /* No resource, no subpath */
+    return;
+  }
+
+  /* Ensure url is null terminated because strncpy does not guarantee this */
+  url[COAP_OBSERVER_URL_LEN - 1] = '\0';
+  /* url now contains the notify URL that needs to match the observer */
+
+#if COAP_OBSERVE_NOTIFY_INTERVAL
+  notify_url_rate_limited(resource, url);
+#else
+  notify_url(resource, url);
+#endif /* COAP_OBSERVE_NOTIFY_INTERVAL */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -42,6 +42,8 @@
 #ifndef COAP_REQUEST_STATE_H_
 #define COAP_REQUEST_STATE_H_
 
+#include "coap-conf.h"
+
 typedef enum {
   COAP_REQUEST_STATUS_RESPONSE, /* Response received and no more blocks */
   COAP_REQUEST_STATUS_MORE, /* Response received and there are more blocks */
@@ -51,6 +53,18 @@ typedef enum {
 } coap_request_status_t;
 
 
+#if COAP_BLOCK2_WINDOW > 1
+struct coap_request_state;
+
+/* One outstanding Block2 request of a windowed transfer */
+typedef struct coap_request_block {
+  struct coap_request_state *state;
+  uint32_t num;
+  uint16_t mid;
+  uint8_t busy;
+} coap_request_block_t;
+#endif /* COAP_BLOCK2_WINDOW > 1 */
+
 typedef struct coap_request_state {
   coap_transaction_t *transaction;
   coap_message_t *response;
@@ -62,6 +76,11 @@ typedef struct coap_request_state {
   uint8_t block_error;
   void *user_data;
   coap_request_status_t status;
+#if COAP_BLOCK2_WINDOW > 1
+  coap_request_block_t window[COAP_BLOCK2_WINDOW];
+  uint32_t end_block; /* first block number that does not exist */
+  uint32_t received;  /* blocks passed to the callback */
+#endif /* COAP_BLOCK2_WINDOW > 1 */
 } coap_request_state_t;
 
 
@@ -45,8 +45,8 @@
 #include "coap-observe.h"
 #include "coap-timer.h"
 #include "lib/memb.h"
-#include "lib/list.h"
 #include <stdlib.h>
+#include <string.h>
 
 /* Log configuration */
 #include "coap-log.h"
@@ -55,17 +55,316 @@
 
 /*---------------------------------------------------------------------------*/
 MEMB(transactions_memb, coap_transaction_t, COAP_MAX_OPEN_TRANSACTIONS);
-LIST(transactions_list);
 
+/* Open transactions, hashed by MID */
+static coap_transaction_t *transactions_hash[COAP_TRANSACTION_HASH_SIZE];
+#define MID_HASH(mid) ((mid) & (COAP_TRANSACTION_HASH_SIZE - 1))
+#if COAP_TRANSACTION_HASH_SIZE < 1 || (COAP_TRANSACTION_HASH_SIZE & (COAP_TRANSACTION_HASH_SIZE - 1)) != 0
+#error COAP_TRANSACTION_HASH_SIZE must be a power of two
+#endif
+
+/*
+ * All retransmissions are scheduled on one timer wheel. A transaction due
+ * in n ticks goes to the slot n ahead of the current one, with the number
+ * of full turns of the wheel to wait before it expires. The single timer
+ * is set to the next occupied slot.
+ */
+#define WHEEL_SLOT_NONE    0xff
+#define WHEEL_SLOT_EXPIRED 0xfe
+static coap_transaction_t *wheel[COAP_RETRANSMIT_WHEEL_SLOTS];
+static coap_transaction_t *wheel_expired;
+static uint8_t wheel_pos;
+static uint8_t wheel_count;
+static uint64_t wheel_time;           /* start of the current slot */
+static coap_timer_t wheel_timer;
+
+#if COAP_WITH_CONGESTION_CONTROL
+/* CoCoA state of an endpoint (draft-ietf-core-cocoa), times in msec */
+typedef struct coap_peer {
+  coap_endpoint_t endpoint;
+  uint32_t rto;
+  uint32_t srtt_strong;
+  uint32_t rttvar_strong;
+  uint32_t srtt_weak;
+  uint32_t rttvar_weak;
+  uint32_t last_update;
+  uint8_t in_flight;
+  uint8_t has_strong;
+  uint8_t has_weak;
+  uint8_t used;
+} coap_peer_t;
+
+#define COAP_RTO_INITIAL   COAP_RESPONSE_TIMEOUT_TICKS
+#define COAP_RTO_MAX       32000
+
+static coap_peer_t peers[COAP_MAX_PEERS];
+#endif /* COAP_WITH_CONGESTION_CONTROL */
+
+static void coap_retransmit_transaction(coap_transaction_t *t);
+/*---------------------------------------------------------------------------*/
+static void
+wheel_arm(void)
+{
+  uint64_t now, expiration;
+  uint8_t k;
+
+  for(k = 1; k <= COAP_RETRANSMIT_WHEEL_SLOTS; k++) {
+    if(wheel[(wheel_pos + k) % COAP_RETRANSMIT_WHEEL_SLOTS] != NULL) {
+      now = coap_timer_uptime();
+      expiration = wheel_time + (uint64_t)k * COAP_RETRANSMIT_WHEEL_TICK;
+      coap_timer_set(&wheel_timer, expiration > now ? expiration - now : 0);
+      return;
+    }
+  }
+  coap_timer_stop(&wheel_timer);
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_timer_callback(coap_timer_t *timer)
+{
+  coap_transaction_t **tp, *t;
+  uint64_t now;
+
+  now = coap_timer_uptime();
+  while(wheel_count > 0 && wheel_time + COAP_RETRANSMIT_WHEEL_TICK <= now) {
+    wheel_pos = (wheel_pos + 1) % COAP_RETRANSMIT_WHEEL_SLOTS;
+    wheel_time += COAP_RETRANSMIT_WHEEL_TICK;
+
+    for(tp = &wheel[wheel_pos]; *tp != NULL;) {
+      t = *tp;
+      if(t->wheel_rounds == 0) {
+        *tp = t->wheel_next;
+        wheel_count--;
+        t->wheel_slot = WHEEL_SLOT_EXPIRED;
+        t->wheel_next = wheel_expired;
+        wheel_expired = t;
+      } else {
+        t->wheel_rounds--;
+        tp = &t->wheel_next;
+      }
+    }
+  }
+
+  /* A retransmission may clear other expired transactions, so they are
+     taken off the expired list one at a time */
+  while(wheel_expired != NULL) {
+    t = wheel_expired;
+    wheel_expired = t->wheel_next;
+    t->wheel_slot = WHEEL_SLOT_NONE;
+    coap_retransmit_transaction(t);
+  }
+
+  wheel_arm();
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_remove(coap_transaction_t *t)
+{
+  coap_transaction_t **tp;
+
+  if(t->wheel_slot == WHEEL_SLOT_NONE) {
+    return;
+  }
+
+  tp = t->wheel_slot == WHEEL_SLOT_EXPIRED ? &wheel_expired : &wheel[t->wheel_slot];
+  for(; *tp != NULL; tp = &(*tp)->wheel_next) {
+    if(*tp == t) {
+      *tp = t->wheel_next;
+      if(t->wheel_slot != WHEEL_SLOT_EXPIRED) {
+        wheel_count--;
+      }
+      break;
+    }
+  }
+  t->wheel_slot = WHEEL_SLOT_NONE;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_add(coap_transaction_t *t, uint32_t interval)
+{
+  uint64_t now;
+  uint32_t ticks, rounds;
+
+  wheel_remove(t);
+  now = coap_timer_uptime();
+  if(wheel_count == 0) {
+    wheel_time = now;
+  }
+
+  ticks = (now - wheel_time + interval + COAP_RETRANSMIT_WHEEL_TICK - 1) /
+    COAP_RETRANSMIT_WHEEL_TICK;
+  if(ticks == 0) {
+    ticks = 1;
+  }
+  rounds = (ticks - 1) / COAP_RETRANSMIT_WHEEL_SLOTS;
+
+  t->wheel_slot = (wheel_pos + ticks) % COAP_RETRANSMIT_WHEEL_SLOTS;
+  t->wheel_rounds = rounds > 0xff ? 0xff : rounds;
+  t->wheel_next = wheel[t->wheel_slot];
+  wheel[t->wheel_slot] = t;
+  wheel_count++;
+
+  coap_timer_set_callback(&wheel_timer, wheel_timer_callback);
+  wheel_arm();
+}
+/*---------------------------------------------------------------------------*/
+#if COAP_WITH_CONGESTION_CONTROL
+static coap_peer_t *
+peer_get(const coap_endpoint_t *endpoint)
+{
+  coap_peer_t *p, *victim;
+  uint32_t now;
+
+  now = (uint32_t)coap_timer_uptime();
+  victim = NULL;
+  for(p = peers; p < &peers[COAP_MAX_PEERS]; p++) {
+    if(p->used && coap_endpoint_cmp(&p->endpoint, endpoint)) {
+      return p;
+    }
+    /* replace an unused or the least recently updated idle peer */
+    if(p->in_flight == 0 &&
+       (victim == NULL || !p->used ||
+        (victim->used && now - p->last_update > now - victim->last_update))) {
+      victim = p;
+    }
+  }
+
+  if(victim != NULL) {
+    memset(victim, 0, sizeof(coap_peer_t));
+    coap_endpoint_copy(&victim->endpoint, endpoint);
+    victim->rto = COAP_RTO_INITIAL;
+    victim->last_update = now;
+    victim->used = 1;
+  }
+  return victim;
+}
+/*---------------------------------------------------------------------------*/
+/* Let the RTO of a peer that has not been measured for a while drift back
+   towards the initial value */
+static void
+peer_age(coap_peer_t *p)
+{
+  uint32_t now, elapsed;
+
+  now = (uint32_t)coap_timer_uptime();
+  elapsed = now - p->last_update;
+  if(p->rto < 1000 && elapsed > 16 * p->rto) {
+    p->rto *= 2;
+    p->last_update = now;
+  } else if(p->rto > 3000 && elapsed > 4 * p->rto) {
+    p->rto = (COAP_RTO_INITIAL + p->rto) / 2;
+    p->last_update = now;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* RFC 6298 estimator with the variance factor k, returns the estimated RTO */
+static uint32_t
+rtt_estimate(uint32_t *srtt, uint32_t *rttvar, uint8_t *valid,
+             uint32_t rtt, uint8_t k)
+{
+  if(!*valid) {
+    *srtt = rtt;
+    *rttvar = rtt / 2;
+    *valid = 1;
+  } else {
+    *rttvar = (3 * *rttvar + (*srtt > rtt ? *srtt - rtt : rtt - *srtt)) / 4;
+    *srtt = (7 * *srtt + rtt) / 8;
+  }
+  return *srtt + k * *rttvar;
+}
 /*---------------------------------------------------------------------------*/
 static void
-coap_retransmit_transaction(coap_timer_t *nt)
+peer_update_rto(coap_peer_t *p, uint32_t rtt, uint8_t retransmissions)
 {
-  coap_transaction_t *t = coap_timer_get_user_data(nt);
-  if(t == NULL) {
-    LOG_DBG("No retransmission data in coap_timer!\n");
+  uint32_t estimate;
+
+  if(retransmissions == 0) {
+    estimate = rtt_estimate(&p->srtt_strong, &p->rttvar_strong,
+                            &p->has_strong, rtt, 4);
+    p->rto = (estimate + p->rto) / 2;
+  } else if(retransmissions <= 2) {
+    /* RTT from the first transmission, ambiguous but still useful */
+    estimate = rtt_estimate(&p->srtt_weak, &p->rttvar_weak,
+                            &p->has_weak, rtt, 1);
+    p->rto = (estimate + 3 * p->rto) / 4;
+  } else {
     return;
   }
+
+  if(p->rto > COAP_RTO_MAX) {
+    p->rto = COAP_RTO_MAX;
+  }
+  p->last_update = (uint32_t)coap_timer_uptime();
+  LOG_DBG("RTT %lu msec, RTO now %lu msec\n", (unsigned long)rtt,
+          (unsigned long)p->rto);
+}
+/*---------------------------------------------------------------------------*/
+/* Variable backoff: short RTOs back off faster, long ones slower */
+static uint32_t
+peer_backoff(const coap_peer_t *p, uint32_t interval)
+{
+  if(p->rto < 1000) {
+    return interval * 3;
+  } else if(p->rto > 3000) {
+    return interval + interval / 2;
+  }
+  return interval * 2;
+}
+/*---------------------------------------------------------------------------*/
+/* Takes one of the NSTART slots of the peer of a CON transaction. Returns 0
+   if they are all taken. */
+static int
+peer_start(coap_transaction_t *t)
+{
+  coap_peer_t *p = peer_get(&t->endpoint);
+
+  if(p == NULL) {
+    /* no state available, send without congestion control */
+    return 1;
+  }
+  if(p->in_flight >= COAP_NSTART) {
+    return 0;
+  }
+  peer_age(p);
+  p->in_flight++;
+  t->peer = p;
+  t->start_time = (uint32_t)coap_timer_uptime();
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+peer_done(coap_peer_t *p, uint16_t mid)
+{
+  coap_transaction_t *next, *q;
+  uint8_t i;
+
+  if(p == NULL) {
+    return;
+  }
+  p->in_flight--;
+
+  /* send the transaction that was queued first, they have increasing MIDs */
+  next = NULL;
+  for(i = 0; i < COAP_TRANSACTION_HASH_SIZE; i++) {
+    for(q = transactions_hash[i]; q != NULL; q = q->next) {
+      if(q->queued && coap_endpoint_cmp(&q->endpoint, &p->endpoint)
+         && (next == NULL
+             || (uint16_t)(q->mid - mid) < (uint16_t)(next->mid - mid))) {
+        next = q;
+      }
+    }
+  }
+  if(next != NULL) {
+    LOG_DBG("Dequeuing transaction %u\n", next->mid);
+    next->queued = 0;
+    coap_send_transaction(next);
+  }
+}
+#endif /* COAP_WITH_CONGESTION_CONTROL */
+/*---------------------------------------------------------------------------*/
+static void
+coap_retransmit_transaction(coap_transaction_t *t)
+{
   ++(t->retrans_counter);
   LOG_DBG("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
   coap_send_transaction(t);
@@ -83,11 +382,17 @@ coap_new_transaction(uint16_t mid, const coap_endpoint_t *endpoint)
   if(t) {
     t->mid = mid;
     t->retrans_counter = 0;
+    t->wheel_slot = WHEEL_SLOT_NONE;
+#if COAP_WITH_CONGESTION_CONTROL
+    t->peer = NULL;
+    t->queued = 0;
+#endif /* COAP_WITH_CONGESTION_CONTROL */
 
     /* save client address */
     coap_endpoint_copy(&t->endpoint, endpoint);
 
-    list_add(transactions_list, t); /* list itself makes sure same element is not added twice */
+    t->next = transactions_hash[MID_HASH(mid)];
+    transactions_hash[MID_HASH(mid)] = t;
   }
 
   return t;
@@ -101,26 +406,44 @@ coap_send_transaction(coap_transaction_t *t)
   if(COAP_TYPE_CON ==
      ((COAP_HEADER_TYPE_MASK & t->message[0]) >> COAP_HEADER_TYPE_POSITION)) {
     if(t->retrans_counter <= COAP_MAX_RETRANSMIT) {
+#if COAP_WITH_CONGESTION_CONTROL
+      if(t->retrans_counter == 0 && t->peer == NULL && !peer_start(t)) {
+        LOG_DBG("NSTART reached, queuing transaction %u\n", t->mid);
+        t->queued = 1;
+        return;
+      }
+#endif /* COAP_WITH_CONGESTION_CONTROL */
+
       /* not timed out yet */
       coap_sendto(&t->endpoint, t->message, t->message_len);
       LOG_DBG("Keeping transaction %u\n", t->mid);
 
       if(t->retrans_counter == 0) {
-        coap_timer_set_callback(&t->retrans_timer, coap_retransmit_transaction);
-        coap_timer_set_user_data(&t->retrans_timer, t);
+#if COAP_WITH_CONGESTION_CONTROL
+        if(t->peer != NULL) {
+          /* random between RTO and 1.5 * RTO */
+          t->retrans_interval = t->peer->rto +
+            (rand() % (t->peer->rto / 2 + 1));
+        } else
+#endif /* COAP_WITH_CONGESTION_CONTROL */
         t->retrans_interval =
           COAP_RESPONSE_TIMEOUT_TICKS + (rand() %
                                          COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
         LOG_DBG("Initial interval %lu msec\n",
                 (unsigned long)t->retrans_interval);
       } else {
+#if COAP_WITH_CONGESTION_CONTROL
+        if(t->peer != NULL) {
+          t->retrans_interval = peer_backoff(t->peer, t->retrans_interval);
+        } else
+#endif /* COAP_WITH_CONGESTION_CONTROL */
         t->retrans_interval <<= 1;  /* double */
-        LOG_DBG("Doubled (%u) interval %lu s\n", t->retrans_counter,
+        LOG_DBG("Backed off (%u) interval %lu s\n", t->retrans_counter,
                 (unsigned long)(t->retrans_interval / 1000));
       }
 
       /* interval updated above */
-      coap_timer_set(&t->retrans_timer, t->retrans_interval);
+      wheel_add(t, t->retrans_interval);
     } else {
       /* timed out */
       LOG_DBG("Timeout\n");
@@ -145,12 +468,30 @@ coap_send_transaction(coap_transaction_t *t)
 void
 coap_clear_transaction(coap_transaction_t *t)
 {
+  coap_transaction_t **tp;
+
   if(t) {
+#if COAP_WITH_CONGESTION_CONTROL
+    coap_peer_t *peer = t->peer;
+    uint16_t mid = t->mid;
+#endif /* COAP_WITH_CONGESTION_CONTROL */
+
     LOG_DBG("Freeing transaction %u: %p\n", t->mid, t);
 
-    coap_timer_stop(&t->retrans_timer);
-    list_remove(transactions_list, t);
+    wheel_remove(t);
+    for(tp = &transactions_hash[MID_HASH(t->mid)]; *tp != NULL;
+        tp = &(*tp)->next) {
+      if(*tp == t) {
+        *tp = t->next;
+        break;
+      }
+    }
     memb_free(&transactions_memb, t);
+
+#if COAP_WITH_CONGESTION_CONTROL
+    /* may send a queued transaction, so only once t is gone */
+    peer_done(peer, mid);
+#endif /* COAP_WITH_CONGESTION_CONTROL */
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -159,7 +500,7 @@ coap_get_transaction_by_mid(uint16_t mid)
 {
   coap_transaction_t *t = NULL;
 
-  for(t = (coap_transaction_t *)list_head(transactions_list); t; t = t->next) {
+  for(t = transactions_hash[MID_HASH(mid)]; t; t = t->next) {
     if(t->mid == mid) {
       LOG_DBG("Found transaction for MID %u: %p\n", t->mid, t);
       return t;
@@ -168,4 +509,16 @@ coap_get_transaction_by_mid(uint16_t mid)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+void
+coap_transaction_response_received(coap_transaction_t *t)
+{
+#if COAP_WITH_CONGESTION_CONTROL
+  if(t->peer != NULL) {
+    peer_update_rto(t->peer,
+                    (uint32_t)coap_timer_uptime() - t->start_time,
+                    t->retrans_counter);
+  }
+#endif /* COAP_WITH_CONGESTION_CONTROL */
+}
+/*---------------------------------------------------------------------------*/
 /** @} */
@@ -55,14 +55,24 @@
 #define COAP_RESPONSE_TIMEOUT_TICKS         (1000 * COAP_RESPONSE_TIMEOUT)
 #define COAP_RESPONSE_TIMEOUT_BACKOFF_MASK  (uint32_t)(((1000 * COAP_RESPONSE_TIMEOUT * ((float)COAP_RESPONSE_RANDOM_FACTOR - 1.0)) + 0.5) + 1)
 
+struct coap_peer;
+
 /* container for transactions with message buffer and retransmission info */
 typedef struct coap_transaction {
-  struct coap_transaction *next;        /* for LIST */
+  struct coap_transaction *next;        /* for the MID hash */
+  struct coap_transaction *wheel_next;  /* for the retransmission wheel */
 
   uint16_t mid;
-  coap_timer_t retrans_timer;
   uint32_t retrans_interval;
   uint8_t retrans_counter;
+  uint8_t wheel_slot;
+  uint8_t wheel_rounds;
+
+#if COAP_WITH_CONGESTION_CONTROL
+  struct coap_peer *peer;               /* set while the CON is in flight */
+  uint32_t start_time;                  /* of the first transmission */
+  uint8_t queued;                       /* waiting for NSTART */
+#endif /* COAP_WITH_CONGESTION_CONTROL */
 
   coap_endpoint_t endpoint;
 
@@ -78,6 +88,7 @@ coap_transaction_t *coap_new_transaction(uint16_t mid, const coap_endpoint_t *ep
 void coap_send_transaction(coap_transaction_t *t);
 void coap_clear_transaction(coap_transaction_t *t);
 coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid);
+void coap_transaction_response_received(coap_transaction_t *t);
 
 #endif /* COAP_TRANSACTIONS_H_ */
 /** @} */
@@ -266,6 +266,13 @@ abort_connection(struct mqtt_connection *conn)
   /* Reset outgoing packet */
   memset(&conn->out_packet, 0, sizeof(conn->out_packet));
 
+#if MQTT_OUT_RING_SIZE
+  /* Messages not yet acknowledged are lost with the connection */
+  conn->out_ring_head = 0;
+  conn->out_ring_len = 0;
+  memset(conn->inflight, 0, sizeof(conn->inflight));
+#endif
+
   tcp_socket_close(&conn->socket);
   tcp_socket_unregister(&conn->socket);
 
@@ -827,6 +834,7 @@ PT_THREAD(unsubscribe_pt(struct pt *pt, struct mqtt_connection *conn))
   PT_END(pt);
 }
 /*---------------------------------------------------------------------------*/
+#if !MQTT_OUT_RING_SIZE
 static
 PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
 {
@@ -932,6 +940,100 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
 
   PT_END(pt);
 }
+#endif /* !MQTT_OUT_RING_SIZE */
+/*---------------------------------------------------------------------------*/
+#if MQTT_OUT_RING_SIZE
+static void
+out_ring_write(struct mqtt_connection *conn, const uint8_t *data, uint16_t len)
+{
+  uint16_t tail, first;
+
+  tail = (conn->out_ring_head + conn->out_ring_len) % MQTT_OUT_RING_SIZE;
+  first = MIN(len, MQTT_OUT_RING_SIZE - tail);
+  memcpy(&conn->out_ring[tail], data, first);
+  memcpy(conn->out_ring, data + first, len - first);
+  conn->out_ring_len += len;
+}
+/*---------------------------------------------------------------------------*/
+static void
+out_ring_write_byte(struct mqtt_connection *conn, uint8_t data)
+{
+  out_ring_write(conn, &data, 1);
+}
+/*---------------------------------------------------------------------------*/
+static struct mqtt_inflight *
+inflight_lookup(struct mqtt_connection *conn, uint16_t mid, uint8_t state)
+{
+  struct mqtt_inflight *m;
+
+  for(m = conn->inflight; m < &conn->inflight[MQTT_MAX_INFLIGHT]; m++) {
+    if(m->state == state && m->mid == mid) {
+      return m;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Returns a free in-flight slot. Like without the ring, a message that has
+ * not been acknowledged within RESPONSE_WAIT_TIMEOUT is given up on.
+ */
+static struct mqtt_inflight *
+inflight_alloc(struct mqtt_connection *conn)
+{
+  struct mqtt_inflight *m;
+
+  for(m = conn->inflight; m < &conn->inflight[MQTT_MAX_INFLIGHT]; m++) {
+    if(m->state != MQTT_INFLIGHT_FREE &&
+       clock_time() - m->time > RESPONSE_WAIT_TIMEOUT) {
+      DBG("MQTT - Timeout waiting for ACK of MID %u\n", m->mid);
+      m->state = MQTT_INFLIGHT_FREE;
+    }
+    if(m->state == MQTT_INFLIGHT_FREE) {
+      return m;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Ring space kept for the PUBREL of each QoS 2 message awaiting PUBREC */
+static uint16_t
+out_ring_reserved(struct mqtt_connection *conn)
+{
+  struct mqtt_inflight *m;
+  uint16_t reserved = 0;
+
+  for(m = conn->inflight; m < &conn->inflight[MQTT_MAX_INFLIGHT]; m++) {
+    if(m->state == MQTT_INFLIGHT_WAIT_PUBREC) {
+      reserved += 4;
+    }
+  }
+  return reserved;
+}
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(out_ring_pt(struct pt *pt, struct mqtt_connection *conn))
+{
+  static uint16_t chunk;
+
+  PT_BEGIN(pt);
+
+  /* Write everything queued, back to back, in as few segments as possible */
+  while(conn->out_ring_len > 0) {
+    chunk = MIN(conn->out_ring_len, MQTT_OUT_RING_SIZE - conn->out_ring_head);
+    PT_MQTT_WRITE_BYTES(conn, &conn->out_ring[conn->out_ring_head], chunk);
+    conn->out_ring_head = (conn->out_ring_head + chunk) % MQTT_OUT_RING_SIZE;
+    conn->out_ring_len -= chunk;
+  }
+
+  send_out_buffer(conn);
+
+  /* Let the application queue more */
+  process_post(conn->app_process, mqtt_update_event, NULL);
+
+  PT_END(pt);
+}
+#endif /* MQTT_OUT_RING_SIZE */
 /*---------------------------------------------------------------------------*/
 static
 PT_THREAD(pingreq_pt(struct pt *pt, struct mqtt_connection *conn))
@@ -1146,10 +1248,69 @@ handle_puback(struct mqtt_connection *conn)
 {
   DBG("MQTT - Got PUBACK\n");
 
+#if MQTT_OUT_RING_SIZE
+  struct mqtt_inflight *m;
+
+  m = inflight_lookup(conn, conn->in_packet.mid, MQTT_INFLIGHT_WAIT_PUBACK);
+  if(m == NULL) {
+    DBG("MQTT - Warning, got PUBACK for unknown MID %u\n",
+        conn->in_packet.mid);
+    return;
+  }
+  m->state = MQTT_INFLIGHT_FREE;
+#else
   conn->out_packet.qos_state = MQTT_QOS_STATE_GOT_ACK;
+#endif
+
+  call_event(conn, MQTT_EVENT_PUBACK, &conn->in_packet.mid);
+}
+/*---------------------------------------------------------------------------*/
+#if MQTT_OUT_RING_SIZE
+static void
+handle_pubrec(struct mqtt_connection *conn)
+{
+  struct mqtt_inflight *m;
+
+  DBG("MQTT - Got PUBREC\n");
+
+  m = inflight_lookup(conn, conn->in_packet.mid, MQTT_INFLIGHT_WAIT_PUBREC);
+  if(m == NULL) {
+    DBG("MQTT - Warning, got PUBREC for unknown MID %u\n",
+        conn->in_packet.mid);
+    return;
+  }
+
+  if(conn->out_ring_len == 0) {
+    process_post(&mqtt_process, mqtt_do_publish_event, conn);
+  }
+
+  /* Room for the PUBREL was reserved when the PUBLISH was queued */
+  out_ring_write_byte(conn, MQTT_FHDR_MSG_TYPE_PUBREL | MQTT_FHDR_QOS_LEVEL_1);
+  out_ring_write_byte(conn, MQTT_MID_SIZE);
+  out_ring_write_byte(conn, conn->in_packet.mid >> 8);
+  out_ring_write_byte(conn, conn->in_packet.mid & 0x00FF);
+  m->state = MQTT_INFLIGHT_WAIT_PUBCOMP;
+  m->time = clock_time();
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_pubcomp(struct mqtt_connection *conn)
+{
+  struct mqtt_inflight *m;
+
+  DBG("MQTT - Got PUBCOMP\n");
+
+  m = inflight_lookup(conn, conn->in_packet.mid, MQTT_INFLIGHT_WAIT_PUBCOMP);
+  if(m == NULL) {
+    DBG("MQTT - Warning, got PUBCOMP for unknown MID %u\n",
+        conn->in_packet.mid);
+    return;
+  }
+  m->state = MQTT_INFLIGHT_FREE;
 
   call_event(conn, MQTT_EVENT_PUBACK, &conn->in_packet.mid);
 }
+#endif /* MQTT_OUT_RING_SIZE */
 /*---------------------------------------------------------------------------*/
 static mqtt_pub_status_t
 handle_publish(struct mqtt_connection *conn)
@@ -1250,6 +1411,97 @@ parse_publish_vhdr(struct mqtt_connection *conn,
   }
 }
 /*---------------------------------------------------------------------------*/
+#if MQTT_STREAM_PUBLISH
+/*
+ * Called once the PUBLISH topic is known. Hands the payload bytes of this
+ * TCP segment to the application in place, without copying them to the
+ * packet buffer. MQTTv5 properties are still collected in the packet buffer,
+ * since they are parsed from there.
+ */
+static mqtt_pub_status_t
+stream_publish(struct mqtt_connection *conn,
+               uint32_t *pos,
+               const uint8_t *input_data_ptr,
+               int input_data_len)
+{
+  uint32_t copy_bytes;
+#if MQTT_5
+  uint16_t props_len;
+  uint8_t enc_len;
+  uint32_t want;
+
+  while(!conn->in_packet.has_props) {
+    /* Read the property length one byte at a time, then the properties */
+    if(conn->in_packet.properties_enc_len == 0 &&
+       conn->in_packet.payload_pos > 0 &&
+       (conn->in_packet.payload[conn->in_packet.payload_pos - 1] & 0x80) == 0) {
+      props_len = 0;
+      enc_len = mqtt_decode_var_byte_int(conn->in_packet.payload,
+                                         conn->in_packet.payload_pos,
+                                         NULL, NULL, &props_len);
+      if(enc_len == 0) {
+        PRINTF("MQTT - Error, invalid PUBLISH property length\n");
+        call_event(conn, MQTT_EVENT_ERROR, NULL);
+        abort_connection(conn);
+        return MQTT_PUBLISH_ERR;
+      }
+      conn->in_packet.properties_enc_len = enc_len;
+      conn->in_packet.properties_len = props_len;
+    }
+
+    if(conn->in_packet.properties_enc_len == 0) {
+      want = 1;
+    } else {
+      want = (uint32_t)conn->in_packet.properties_enc_len +
+        conn->in_packet.properties_len - conn->in_packet.payload_pos;
+      if(want == 0) {
+        conn->in_packet.payload_start = conn->in_packet.payload;
+        mqtt_prop_decode_input_props(conn);
+        conn->in_publish_msg.payload_length -= conn->in_packet.payload_pos;
+        break;
+      }
+    }
+
+    if(want > MQTT_INPUT_BUFF_SIZE - conn->in_packet.payload_pos ||
+       want > conn->in_publish_msg.payload_left) {
+      PRINTF("MQTT - Error, PUBLISH properties do not fit the input buffer\n");
+      call_event(conn, MQTT_EVENT_ERROR, NULL);
+      abort_connection(conn);
+      return MQTT_PUBLISH_ERR;
+    }
+
+    if(*pos >= input_data_len) {
+      return MQTT_PUBLISH_OK;
+    }
+
+    copy_bytes = MIN(want, input_data_len - *pos);
+    memcpy(&conn->in_packet.payload[conn->in_packet.payload_pos],
+           &input_data_ptr[*pos], copy_bytes);
+    conn->in_packet.payload_pos += copy_bytes;
+    conn->in_packet.byte_counter += copy_bytes;
+    conn->in_publish_msg.payload_left -= copy_bytes;
+    *pos += copy_bytes;
+  }
+#endif
+
+  copy_bytes = MIN(input_data_len - *pos, conn->in_publish_msg.payload_left);
+  if(copy_bytes == 0 && conn->in_publish_msg.payload_left > 0) {
+    return MQTT_PUBLISH_OK;
+  }
+
+  DBG("MQTT - Streaming %i payload bytes\n", copy_bytes);
+
+  conn->in_publish_msg.payload_chunk = (uint8_t *)&input_data_ptr[*pos];
+  conn->in_publish_msg.payload_chunk_length = copy_bytes;
+  conn->in_publish_msg.payload_left -= copy_bytes;
+  conn->in_packet.byte_counter += copy_bytes;
+  *pos += copy_bytes;
+
+  /* Resets the packet after the last chunk */
+  return handle_publish(conn);
+}
+#endif
+/*---------------------------------------------------------------------------*/
 /* MQTTv5 only */
 #if MQTT_5
 static void
@@ -1295,6 +1547,9 @@ parse_vhdr(struct mqtt_connection *conn)
   /* Some message types include a packet identifier */
   switch(conn->in_packet.fhdr & 0xF0) {
   case MQTT_FHDR_MSG_TYPE_PUBACK:
+  case MQTT_FHDR_MSG_TYPE_PUBREC:
+  case MQTT_FHDR_MSG_TYPE_PUBREL:
+  case MQTT_FHDR_MSG_TYPE_PUBCOMP:
   case MQTT_FHDR_MSG_TYPE_SUBACK:
   case MQTT_FHDR_MSG_TYPE_UNSUBACK:
     conn->in_packet.mid = (conn->in_packet.payload[0] << 8) |
@@ -1420,6 +1675,15 @@ tcp_input(struct tcp_socket *s,
       parse_publish_vhdr(conn, &pos, input_data_ptr, input_data_len);
     }
 
+#if MQTT_STREAM_PUBLISH
+    if((conn->in_packet.fhdr & 0xF0) == MQTT_FHDR_MSG_TYPE_PUBLISH &&
+       conn->in_packet.topic_received) {
+      /* The rest of this segment is consumed by the PUBLISH */
+      stream_publish(conn, &pos, input_data_ptr, input_data_len);
+      return 0;
+    }
+#endif
+
     /* Read in as much as we can into the packet payload */
     copy_bytes = MIN(input_data_len - pos,
                      MQTT_INPUT_BUFF_SIZE - conn->in_packet.payload_pos);
@@ -1536,10 +1800,19 @@ tcp_input(struct tcp_socket *s,
     handle_pingresp(conn);
     break;
 
-  /* QoS 2 not implemented yet */
+#if MQTT_OUT_RING_SIZE
   case MQTT_FHDR_MSG_TYPE_PUBREC:
-  case MQTT_FHDR_MSG_TYPE_PUBREL:
+    handle_pubrec(conn);
+    break;
   case MQTT_FHDR_MSG_TYPE_PUBCOMP:
+    handle_pubcomp(conn);
+    break;
+#else
+  case MQTT_FHDR_MSG_TYPE_PUBREC:
+  case MQTT_FHDR_MSG_TYPE_PUBCOMP:
+#endif
+  /* QoS 2 not implemented yet for incoming messages */
+  case MQTT_FHDR_MSG_TYPE_PUBREL:
     call_event(conn, MQTT_EVENT_NOT_IMPLEMENTED_ERROR, NULL);
     PRINTF("MQTT - Got unhandled MQTT Message Type '%i'",
            (conn->in_packet.fhdr & 0xF0));
@@ -1608,6 +1881,12 @@ tcp_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
     if(conn->socket.output_data_len == 0) {
       conn->out_buffer_sent = 1;
       conn->out_buffer_ptr = conn->out_buffer;
+#if MQTT_OUT_RING_SIZE
+      /* Publishes queued while TCP was sending */
+      if(conn->out_ring_len > 0) {
+        process_post(&mqtt_process, mqtt_do_publish_event, conn);
+      }
+#endif
     }
 
     ctimer_restart(&conn->keep_alive_timer);
@@ -1720,10 +1999,17 @@ PROCESS_THREAD(mqtt_process, ev, data)
       if(conn->out_buffer_sent == 1 &&
          conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
         PT_INIT(&conn->out_proto_thread);
+#if MQTT_OUT_RING_SIZE
+        while(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER &&
+              out_ring_pt(&conn->out_proto_thread, conn) < PT_EXITED) {
+          PT_MQTT_WAIT_SEND();
+        }
+#else
         while(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER &&
               publish_pt(&conn->out_proto_thread, conn) < PT_EXITED) {
           PT_MQTT_WAIT_SEND();
         }
+#endif
       }
     }
 #if MQTT_5
@@ -1975,6 +2261,122 @@ mqtt_unsubscribe(struct mqtt_connection *conn, uint16_t *mid,
   return MQTT_STATUS_OK;
 }
 /*----------------------------------------------------------------------------*/
+#if MQTT_OUT_RING_SIZE
+/* Serializes a PUBLISH into the outbound ring */
+static mqtt_status_t
+publish_to_ring(struct mqtt_connection *conn, uint16_t *mid, char *topic,
+                uint8_t *payload, uint32_t payload_size,
+                mqtt_qos_level_t qos_level,
+#if MQTT_5
+                mqtt_retain_t retain, mqtt_topic_alias_en_t topic_alias_en,
+                struct mqtt_prop_list *prop_list)
+#else
+                mqtt_retain_t retain)
+#endif
+{
+  struct mqtt_inflight *m = NULL;
+  uint8_t fhdr;
+  uint8_t remaining_length_enc[MQTT_MAX_REMAINING_LENGTH_BYTES];
+  uint8_t remaining_length_enc_bytes;
+  uint32_t remaining_length;
+  uint16_t topic_length;
+  uint16_t packet_mid;
+  uint8_t was_empty;
+  int space;
+#if MQTT_5
+  struct mqtt_prop_out_property *prop;
+#endif
+
+#if MQTT_5
+  if(topic_alias_en == MQTT_TOPIC_ALIAS_ON) {
+    topic = "";
+  }
+#endif
+  topic_length = strlen(topic);
+
+  fhdr = MQTT_FHDR_MSG_TYPE_PUBLISH | qos_level << 1;
+  if(retain == MQTT_RETAIN_ON) {
+    fhdr |= MQTT_FHDR_RETAIN_FLAG;
+  }
+  remaining_length = MQTT_STRING_LEN_SIZE + topic_length + payload_size;
+  if(qos_level > MQTT_QOS_LEVEL_0) {
+    remaining_length += MQTT_MID_SIZE;
+  }
+#if MQTT_5
+  remaining_length += prop_list ?
+    (prop_list->properties_len + prop_list->properties_len_enc_bytes) : 1;
+#endif
+  mqtt_encode_var_byte_int(remaining_length_enc, &remaining_length_enc_bytes,
+                           remaining_length);
+  if(remaining_length_enc_bytes > 4) {
+    return MQTT_STATUS_INVALID_ARGS_ERROR;
+  }
+
+  space = MQTT_OUT_RING_SIZE - conn->out_ring_len - out_ring_reserved(conn);
+  if(qos_level == MQTT_QOS_LEVEL_2) {
+    /* for its PUBREL */
+    space -= 4;
+  }
+  if(space < 0 ||
+     MQTT_FHDR_SIZE + remaining_length_enc_bytes + remaining_length > space) {
+    DBG("MQTT - Not accepted, ring full!\n");
+    return MQTT_STATUS_OUT_QUEUE_FULL;
+  }
+  if(qos_level > MQTT_QOS_LEVEL_0) {
+    m = inflight_alloc(conn);
+    if(m == NULL) {
+      DBG("MQTT - Not accepted, too many in flight!\n");
+      return MQTT_STATUS_OUT_QUEUE_FULL;
+    }
+  }
+  DBG("MQTT - Accepted!\n");
+
+  packet_mid = INCREMENT_MID(conn);
+  if(m != NULL) {
+    m->mid = packet_mid;
+    m->state = qos_level == MQTT_QOS_LEVEL_1 ?
+      MQTT_INFLIGHT_WAIT_PUBACK : MQTT_INFLIGHT_WAIT_PUBREC;
+    m->time = clock_time();
+  }
+
+  was_empty = conn->out_ring_len == 0;
+  out_ring_write_byte(conn, fhdr);
+  out_ring_write(conn, remaining_length_enc, remaining_length_enc_bytes);
+  out_ring_write_byte(conn, topic_length >> 8);
+  out_ring_write_byte(conn, topic_length & 0x00FF);
+  out_ring_write(conn, (uint8_t *)topic, topic_length);
+  if(qos_level > MQTT_QOS_LEVEL_0) {
+    out_ring_write_byte(conn, packet_mid >> 8);
+    out_ring_write_byte(conn, packet_mid & 0x00FF);
+  }
+#if MQTT_5
+  if(prop_list) {
+    out_ring_write(conn, prop_list->properties_len_enc,
+                   prop_list->properties_len_enc_bytes);
+    for(prop = list_head(prop_list->props); prop != NULL;
+        prop = list_item_next(prop)) {
+      out_ring_write_byte(conn, prop->id);
+      out_ring_write(conn, prop->val, prop->property_len);
+    }
+  } else {
+    out_ring_write_byte(conn, 0);
+  }
+#endif
+  out_ring_write(conn, payload, payload_size);
+
+  if(mid) {
+    *mid = packet_mid;
+  }
+
+  /* Otherwise, the ring is already being written or will be once TCP is
+     done sending */
+  if(was_empty) {
+    process_post(&mqtt_process, mqtt_do_publish_event, conn);
+  }
+  return MQTT_STATUS_OK;
+}
+#endif /* MQTT_OUT_RING_SIZE */
+/*----------------------------------------------------------------------------*/
 mqtt_status_t
 mqtt_publish(struct mqtt_connection *conn, uint16_t *mid, char *topic,
              uint8_t *payload, uint32_t payload_size,
@@ -1993,6 +2395,15 @@ mqtt_publish(struct mqtt_connection *conn, uint16_t *mid, char *topic,
 
   DBG("MQTT - Call to mqtt_publish...\n");
 
+#if MQTT_OUT_RING_SIZE
+  return publish_to_ring(conn, mid, topic, payload, payload_size, qos_level,
+#if MQTT_5
+                         retain, topic_alias_en, prop_list);
+#else
+                         retain);
+#endif
+#else /* MQTT_OUT_RING_SIZE */
+
   /* Currently don't have a queue, so only one item at a time */
   if(conn->out_queue_full) {
     DBG("MQTT - Not accepted!\n");
@@ -2035,6 +2446,7 @@ mqtt_publish(struct mqtt_connection *conn, uint16_t *mid, char *topic,
 
   process_post(&mqtt_process, mqtt_do_publish_event, conn);
   return MQTT_STATUS_OK;
+#endif /* MQTT_OUT_RING_SIZE */
 }
 /*----------------------------------------------------------------------------*/
 void
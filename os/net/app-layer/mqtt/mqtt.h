@@ -127,6 +127,38 @@
 
 #define MQTT_INPUT_BUFF_SIZE 512
 #define MQTT_MAX_TOPIC_LENGTH 64
+
+/*
+ * Size in bytes of the outbound ring. mqtt_publish() serializes each PUBLISH
+ * into the ring, so that several messages can be queued while TCP is sending
+ * and written back to back without waiting for their acknowledgements.
+ * With 0, only one PUBLISH at a time is accepted and its PUBACK is awaited
+ * before the next one.
+ */
+#ifdef MQTT_CONF_OUT_RING_SIZE
+#define MQTT_OUT_RING_SIZE MQTT_CONF_OUT_RING_SIZE
+#else
+#define MQTT_OUT_RING_SIZE 0
+#endif
+
+/* Maximum number of QoS 1 and 2 PUBLISH messages in flight with the ring */
+#ifdef MQTT_CONF_MAX_INFLIGHT
+#define MQTT_MAX_INFLIGHT MQTT_CONF_MAX_INFLIGHT
+#else
+#define MQTT_MAX_INFLIGHT 4
+#endif
+
+/*
+ * Deliver incoming PUBLISH payloads straight from the TCP input buffer.
+ * Each received segment is handed to the application as one chunk as soon
+ * as it arrives, instead of being collected in the MQTT_INPUT_BUFF_SIZE
+ * packet buffer first. Chunks are only valid during the event callback.
+ */
+#ifdef MQTT_CONF_STREAM_PUBLISH
+#define MQTT_STREAM_PUBLISH MQTT_CONF_STREAM_PUBLISH
+#else
+#define MQTT_STREAM_PUBLISH 0
+#endif
 #define MQTT_MAX_TOPICS_PER_SUBSCRIBE 1
 
 #define MQTT_FHDR_SIZE 1
@@ -486,6 +518,22 @@ struct mqtt_out_packet {
 #endif
 };
 /*---------------------------------------------------------------------------*/
+#if MQTT_OUT_RING_SIZE
+typedef enum {
+  MQTT_INFLIGHT_FREE,
+  MQTT_INFLIGHT_WAIT_PUBACK,
+  MQTT_INFLIGHT_WAIT_PUBREC,
+  MQTT_INFLIGHT_WAIT_PUBCOMP,
+} mqtt_inflight_state_t;
+
+/* A QoS 1 or 2 PUBLISH waiting for the broker to acknowledge it. */
+struct mqtt_inflight {
+  uint16_t mid;
+  uint8_t state;
+  clock_time_t time;
+};
+#endif
+/*---------------------------------------------------------------------------*/
 /**
  * \brief           MQTT event callback function
  * \param m         A pointer to a MQTT connection
@@ -549,6 +597,12 @@ struct mqtt_connection {
   uint8_t out_buffer[MQTT_TCP_OUTPUT_BUFF_SIZE];
   uint8_t out_buffer_sent;
   struct mqtt_out_packet out_packet;
+#if MQTT_OUT_RING_SIZE
+  uint8_t out_ring[MQTT_OUT_RING_SIZE];
+  uint16_t out_ring_head;
+  uint16_t out_ring_len;
+  struct mqtt_inflight inflight[MQTT_MAX_INFLIGHT];
+#endif
   struct pt out_proto_thread;
   uint32_t out_write_pos;
   uint16_t max_segment_size;
@@ -698,6 +752,12 @@ mqtt_status_t mqtt_unsubscribe(struct mqtt_connection *conn,
  * \return MQTT_STATUS_OK or some error status
  *
  * This function publishes to a topic on a MQTT broker.
+ *
+ * With MQTT_OUT_RING_SIZE, the message is copied into the outbound ring and
+ * topic and payload can be reused as soon as this function returns.
+ * MQTT_STATUS_OUT_QUEUE_FULL is returned when the ring has no room for it or,
+ * for QoS 1 and 2, when MQTT_MAX_INFLIGHT messages are unacknowledged.
+ * Completion of a QoS 2 message is reported as MQTT_EVENT_PUBACK.
  */
 mqtt_status_t mqtt_publish(struct mqtt_connection *conn,
                            uint16_t *mid,
@@ -55,6 +55,14 @@ snmp_api_set_string(snmp_varbind_t *varbind, snmp_oid_t *oid, char *string)
 }
 /*---------------------------------------------------------------------------*/
 void
+snmp_api_set_integer(snmp_varbind_t *varbind, snmp_oid_t *oid, int32_t integer)
+{
+  memcpy(&varbind->oid, oid, sizeof(snmp_oid_t));
+  varbind->value_type = BER_DATA_TYPE_INTEGER;
+  varbind->value.integer = (uint32_t)integer;
+}
+/*---------------------------------------------------------------------------*/
+void
 snmp_api_set_time_ticks(snmp_varbind_t *varbind, snmp_oid_t *oid, uint32_t integer)
 {
   memcpy(&varbind->oid, oid, sizeof(snmp_oid_t));
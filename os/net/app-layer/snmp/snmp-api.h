@@ -111,6 +111,18 @@ typedef struct snmp_mib_resource_s snmp_mib_resource_t;
 void
 snmp_api_set_string(snmp_varbind_t *varbind, snmp_oid_t *oid, char *string);
 
+/**
+ * @brief Function to set a varbind with an integer
+ *
+ * This function should be used inside a handler to set the varbind correctly
+ *
+ * @param varbind The varbind from the handler
+ * @param oid The oid from the handler
+ * @param integer The integer value
+ */
+void
+snmp_api_set_integer(snmp_varbind_t *varbind, snmp_oid_t *oid, int32_t integer);
+
 /**
  * @brief Function to set a varbind with a time tick
  *
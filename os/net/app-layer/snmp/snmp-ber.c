@@ -50,6 +50,13 @@ static inline int
 snmp_ber_encode_unsigned_integer(snmp_packet_t *snmp_packet, uint8_t type, uint32_t number)
 {
   uint16_t original_out_len;
+  uint8_t negative;
+
+  /*
+   * BER integers are two's complement. An INTEGER is taken to be an
+   * int32_t, all other types are unsigned.
+   */
+  negative = type == BER_DATA_TYPE_INTEGER && (number & 0x80000000);
 
   original_out_len = snmp_packet->used;
   do {
@@ -66,7 +73,22 @@ snmp_ber_encode_unsigned_integer(snmp_packet_t *snmp_packet, uint8_t type, uint3
 #else /* __MSPGCC__ */
     number >>= 8;
 #endif /* __MSPGCC__ */
-  } while(number);
+    if(negative) {
+      number |= 0xFF000000;
+    }
+  } while(negative ?
+          (number != 0xFFFFFFFF || (*(snmp_packet->out + 1) & 0x80) == 0) :
+          number != 0);
+
+  /* Keep positive values with the top bit set positive */
+  if(!negative && (*(snmp_packet->out + 1) & 0x80)) {
+    if(snmp_packet->used == snmp_packet->max) {
+      return 0;
+    }
+
+    *snmp_packet->out-- = 0x00;
+    snmp_packet->used++;
+  }
 
   if(!snmp_ber_encode_length(snmp_packet, snmp_packet->used - original_out_len)) {
     return 0;
@@ -305,6 +327,11 @@ snmp_ber_decode_unsigned_integer(snmp_packet_t *snmp_packet, uint8_t expected_ty
   *num = (uint32_t)(*snmp_packet->in++ & 0xFF);
   snmp_packet->used--;
 
+  /* An INTEGER is signed: sign-extend it to 32 bits */
+  if(expected_type == BER_DATA_TYPE_INTEGER && (*num & 0x80)) {
+    *num |= 0xFFFFFF00;
+  }
+
   for(i = 1; i < len; ++i) {
     *num <<= 8;
     if(snmp_packet->used == 0) {
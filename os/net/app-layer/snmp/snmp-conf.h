@@ -105,6 +105,36 @@
 #error "SNMP_CONF_MAX_PACKET_SIZE is obsolete. Use UIP_CONF_BUFFER_SIZE"
 #endif /* SNMP_CONF_MAX_PACKET_SIZE */
 
+#ifdef SNMP_CONF_MIB_INDEX_SIZE
+/**
+ * \brief Configurable number of MIB resources kept in the sorted index
+ *
+ * GET and GETNEXT binary search the index instead of scanning the MIB list.
+ * If more resources are added than fit, the list is scanned instead.
+ */
+#define SNMP_MIB_INDEX_SIZE SNMP_CONF_MIB_INDEX_SIZE
+#else
+/**
+ * \brief Default number of MIB resources kept in the sorted index
+ */
+#define SNMP_MIB_INDEX_SIZE 0
+#endif
+
+#ifdef SNMP_CONF_TSCH_MIB
+/**
+ * \brief Configurable registration of the TSCH monitoring MIB
+ *
+ * Exposes the TSCH, MSF and 6P counters of tsch-monitor.h under
+ * SNMP_TSCH_MIB_OID (1.3.6.1.4.1.54352.1.1), one scalar per counter.
+ */
+#define SNMP_TSCH_MIB SNMP_CONF_TSCH_MIB
+#else
+/**
+ * \brief Default registration of the TSCH monitoring MIB
+ */
+#define SNMP_TSCH_MIB 0
+#endif
+
 #ifdef SNMP_CONF_PORT
 /**
  * \brief Configurable SNMP port
@@ -123,6 +123,7 @@ snmp_engine_get_bulk(snmp_header_t *header, snmp_varbind_t *varbinds)
 {
   snmp_mib_resource_t *resource;
   snmp_oid_t oids[SNMP_MAX_NR_VALUES];
+  snmp_mib_resource_t *last[SNMP_MAX_NR_VALUES];
   uint32_t j, original_varbinds_length;
   uint8_t repeater;
   uint8_t i, varbinds_length;
@@ -171,10 +172,19 @@ snmp_engine_get_bulk(snmp_header_t *header, snmp_varbind_t *varbinds)
     }
   }
 
+  /*
+   * Only the first repetition searches the MIB, the following ones walk
+   * from the resource returned by the previous repetition
+   */
+  memset(last, 0, sizeof(last));
   for(i = 0; i < header->max_repetitions; i++) {
     repeater = 0;
     for(j = header->non_repeaters; j < original_varbinds_length; j++) {
-      resource = snmp_mib_find_next(&oids[j]);
+      if(last[j]) {
+        resource = snmp_mib_next(last[j]);
+      } else {
+        resource = snmp_mib_find_next(&oids[j]);
+      }
       if(!resource) {
         switch(header->version) {
         case SNMP_VERSION_1:
@@ -187,7 +197,8 @@ snmp_engine_get_bulk(snmp_header_t *header, snmp_varbind_t *varbinds)
         case SNMP_VERSION_2C:
           if(varbinds_length < SNMP_MAX_NR_VALUES) {
             (&varbinds[varbinds_length])->value_type = BER_DATA_TYPE_END_OF_MIB_VIEW;
-            memcpy(&varbinds[varbinds_length].oid, &oids[j], sizeof(snmp_oid_t));
+            memcpy(&varbinds[varbinds_length].oid,
+                   last[j] ? &last[j]->oid : &oids[j], sizeof(snmp_oid_t));
             (varbinds_length)++;
           } else {
             return -1;
@@ -201,7 +212,7 @@ snmp_engine_get_bulk(snmp_header_t *header, snmp_varbind_t *varbinds)
         if(varbinds_length < SNMP_MAX_NR_VALUES) {
           resource->handler(&varbinds[varbinds_length], &resource->oid);
           (varbinds_length)++;
-          memcpy(&oids[j], &resource->oid, sizeof(snmp_oid_t));
+          last[j] = resource;
           repeater++;
         } else {
           return -1;
@@ -262,6 +262,14 @@ snmp_message_decode(snmp_packet_t *snmp_packet, snmp_header_t *header, snmp_varb
       LOG_DBG("Could not decode max repetition\n");
       return 0;
     }
+
+    /* RFC 3416: negative values are taken to be zero */
+    if((int32_t)header->non_repeaters < 0) {
+      header->non_repeaters = 0;
+    }
+    if((int32_t)header->max_repetitions < 0) {
+      header->max_repetitions = 0;
+    }
     break;
   default:
     if(!snmp_ber_decode_integer(snmp_packet, &header->error_status)) {
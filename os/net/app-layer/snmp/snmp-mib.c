@@ -42,11 +42,23 @@
 #include "snmp-mib.h"
 #include "lib/list.h"
 
+#include <string.h>
+
 #define LOG_MODULE "SNMP [mib]"
 #define LOG_LEVEL LOG_LEVEL_SNMP
 
 LIST(snmp_mib);
 
+#if SNMP_MIB_INDEX_SIZE
+/*
+ * The resources in OID order, for binary search. Left unused if the MIB
+ * outgrows it, in which case the list is scanned.
+ */
+static snmp_mib_resource_t *mib_index[SNMP_MIB_INDEX_SIZE];
+static uint16_t mib_index_len;
+static uint8_t mib_index_overflow;
+#endif
+
 /*---------------------------------------------------------------------------*/
 /**
  * @brief Compares to oids
@@ -84,12 +96,56 @@ snmp_mib_cmp_oid(snmp_oid_t *oid1, snmp_oid_t *oid2)
 
   return 0;
 }
+#if SNMP_MIB_INDEX_SIZE
+/*---------------------------------------------------------------------------*/
+/**
+ * @brief Finds the position of the first indexed resource not below an OID
+ *
+ * @param oid The OID
+ * @param upper Skip a resource equal to the OID as well
+ *
+ * @return The position in the index, mib_index_len if there is none
+ */
+static uint16_t
+snmp_mib_index_search(snmp_oid_t *oid, uint8_t upper)
+{
+  uint16_t low, high, mid;
+  int cmp;
+
+  low = 0;
+  high = mib_index_len;
+  while(low < high) {
+    mid = low + (high - low) / 2;
+    cmp = snmp_mib_cmp_oid(&mib_index[mid]->oid, oid);
+    if(cmp < 0 || (upper && cmp == 0)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  return low;
+}
+#endif
 /*---------------------------------------------------------------------------*/
 snmp_mib_resource_t *
 snmp_mib_find(snmp_oid_t *oid)
 {
   snmp_mib_resource_t *resource;
 
+#if SNMP_MIB_INDEX_SIZE
+  uint16_t pos;
+
+  if(!mib_index_overflow) {
+    pos = snmp_mib_index_search(oid, 0);
+    if(pos < mib_index_len &&
+       !snmp_mib_cmp_oid(oid, &mib_index[pos]->oid)) {
+      return mib_index[pos];
+    }
+    return NULL;
+  }
+#endif
+
   resource = NULL;
   for(resource = list_head(snmp_mib);
       resource; resource = resource->next) {
@@ -107,6 +163,15 @@ snmp_mib_find_next(snmp_oid_t *oid)
 {
   snmp_mib_resource_t *resource;
 
+#if SNMP_MIB_INDEX_SIZE
+  uint16_t pos;
+
+  if(!mib_index_overflow) {
+    pos = snmp_mib_index_search(oid, 1);
+    return pos < mib_index_len ? mib_index[pos] : NULL;
+  }
+#endif
+
   resource = NULL;
   for(resource = list_head(snmp_mib);
       resource; resource = resource->next) {
@@ -119,23 +184,47 @@ snmp_mib_find_next(snmp_oid_t *oid)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+snmp_mib_resource_t *
+snmp_mib_next(snmp_mib_resource_t *resource)
+{
+  /* The list is kept in OID order */
+  return list_item_next(resource);
+}
+/*---------------------------------------------------------------------------*/
 void
 snmp_mib_add(snmp_mib_resource_t *new_resource)
 {
-  snmp_mib_resource_t *resource;
+  snmp_mib_resource_t *resource, *previous;
   uint8_t i;
+#if SNMP_MIB_INDEX_SIZE
+  uint16_t pos;
+
+  if(mib_index_len < SNMP_MIB_INDEX_SIZE) {
+    pos = snmp_mib_index_search(&new_resource->oid, 1);
+    memmove(&mib_index[pos + 1], &mib_index[pos],
+            (mib_index_len - pos) * sizeof(mib_index[0]));
+    mib_index[pos] = new_resource;
+    mib_index_len++;
+  } else if(!mib_index_overflow) {
+    LOG_WARN("MIB index full, falling back to list scan\n");
+    mib_index_overflow = 1;
+  }
+#endif
 
+  /* Insert after the last resource that does not come after the new one */
+  previous = NULL;
   for(resource = list_head(snmp_mib);
       resource; resource = resource->next) {
 
     if(snmp_mib_cmp_oid(&resource->oid, &new_resource->oid) > 0) {
       break;
     }
+    previous = resource;
   }
-  if(resource == NULL) {
-    list_add(snmp_mib, new_resource);
+  if(previous == NULL) {
+    list_push(snmp_mib, new_resource);
   } else {
-    list_insert(snmp_mib, new_resource, resource);
+    list_insert(snmp_mib, previous, new_resource);
   }
 
   if(LOG_DBG_ENABLED) {
@@ -164,4 +253,8 @@ void
 snmp_mib_init(void)
 {
   list_init(snmp_mib);
+#if SNMP_MIB_INDEX_SIZE
+  mib_index_len = 0;
+  mib_index_overflow = 0;
+#endif
 }
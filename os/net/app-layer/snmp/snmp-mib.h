@@ -109,6 +109,16 @@ snmp_mib_find(snmp_oid_t *oid);
 snmp_mib_resource_t *
 snmp_mib_find_next(snmp_oid_t *oid);
 
+/**
+ * @brief Returns the MIB Resource that follows a resource
+ *
+ * @param resource A resource in the MIB
+ *
+ * @return The next resource in OID order or NULL at the end of the MIB
+ */
+snmp_mib_resource_t *
+snmp_mib_next(snmp_mib_resource_t *resource);
+
 /**
  * @brief Adds a resource into the linked list
  *
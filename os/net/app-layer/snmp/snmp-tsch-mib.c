@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2026, agent <agent@local>.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*---------------------------------------------------------------------------*/
+
+/**
+ * \file
+ *      SNMP MIB for TSCH, MSF and 6P monitoring
+ */
+
+#include "contiki.h"
+
+#include "snmp-tsch-mib.h"
+#include "snmp-api.h"
+
+#if SNMP_TSCH_MIB && MAC_CONF_WITH_TSCH
+
+#include "net/mac/tsch/tsch-monitor.h"
+
+#include <string.h>
+
+static snmp_mib_resource_t tsch_mib[TSCH_MONITOR_COUNT];
+/*---------------------------------------------------------------------------*/
+static void
+tsch_mib_handler(snmp_varbind_t *varbind, snmp_oid_t *oid)
+{
+  /* The counter is numbered by the arc before the trailing .0 */
+  snmp_api_set_integer(varbind, oid,
+                       tsch_monitor_get(oid->data[oid->length - 2] - 1));
+}
+/*---------------------------------------------------------------------------*/
+void
+snmp_tsch_mib_init(void)
+{
+  static const uint32_t prefix[] = { SNMP_TSCH_MIB_OID };
+  uint8_t i, len;
+
+  len = sizeof(prefix) / sizeof(prefix[0]);
+  for(i = 0; i < TSCH_MONITOR_COUNT; i++) {
+    memcpy(tsch_mib[i].oid.data, prefix, sizeof(prefix));
+    tsch_mib[i].oid.data[len] = i + 1;
+    tsch_mib[i].oid.data[len + 1] = 0;
+    tsch_mib[i].oid.length = len + 2;
+    tsch_mib[i].handler = tsch_mib_handler;
+    snmp_mib_add(&tsch_mib[i]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+#else /* SNMP_TSCH_MIB && MAC_CONF_WITH_TSCH */
+void
+snmp_tsch_mib_init(void)
+{
+}
+#endif /* SNMP_TSCH_MIB && MAC_CONF_WITH_TSCH */
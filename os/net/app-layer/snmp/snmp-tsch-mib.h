@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026, agent <agent@local>.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*---------------------------------------------------------------------------*/
+
+/**
+ * \file
+ *      SNMP MIB for TSCH, MSF and 6P monitoring
+ */
+
+/**
+ * \addtogroup snmp
+ * @{
+ */
+
+#ifndef SNMP_TSCH_MIB_H_
+#define SNMP_TSCH_MIB_H_
+
+#include "snmp.h"
+
+/**
+ * \addtogroup SNMPTSCHMIB SNMP TSCH MIB
+ * @{
+ *
+ * Scalars SNMP_TSCH_MIB_OID.n.0, where n - 1 is the tsch_monitor_counter_t
+ * of the counter. Values are read from the live structures on each request.
+ */
+
+/**
+ * @brief The OID of the TSCH monitoring subtree
+ */
+#define SNMP_TSCH_MIB_OID 1, 3, 6, 1, 4, 1, 54352, 1, 1
+
+/**
+ * @brief Adds the TSCH monitoring resources to the MIB
+ */
+void
+snmp_tsch_mib_init(void);
+
+/** @} */
+
+#endif /* SNMP_TSCH_MIB_H_ */
+
+/** @} */
@@ -43,6 +43,7 @@
 #include "snmp.h"
 #include "snmp-mib.h"
 #include "snmp-engine.h"
+#include "snmp-tsch-mib.h"
 
 #define LOG_MODULE "SNMP"
 #define LOG_LEVEL LOG_LEVEL_SNMP
@@ -57,6 +58,9 @@ void
 snmp_init()
 {
   snmp_mib_init();
+#if SNMP_TSCH_MIB
+  snmp_tsch_mib_init();
+#endif
   process_start(&snmp_process, NULL);
 }
 /*---------------------------------------------------------------------------*/
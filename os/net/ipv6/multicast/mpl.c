@@ -152,7 +152,12 @@ typedef struct seed_id_s {
 struct mpl_msg {
   struct mpl_msg *next; /* Next message in the set, or NULL if this is largest */
   struct mpl_seed *seed; /* The seed set this message belongs to */
-  struct trickle_timer tt; /* The trickle timer associated with this msg */
+  /* Trickle state, all messages are serviced by data_timer */
+  clock_time_t i_cur; /* Current interval, MSG_TRICKLE_STOPPED if not running */
+  clock_time_t i_start; /* Start of the current interval */
+  clock_time_t t; /* Transmission point within the current interval */
+  uint8_t c; /* Consistency counter */
+  uint8_t tx_pending; /* t has not been reached in this interval */
   uip_ip6addr_t srcipaddr; /* The original ip this message was sent from */
   uint16_t size; /* Side of the data stored above */
   uint8_t seq; /* The sequence number of the message */
@@ -169,6 +174,26 @@ struct mpl_msg {
  * h: pointer to the message set entry
  */
 #define MSG_SET_CLEAR_USED(h) ((h)->seed = NULL)
+/**
+ * \brief Value of i_cur while the trickle of a message is not running
+ */
+#define MSG_TRICKLE_STOPPED 0
+#if MPL_DATA_MESSAGE_IMIN < 1
+#error MPL_DATA_MESSAGE_IMIN must be at least 1
+#endif
+#if MPL_SEED_HASH_SIZE < 1 || (MPL_SEED_HASH_SIZE & (MPL_SEED_HASH_SIZE - 1)) != 0
+#error MPL_SEED_HASH_SIZE must be a power of two
+#endif
+/**
+ * \brief Check whether the trickle of a message is running
+ * h: pointer to the message set entry
+ */
+#define MSG_TRICKLE_IS_RUNNING(h) ((h)->i_cur != MSG_TRICKLE_STOPPED)
+/**
+ * \brief Stop the trickle of a message. data_timer drops it on its next run.
+ * h: pointer to the message set entry
+ */
+#define MSG_TRICKLE_STOP(h) ((h)->i_cur = MSG_TRICKLE_STOPPED)
 /* RFC 1982 Serial Number Arithmetic */
 /**
  * \brief s1 is said to be equal s2 if SEQ_VAL_IS_EQ(s1, s2) == 1
@@ -202,12 +227,14 @@ struct mpl_msg {
 /*---------------------------------------------------------------------------*/
 /* Seed Set */
 struct mpl_seed {
+  struct mpl_seed *hash_next; /* Next seed in the same seed_hash bucket */
   seed_id_t seed_id;
   uint8_t min_seqno; /* Used when the seed set is empty */
   uint8_t lifetime; /* Decrements by one every minute */
   uint8_t count; /* Only used for determining largest msg set during reclaim */
   LIST_STRUCT(min_seq); /* Pointer to the first msg in this seed's set */
   struct mpl_domain *domain; /* The domain this seed belongs to */
+  uint8_t seqs[32]; /* Bit vector of the sequence numbers in min_seq */
 };
 /**
  * \brief Get the state of the used flag in the buffered message set entry
@@ -399,6 +426,9 @@ static struct mpl_stats stats;
 static struct mpl_msg buffered_message_set[MPL_BUFFERED_MESSAGE_SET_SIZE];
 static struct mpl_seed seed_set[MPL_SEED_SET_SIZE];
 static struct mpl_domain domain_set[MPL_DOMAIN_SET_SIZE];
+LIST(free_messages); /* Unused entries of the buffered message set */
+static struct mpl_seed *seed_hash[MPL_SEED_HASH_SIZE];
+static struct ctimer data_timer; /* Services the trickle of all messages */
 static uint16_t last_seq;
 static seed_id_t local_seed_id;
 #if MPL_SUB_TO_ALL_FORWARDERS
@@ -432,7 +462,12 @@ extern uint16_t uip_slen;
  * \brief Start the trickle timer for a data message
  * t: Pointer to set that should be reset
  */
-#define mpl_data_trickle_timer_start(t) { (t)->e = 0; trickle_timer_set(&(t)->tt, data_message_expiration, (t)); }
+#define mpl_data_trickle_timer_start(t) { (t)->e = 0; msg_trickle_start(t); }
+/**
+ * \brief Reset the trickle timer and expiration count of a data message
+ * t: Pointer to the message
+ */
+#define mpl_data_trickle_timer_inconsistency(t) { (t)->e = 0; msg_trickle_inconsistency(t); }
 /**
  * \brief Call inconsistency on the provided timer
  * t: Pointer to set that should be reset
@@ -449,6 +484,12 @@ extern uint16_t uip_slen;
  * b: The 0-indexed bit to set
  */
 #define BIT_VECTOR_SET_BIT(v, b) (v[b / 8] |= (0x80 >> b % 8))
+/**
+ * \brief Clear a single bit within a bit vector that spans multiple bytes
+ * v: The bit vector
+ * b: The 0-indexed bit to clear
+ */
+#define BIT_VECTOR_CLR_BIT(v, b) (v[b / 8] &= ~(0x80 >> b % 8))
 /**
  * \brief Get the value of a bit in a bit vector
  * v: The bit vector
@@ -464,26 +505,134 @@ extern uint16_t uip_slen;
 /* Local function prototypes */
 /*---------------------------------------------------------------------------*/
 static void icmp_in(void);
+static void data_message_expiration(void *ptr, uint8_t suppress);
+static void data_timer_expiration(void *ptr);
 UIP_ICMP6_HANDLER(mpl_icmp_handler, ICMP6_MPL, 0, icmp_in);
+/*---------------------------------------------------------------------------*/
+/* Data message trickle
+ *  Rather than running one trickle_timer (and so one ctimer) per buffered
+ *  message, every message keeps its own RFC 6206 state and data_timer is
+ *  armed for the earliest event (t or the end of I) across all of them.
+ */
+/*---------------------------------------------------------------------------*/
+static clock_time_t data_i_max_abs; /* Imin << Imax, clamped to the clock width */
 
+static clock_time_t
+msg_trickle_rand(void)
+{
+  return (clock_time_t)((uint32_t)random_rand() << 16 | random_rand());
+}
+/* Random t in [I/2, I). With Imin == 1 the first interval has I/2 == 0. */
+static clock_time_t
+msg_trickle_pick_t(clock_time_t i)
+{
+  return (i >> 1) + ((i >> 1) > 0 ? msg_trickle_rand() % (i >> 1) : 0);
+}
+static void
+msg_trickle_schedule(clock_time_t wait)
+{
+  /* Only ever pull data_timer forward, it re-arms itself when it fires */
+  if(ctimer_expired(&data_timer) || timer_remaining(&data_timer.etimer.timer) > wait) {
+    ctimer_set(&data_timer, wait, data_timer_expiration, NULL);
+  }
+}
+static void
+msg_trickle_new_interval(struct mpl_msg *msg, clock_time_t start)
+{
+  msg->c = 0;
+  msg->i_start = start;
+  msg->t = msg_trickle_pick_t(msg->i_cur);
+  msg->tx_pending = 1;
+  msg_trickle_schedule(msg->t);
+}
+static void
+msg_trickle_start(struct mpl_msg *msg)
+{
+  /* Random I in [Imin, Imax] */
+  msg->i_cur = MPL_DATA_MESSAGE_IMIN +
+    msg_trickle_rand() % (data_i_max_abs - MPL_DATA_MESSAGE_IMIN + 1);
+  msg_trickle_new_interval(msg, clock_time());
+}
+static void
+msg_trickle_inconsistency(struct mpl_msg *msg)
+{
+  if(MSG_TRICKLE_IS_RUNNING(msg) && msg->i_cur != MPL_DATA_MESSAGE_IMIN) {
+    msg->i_cur = MPL_DATA_MESSAGE_IMIN;
+    msg_trickle_new_interval(msg, clock_time());
+  }
+}
+static void
+msg_trickle_consistency(struct mpl_msg *msg)
+{
+  if(MSG_TRICKLE_IS_RUNNING(msg) && msg->c < 0xFF) {
+    msg->c++;
+  }
+}
+static void
+data_timer_expiration(void *ptr)
+{
+  static struct mpl_msg *msg; /* Can't use locmmptr since data_message_expiration uses it */
+  clock_time_t now;
+  clock_time_t elapsed;
+  clock_time_t wait;
+  clock_time_t next;
+  uint8_t running;
+
+  now = clock_time();
+  next = 0;
+  running = 0;
+  for(msg = &buffered_message_set[MPL_BUFFERED_MESSAGE_SET_SIZE - 1]; msg >= buffered_message_set; msg--) {
+    if(!MSG_SET_IS_USED(msg) || !MSG_TRICKLE_IS_RUNNING(msg)) {
+      continue;
+    }
+    elapsed = now - msg->i_start;
+    if(msg->tx_pending && elapsed >= msg->t) {
+      msg->tx_pending = 0;
+      data_message_expiration(msg, MPL_DATA_MESSAGE_K == TRICKLE_TIMER_INFINITE_REDUNDANCY
+                              || msg->c < MPL_DATA_MESSAGE_K ? TRICKLE_TIMER_TX_OK : TRICKLE_TIMER_TX_SUPPRESS);
+      if(!MSG_TRICKLE_IS_RUNNING(msg)) {
+        continue;
+      }
+    }
+    if(!msg->tx_pending && elapsed >= msg->i_cur) {
+      /* End of the interval, double I and start over */
+      elapsed -= msg->i_cur;
+      msg->i_start += msg->i_cur;
+      msg->i_cur = msg->i_cur > (data_i_max_abs >> 1) ? data_i_max_abs : msg->i_cur << 1;
+      msg->c = 0;
+      msg->t = msg_trickle_pick_t(msg->i_cur);
+      msg->tx_pending = 1;
+    }
+    wait = msg->tx_pending ? msg->t : msg->i_cur;
+    wait = elapsed >= wait ? 0 : wait - elapsed;
+    if(!running || wait < next) {
+      next = wait;
+      running = 1;
+    }
+  }
+  if(running) {
+    ctimer_set(&data_timer, next, data_timer_expiration, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
 static struct mpl_msg *
 buffer_allocate(void)
 {
-  for(locmmptr = &buffered_message_set[MPL_BUFFERED_MESSAGE_SET_SIZE - 1]; locmmptr >= buffered_message_set; locmmptr--) {
-    if(!MSG_SET_IS_USED(locmmptr)) {
-      memset(locmmptr, 0, sizeof(struct mpl_msg));
-      return locmmptr;
-    }
+  locmmptr = list_pop(free_messages);
+  if(locmmptr != NULL) {
+    memset(locmmptr, 0, sizeof(struct mpl_msg));
   }
-  return NULL;
+  return locmmptr;
 }
 static void
 buffer_free(struct mpl_msg *msg)
 {
-  if(trickle_timer_is_running(&msg->tt)) {
-    trickle_timer_stop(&msg->tt);
+  MSG_TRICKLE_STOP(msg);
+  if(MSG_SET_IS_USED(msg)) {
+    BIT_VECTOR_CLR_BIT(msg->seed->seqs, msg->seq);
   }
   MSG_SET_CLEAR_USED(msg);
+  list_push(free_messages, msg);
 }
 static struct mpl_msg *
 buffer_reclaim(void)
@@ -495,7 +644,7 @@ buffer_reclaim(void)
   /* Reclaim the message with min_seq in the largest seed set */
   largest = NULL;
   reclaim = NULL;
-  for(ssptr = &seed_set[MPL_SEED_SET_SIZE]; ssptr >= seed_set; ssptr--) {
+  for(ssptr = &seed_set[MPL_SEED_SET_SIZE - 1]; ssptr >= seed_set; ssptr--) {
     if(SEED_SET_IS_USED(ssptr) && (largest == NULL || ssptr->count > largest->count)) {
       largest = ssptr;
     }
@@ -512,7 +661,7 @@ buffer_reclaim(void)
     reclaim = list_pop(largest->min_seq);
     largest->min_seqno = list_item_next(reclaim) == NULL ? reclaim->seq : ((struct mpl_msg *)list_item_next(reclaim))->seq;
     largest->count--;
-    trickle_timer_stop(&reclaim->tt);
+    BIT_VECTOR_CLR_BIT(largest->seqs, reclaim->seq);
     mpl_trickle_timer_reset(reclaim->seed->domain);
     memset(reclaim, 0, sizeof(struct mpl_msg));
   }
@@ -569,17 +718,53 @@ domain_set_allocate(uip_ip6addr_t *address)
   }
   return NULL;
 }
+/* Bucket of the seed hash that a seed id in a domain belongs to */
+static struct mpl_seed **
+seed_hash_bucket(seed_id_t *seed_id, struct mpl_domain *domain)
+{
+  uint8_t i;
+  uint8_t h;
+
+  h = (uint8_t)(domain - domain_set);
+  for(i = 0; i < 16; i++) {
+    h = (h << 3 | h >> 5) ^ seed_id->id[i];
+  }
+  return &seed_hash[h & (MPL_SEED_HASH_SIZE - 1)];
+}
 /* Lookup the seed id in the seed set */
 static struct mpl_seed *
 seed_set_lookup(seed_id_t *seed_id, struct mpl_domain *domain)
 {
-  for(locssptr = &seed_set[MPL_SEED_SET_SIZE - 1]; locssptr >= seed_set; locssptr--) {
-    if(SEED_SET_IS_USED(locssptr) && seed_id_cmp(seed_id, &locssptr->seed_id) && locssptr->domain == domain) {
+  for(locssptr = *seed_hash_bucket(seed_id, domain); locssptr != NULL; locssptr = locssptr->hash_next) {
+    if(locssptr->domain == domain && seed_id_cmp(seed_id, &locssptr->seed_id)) {
       return locssptr;
     }
   }
   return NULL;
 }
+/* Make a newly set up seed visible to seed_set_lookup */
+static void
+seed_hash_add(struct mpl_seed *s)
+{
+  struct mpl_seed **bucket;
+
+  bucket = seed_hash_bucket(&s->seed_id, s->domain);
+  s->hash_next = *bucket;
+  *bucket = s;
+}
+static void
+seed_hash_remove(struct mpl_seed *s)
+{
+  struct mpl_seed **prev;
+
+  for(prev = seed_hash_bucket(&s->seed_id, s->domain); *prev != NULL; prev = &(*prev)->hash_next) {
+    if(*prev == s) {
+      *prev = s->hash_next;
+      break;
+    }
+  }
+  s->hash_next = NULL;
+}
 static struct mpl_seed *
 seed_set_allocate(void)
 {
@@ -598,6 +783,7 @@ seed_set_free(struct mpl_seed *s)
   while((locmmptr = list_pop(s->min_seq)) != NULL) {
     buffer_free(locmmptr);
   }
+  seed_hash_remove(s);
   SEED_SET_CLEAR_USED(s);
 }
 static struct mpl_domain *
@@ -618,7 +804,7 @@ domain_set_free(struct mpl_domain *domain)
 {
   uip_ds6_maddr_t *addr;
   /* Must include freeing seeds otherwise we leak memory */
-  for(locssptr = &seed_set[MPL_SEED_SET_SIZE]; locssptr >= seed_set; locssptr--) {
+  for(locssptr = &seed_set[MPL_SEED_SET_SIZE - 1]; locssptr >= seed_set; locssptr--) {
     if(SEED_SET_IS_USED(locssptr) && locssptr->domain == domain) {
       seed_set_free(locssptr);
     }
@@ -908,7 +1094,7 @@ data_message_expiration(void *ptr, uint8_t suppress)
   locmmptr = ((struct mpl_msg *)ptr);
   if(locmmptr->e > MPL_DATA_MESSAGE_TIMER_EXPIRATIONS) {
     /* Terminate the trickle timer here if we've already expired enough times */
-    trickle_timer_stop(&locmmptr->tt);
+    MSG_TRICKLE_STOP(locmmptr);
     return;
   }
   if(suppress == TRICKLE_TIMER_TX_OK) { /* Only transmit if not suppressed */
@@ -1038,7 +1224,7 @@ lifetime_timer_expiration(void *ptr)
       /* Check no timers are running */
       locmmptr = list_head(locssptr->min_seq);
       while(locmmptr != NULL) {
-        if(trickle_timer_is_running(&locmmptr->tt)) {
+        if(MSG_TRICKLE_IS_RUNNING(locmmptr)) {
           /* We must keep this seed */
           break;
         }
@@ -1171,11 +1357,11 @@ icmp_in(void)
       if(list_head(locssptr->min_seq) != NULL) {
         for(locmmptr = list_head(locssptr->min_seq); locmmptr != NULL; locmmptr = list_item_next(locmmptr)) {
           LOG_DBG("Resetting timer for messages\n");
-          if(!trickle_timer_is_running(&locmmptr->tt)) {
+          if(!MSG_TRICKLE_IS_RUNNING(locmmptr)) {
             LOG_DBG("Starting timer for messages\n");
             mpl_data_trickle_timer_start(locmmptr);
           }
-          mpl_trickle_timer_inconsistency(locmmptr);
+          mpl_data_trickle_timer_inconsistency(locmmptr);
         }
       }
       /* Otherwise we jump here and continute */
@@ -1271,10 +1457,10 @@ seed_present:
           /* Additionally all data message timers in set if r is behind us */
           if(list_head(locssptr->min_seq) != NULL) {
             for(locmmptr = list_head(locssptr->min_seq); locmmptr != NULL; locmmptr = list_item_next(locmmptr)) {
-              if(!trickle_timer_is_running(&locmmptr->tt)) {
+              if(!MSG_TRICKLE_IS_RUNNING(locmmptr)) {
                 mpl_data_trickle_timer_start(locmmptr);
               }
-              mpl_trickle_timer_inconsistency(locmmptr);
+              mpl_data_trickle_timer_inconsistency(locmmptr);
             }
           }
         } else {
@@ -1310,10 +1496,10 @@ seed_present:
         /* Local message is missing from remote set. Reset control and data timers */
         LOG_DBG("Remote is missing seq=%u\n", locmmptr->seq);
         r_missing = 1;
-        if(!trickle_timer_is_running(&locmmptr->tt)) {
+        if(!MSG_TRICKLE_IS_RUNNING(locmmptr)) {
           mpl_data_trickle_timer_start(locmmptr);
         }
-        mpl_trickle_timer_inconsistency(locmmptr);
+        mpl_data_trickle_timer_inconsistency(locmmptr);
       }
 
       /* Now increment our pointers */
@@ -1342,10 +1528,10 @@ seed_present:
        */
       while(locmmptr != NULL) {
         LOG_DBG("Remote is missing all above seq=%u\n", locmmptr->seq);
-        if(!trickle_timer_is_running(&locmmptr->tt)) {
+        if(!MSG_TRICKLE_IS_RUNNING(locmmptr)) {
           mpl_data_trickle_timer_start(locmmptr);
         }
-        mpl_trickle_timer_inconsistency(locmmptr);
+        mpl_data_trickle_timer_inconsistency(locmmptr);
         r_missing = 1;
         locmmptr = list_item_next(locmmptr);
       }
@@ -1509,15 +1695,15 @@ accept(uint8_t in)
       UIP_MCAST6_STATS_ADD(mcast_dropped);
       return UIP_MCAST6_DROP;
     }
-    if(list_head(locssptr->min_seq) != NULL) {
+    if(BIT_VECTOR_GET_BIT(locssptr->seqs, seq_val)) {
       for(locmmptr = list_head(locssptr->min_seq); locmmptr != NULL; locmmptr = list_item_next(locmmptr)) {
         if(SEQ_VAL_IS_EQ(seq_val, locmmptr->seq)) {
           /* Seen before , drop */
           LOG_INFO("Seen before\n");
           if(HBH_GET_M(lochbhmptr) && list_item_next(locmmptr) != NULL) {
-            mpl_trickle_timer_inconsistency(locmmptr);
+            mpl_data_trickle_timer_inconsistency(locmmptr);
           } else {
-            trickle_timer_consistency(&locmmptr->tt);
+            msg_trickle_consistency(locmmptr);
           }
           UIP_MCAST6_STATS_ADD(mcast_dropped);
           return UIP_MCAST6_DROP;
@@ -1541,6 +1727,7 @@ accept(uint8_t in)
     LIST_STRUCT_INIT(locssptr, min_seq);
     seed_id_cpy(&locssptr->seed_id, &seed_id);
     locssptr->domain = locdsptr;
+    seed_hash_add(locssptr);
   }
 
   /* Allocate a buffer */
@@ -1579,14 +1766,7 @@ accept(uint8_t in)
   memcpy(&locmmptr->data, hptr, locmmptr->size);
   locmmptr->seq = seq_val;
   locmmptr->seed = locssptr;
-  if(!trickle_timer_config(&locmmptr->tt,
-                           MPL_DATA_MESSAGE_IMIN,
-                           MPL_DATA_MESSAGE_IMAX,
-                           MPL_DATA_MESSAGE_K)) {
-    LOG_ERR("Failed to configure timer for message. Dropping...\n");
-    buffer_free(locmmptr);
-    return UIP_MCAST6_DROP;
-  }
+  BIT_VECTOR_SET_BIT(locssptr->seqs, seq_val);
 
   /* Place the message into the buffered message linked list */
   if(list_head(locssptr->min_seq) == NULL) {
@@ -1632,10 +1812,10 @@ accept(uint8_t in)
 #if MPL_PROACTIVE_FORWARDING
   if(HBH_GET_M(lochbhmptr) == 1 && list_item_next(locmmptr) != NULL) {
     LOG_DBG("MPL Domain is inconsistent\n");
-    mpl_trickle_timer_inconsistency(locmmptr);
+    mpl_data_trickle_timer_inconsistency(locmmptr);
   } else {
     LOG_DBG("MPL Domain is consistent\n");
-    trickle_timer_consistency(&locmmptr->tt);
+    msg_trickle_consistency(locmmptr);
   }
 #endif
 
@@ -1766,12 +1946,25 @@ in(void)
 static void
 init(void)
 {
+  uint8_t i;
+
   LOG_INFO("Multicast Protocol for Low Power and Lossy Networks - RFC7731\n");
 
   /* Clear out all sets */
   memset(domain_set, 0, sizeof(struct mpl_domain) * MPL_DOMAIN_SET_SIZE);
   memset(seed_set, 0, sizeof(struct mpl_seed) * MPL_SEED_SET_SIZE);
   memset(buffered_message_set, 0, sizeof(struct mpl_msg) * MPL_BUFFERED_MESSAGE_SET_SIZE);
+  memset(seed_hash, 0, sizeof(seed_hash));
+  list_init(free_messages);
+  for(locmmptr = &buffered_message_set[MPL_BUFFERED_MESSAGE_SET_SIZE - 1]; locmmptr >= buffered_message_set; locmmptr--) {
+    list_push(free_messages, locmmptr);
+  }
+
+  /* Work out the largest data message interval the clock can hold */
+  data_i_max_abs = MPL_DATA_MESSAGE_IMIN;
+  for(i = 0; i < MPL_DATA_MESSAGE_IMAX && data_i_max_abs < ((clock_time_t)~0 >> 2); i++) {
+    data_i_max_abs <<= 1;
+  }
 
   /* Register the ICMPv6 input handler */
   uip_icmp6_register_input_handler(&mpl_icmp_handler);
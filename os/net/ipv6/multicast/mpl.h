@@ -90,7 +90,7 @@
 #ifndef MPL_CONF_DATA_MESSAGE_K
 #define MPL_DATA_MESSAGE_K                  1
 #else
-#define MPL_CONF_DATA_MESSAGE_K MPL_DATA_MESSAGE_K
+#define MPL_DATA_MESSAGE_K MPL_CONF_DATA_MESSAGE_K
 #endif
 
 #ifndef MPL_CONF_CONTROL_MESSAGE_IMIN
@@ -203,6 +203,18 @@
 #define MPL_SEED_SET_SIZE MPL_CONF_SEED_SET_SIZE
 #endif
 /*---------------------------------------------------------------------------*/
+/**
+ * Seed Hash Size
+ * Seeds are looked up by (seed id, domain) through a hash table with this
+ * many buckets rather than by scanning the whole Seed Set. Must be a power
+ * of two.
+ */
+#ifndef MPL_CONF_SEED_HASH_SIZE
+#define MPL_SEED_HASH_SIZE                  8
+#else
+#define MPL_SEED_HASH_SIZE MPL_CONF_SEED_HASH_SIZE
+#endif
+/*---------------------------------------------------------------------------*/
 /**
  * Buffered Message Set Size
  * MPL Forwarders maintain a buffer of data messages that are periodically
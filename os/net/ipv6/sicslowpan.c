@@ -603,6 +603,102 @@ compress_addr_64(uint8_t bitpos, uip_ipaddr_t *ipaddr, uip_lladdr_t *lladdr)
   }
 }
 
+#if SICSLOWPAN_IPHC_FLOW_CACHE > 0
+/*--------------------------------------------------------------------*/
+/* IPHC + LOWPAN_UDP header of a flow, without its UDP checksum:
+ * IPHC (2) + CID (1) + TF (4) + HLIM (1) + addresses (32) + NHC (1) +
+ * ports (4) */
+#define IPHC_FLOW_HDR_MAX 45
+
+/** \brief The compressed header of a UDP flow sent recently */
+struct iphc_flow {
+  uint8_t tf[4];       /* version, traffic class and flow label */
+  uint8_t nh_hl_addr[34]; /* next header, hop limit and both addresses */
+  uint8_t ports[4];
+  linkaddr_t link_destaddr;
+  uint8_t hdr_len;
+  uint8_t hdr[IPHC_FLOW_HDR_MAX];
+};
+
+static struct iphc_flow iphc_flows[SICSLOWPAN_IPHC_FLOW_CACHE];
+static uint8_t iphc_flows_used;
+static uint8_t iphc_flow_next;
+/*--------------------------------------------------------------------*/
+/* Does the IPv6/UDP packet in uip_buf belong to this flow? All the
+   fields the IPHC encoding depends on, except the UDP checksum, must be
+   the same. */
+static int
+iphc_flow_match(const struct iphc_flow *f, const linkaddr_t *link_destaddr)
+{
+  return memcmp(f->nh_hl_addr, &UIP_IP_BUF->proto, sizeof(f->nh_hl_addr)) == 0 &&
+    memcmp(f->ports, &UIP_UDP_BUF->srcport, sizeof(f->ports)) == 0 &&
+    memcmp(f->tf, &UIP_IP_BUF->vtc, sizeof(f->tf)) == 0 &&
+    linkaddr_cmp(&f->link_destaddr, link_destaddr);
+}
+/*--------------------------------------------------------------------*/
+/* Compress the packet in uip_buf from the flow cache, if it holds its
+   flow. Returns 1 if the header was written to packetbuf. */
+static int
+iphc_flow_compress(const linkaddr_t *link_destaddr)
+{
+  const struct iphc_flow *f;
+  uint8_t i;
+
+  if(UIP_IP_BUF->proto != UIP_PROTO_UDP) {
+    return 0;
+  }
+
+  for(i = 0; i < iphc_flows_used; i++) {
+    f = &iphc_flows[i];
+    if(iphc_flow_match(f, link_destaddr)) {
+      hc06_ptr = PACKETBUF_IPHC_BUF;
+      if(hc06_ptr + f->hdr_len + 2 >= PACKETBUF_PAYLOAD_END) {
+        return 0;
+      }
+      memcpy(hc06_ptr, f->hdr, f->hdr_len);
+      hc06_ptr += f->hdr_len;
+      /* always inline the checksum  */
+      memcpy(hc06_ptr, &UIP_UDP_BUF->udpchksum, 2);
+      hc06_ptr += 2;
+      uncomp_hdr_len = UIP_IPH_LEN + UIP_UDPH_LEN;
+      packetbuf_hdr_len = hc06_ptr - packetbuf_ptr;
+      LOG_DBG("compression: flow cache hit (%u bytes)\n", f->hdr_len + 2);
+      return 1;
+    }
+  }
+  return 0;
+}
+/*--------------------------------------------------------------------*/
+/* Remember the header just compressed to PACKETBUF_IPHC_BUF, up to
+   hc06_ptr, if the packet is a plain IPv6/UDP one. */
+static void
+iphc_flow_add(const linkaddr_t *link_destaddr)
+{
+  struct iphc_flow *f;
+  int hdr_len;
+
+  hdr_len = hc06_ptr - PACKETBUF_IPHC_BUF - 2; /* without the checksum */
+  if(UIP_IP_BUF->proto != UIP_PROTO_UDP ||
+     hdr_len <= 0 || hdr_len > IPHC_FLOW_HDR_MAX) {
+    return;
+  }
+
+  /* Replace the flows in a round-robin fashion */
+  f = &iphc_flows[iphc_flow_next];
+  iphc_flow_next = (iphc_flow_next + 1) % SICSLOWPAN_IPHC_FLOW_CACHE;
+  if(iphc_flows_used < SICSLOWPAN_IPHC_FLOW_CACHE) {
+    iphc_flows_used++;
+  }
+
+  memcpy(f->tf, &UIP_IP_BUF->vtc, sizeof(f->tf));
+  memcpy(f->nh_hl_addr, &UIP_IP_BUF->proto, sizeof(f->nh_hl_addr));
+  memcpy(f->ports, &UIP_UDP_BUF->srcport, sizeof(f->ports));
+  linkaddr_copy(&f->link_destaddr, link_destaddr);
+  f->hdr_len = hdr_len;
+  memcpy(f->hdr, PACKETBUF_IPHC_BUF, hdr_len);
+}
+#endif /* SICSLOWPAN_IPHC_FLOW_CACHE > 0 */
+
 /*-------------------------------------------------------------------- */
 /* Uncompress addresses based on a prefix and a postfix with zeroes in
  * between. If the postfix is zero in length it will use the link address
@@ -715,6 +811,12 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
    * layer will be checked when they are compressed. */
   CHECK_BUFFER_SPACE(38);
 
+#if SICSLOWPAN_IPHC_FLOW_CACHE > 0
+  if(iphc_flow_compress(link_destaddr)) {
+    return 1;
+  }
+#endif /* SICSLOWPAN_IPHC_FLOW_CACHE > 0 */
+
   /*
    * As we copy some bit-length fields, in the IPHC encoding bytes,
    * we sometimes use |=
@@ -1035,6 +1137,10 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
   PACKETBUF_IPHC_BUF[0] = iphc0;
   PACKETBUF_IPHC_BUF[1] = iphc1;
 
+#if SICSLOWPAN_IPHC_FLOW_CACHE > 0
+  iphc_flow_add(link_destaddr);
+#endif /* SICSLOWPAN_IPHC_FLOW_CACHE > 0 */
+
   if(LOG_DBG_ENABLED) {
     uint16_t ndx;
     LOG_DBG("compression: after (%d): ", (int)(hc06_ptr - packetbuf_ptr));
@@ -1839,6 +1945,222 @@ output(const linkaddr_t *localdest)
   return 1;
 }
 
+#if SICSLOWPAN_FAST_FORWARD && UIP_CONF_ROUTER
+/*--------------------------------------------------------------------*/
+/** \name Fast forwarding of IPHC packets
+ * @{                                                                 */
+/*--------------------------------------------------------------------*/
+/* Number of inline address bytes for each SAM/DAM mode (unicast) */
+static const uint8_t ff_addr_inline_len[] = {16, 8, 2, 0};
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Check that a compressed unicast address can be forwarded as is
+ * \param ctx Non-zero if the address is context based (SAC/DAC)
+ * \param mode The address mode (SAM/DAM)
+ *
+ * Addresses elided from the link-layer addresses would decode
+ * differently on the next hop, and link-local addresses are never
+ * forwarded.
+ */
+static int
+ff_addr_is_portable(uint8_t ctx, uint8_t mode)
+{
+  if(mode == 0) {
+    /* Full address inline, or unspecified if context based */
+    return !ctx;
+  }
+  return ctx && mode != 3;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Try to forward the packet in packetbuf without going through
+ * uip_buf.
+ *
+ * Called by input() once the IPHC header of a non-fragmented packet has
+ * been uncompressed to uip_buf, before the payload is copied. When the
+ * packet is routed through us, the hop limit and the hop-by-hop options
+ * are updated in the compressed frame, and packetbuf is handed back to
+ * the MAC layer as is. Anything else (packets for us, link-layer derived
+ * addresses, routing headers, unresolved next hops, ...) is left to the
+ * regular uip6 input and output path.
+ *
+ * \return 1 if the packet was consumed (forwarded or dropped), 0 if
+ * input() should go on with the regular path
+ */
+static int
+fast_forward(void)
+{
+  uint8_t iphc0, iphc1;
+  uint8_t *ttl_ptr;
+  uint8_t *nhc_ptr;
+  uint8_t *hbh_ptr = NULL;
+  uint8_t hbh_len = 0;
+  uint8_t proto;
+  struct uip_ext_hdr *ext_hdr = NULL;
+  const uip_lladdr_t *nexthop_lladdr;
+  linkaddr_t dest;
+  int mac_max_payload;
+#if LLSEC802154_USES_AUX_HEADER
+  packetbuf_attr_t security_level;
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  packetbuf_attr_t key_index;
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+
+  /* The sniffer expects every packet to go through uip_buf */
+  if(callback != NULL || curr_page != 0) {
+    return 0;
+  }
+
+  iphc0 = PACKETBUF_IPHC_BUF[0];
+  iphc1 = PACKETBUF_IPHC_BUF[1];
+
+  /* The hop limit must be inline so that it can be decremented in
+     place, and the destination must be unicast */
+  if((iphc0 & 0x03) != SICSLOWPAN_IPHC_TTL_I || (iphc1 & SICSLOWPAN_IPHC_M)) {
+    return 0;
+  }
+  if(!ff_addr_is_portable(iphc1 & SICSLOWPAN_IPHC_SAC,
+                          (iphc1 & SICSLOWPAN_IPHC_SAM_11) >> SICSLOWPAN_IPHC_SAM_BIT) ||
+     !ff_addr_is_portable(iphc1 & SICSLOWPAN_IPHC_DAC,
+                          (iphc1 & SICSLOWPAN_IPHC_DAM_11) >> SICSLOWPAN_IPHC_DAM_BIT)) {
+    return 0;
+  }
+
+  /* Same conditions as the forwarding logic of uip6.c */
+  if(uip_ds6_is_my_addr(&UIP_IP_BUF->destipaddr) ||
+     uip_ds6_is_my_addr(&UIP_IP_BUF->srcipaddr) ||
+     uip_is_addr_mcast(&UIP_IP_BUF->srcipaddr) ||
+     uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr) ||
+     uip_is_addr_linklocal(&UIP_IP_BUF->srcipaddr) ||
+     uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr) ||
+     uip_is_addr_loopback(&UIP_IP_BUF->destipaddr)) {
+    return 0;
+  }
+  /* Let uip6 send the ICMPv6 time exceeded error */
+  if(UIP_IP_BUF->ttl <= 1) {
+    return 0;
+  }
+  /* The root inserts its own extension headers */
+  if(NETSTACK_ROUTING.node_is_root()) {
+    return 0;
+  }
+
+  /* Locate the hop limit and the first NHC in the compressed header */
+  ttl_ptr = PACKETBUF_IPHC_BUF + 2;
+  if(iphc1 & SICSLOWPAN_IPHC_CID) {
+    ttl_ptr++;
+  }
+  switch(iphc0 & (SICSLOWPAN_IPHC_FL_C | SICSLOWPAN_IPHC_TC_C)) {
+  case 0:
+    ttl_ptr += 4;
+    break;
+  case SICSLOWPAN_IPHC_TC_C:
+    ttl_ptr += 3;
+    break;
+  case SICSLOWPAN_IPHC_FL_C:
+    ttl_ptr += 1;
+    break;
+  }
+  if((iphc0 & SICSLOWPAN_IPHC_NH_C) == 0) {
+    ttl_ptr++;
+  }
+  nhc_ptr = ttl_ptr + 1 +
+    ff_addr_inline_len[(iphc1 & SICSLOWPAN_IPHC_SAM_11) >> SICSLOWPAN_IPHC_SAM_BIT] +
+    ff_addr_inline_len[(iphc1 & SICSLOWPAN_IPHC_DAM_11) >> SICSLOWPAN_IPHC_DAM_BIT];
+
+  /* The only extension header we handle is a compressed hop-by-hop
+     header carrying nothing but the RPL option, whose bytes are
+     carried verbatim after the NHC, next header and length bytes */
+  proto = UIP_IP_BUF->proto;
+  if(proto == UIP_PROTO_HBHO) {
+    ext_hdr = (struct uip_ext_hdr *)UIP_IP_PAYLOAD(0);
+    if((iphc0 & SICSLOWPAN_IPHC_NH_C) == 0 ||
+       (*nhc_ptr & ~SICSLOWPAN_NHC_BIT) !=
+       (SICSLOWPAN_NHC_EXT_HDR | (SICSLOWPAN_NHC_ETX_HDR_HBHO << 1)) ||
+       uip_is_proto_ext_hdr(ext_hdr->next) ||
+       ext_hdr->len != 0 ||
+       ((uint8_t *)ext_hdr)[2] != UIP_EXT_HDR_OPT_RPL) {
+      return 0;
+    }
+    hbh_ptr = nhc_ptr + 1;
+    if((*nhc_ptr & SICSLOWPAN_NHC_BIT) == 0) {
+      hbh_ptr++;
+    }
+    hbh_len = *hbh_ptr++;
+    if(hbh_len != 8 - UIP_EXT_HDR_LEN) {
+      return 0;
+    }
+  } else if(uip_is_proto_ext_hdr(proto)) {
+    return 0;
+  }
+
+  nexthop_lladdr = tcpip_ipv6_nexthop_lladdr();
+  if(nexthop_lladdr == NULL) {
+    return 0;
+  }
+  linkaddr_copy(&dest, (const linkaddr_t *)nexthop_lladdr);
+
+  /* From here on the packet is ours: the routing protocol is given the
+     same view of the header as in the regular path */
+  UIP_STAT(++uip_stat.ip.recv);
+  if(ext_hdr != NULL &&
+     !NETSTACK_ROUTING.ext_header_hbh_update((uint8_t *)ext_hdr, 2)) {
+    LOG_ERR("fast-forward: RPL option error, dropping packet\n");
+    UIP_STAT(++uip_stat.ip.drop);
+    return 1;
+  }
+  UIP_IP_BUF->ttl--;
+  if(!NETSTACK_ROUTING.ext_header_update() || UIP_IP_BUF->proto != proto) {
+    LOG_ERR("fast-forward: extension header update error, dropping packet\n");
+    UIP_STAT(++uip_stat.ip.drop);
+    return 1;
+  }
+
+  /* Write back the updated fields into the compressed frame */
+  *ttl_ptr = UIP_IP_BUF->ttl;
+  if(hbh_ptr != NULL) {
+    memcpy(hbh_ptr, (uint8_t *)ext_hdr + UIP_EXT_HDR_LEN, hbh_len);
+  }
+
+  /* Turn the incoming frame into an outgoing one, keeping the security
+     level it was received with, as the regular path does via uipbuf */
+#if LLSEC802154_USES_AUX_HEADER
+  security_level = packetbuf_attr(PACKETBUF_ATTR_SECURITY_LEVEL);
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  key_index = packetbuf_attr(PACKETBUF_ATTR_KEY_INDEX);
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+  packetbuf_compact();
+  packetbuf_attr_clear();
+  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
+                     UIP_MAX_MAC_TRANSMISSIONS_UNDEFINED);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &dest);
+#if LLSEC802154_USES_AUX_HEADER
+  packetbuf_set_attr(PACKETBUF_ATTR_SECURITY_LEVEL, security_level);
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  packetbuf_set_attr(PACKETBUF_ATTR_KEY_INDEX, key_index);
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+
+  mac_max_payload = NETSTACK_MAC.max_payload();
+  if(mac_max_payload <= 0 || packetbuf_datalen() > mac_max_payload) {
+    LOG_WARN("fast-forward: frame does not fit MAC payload (%u > %d), dropping packet\n",
+             packetbuf_datalen(), mac_max_payload);
+    UIP_STAT(++uip_stat.ip.drop);
+    return 1;
+  }
+
+  LOG_INFO("fast-forward: %u bytes to ", packetbuf_datalen());
+  LOG_INFO_LLADDR(&dest);
+  LOG_INFO_("\n");
+  UIP_STAT(++uip_stat.ip.forwarded);
+  send_packet(&dest);
+  return 1;
+}
+/** @} */
+#endif /* SICSLOWPAN_FAST_FORWARD && UIP_CONF_ROUTER */
+
 /*--------------------------------------------------------------------*/
 /** \brief Process a received 6lowpan packet.
  *
@@ -1985,6 +2307,12 @@ input(void)
       LOG_ERR("input: failed to decompress IPHC packet\n");
       return;
     }
+#if SICSLOWPAN_FAST_FORWARD && UIP_CONF_ROUTER
+    /* Non-fragmented packets may be forwarded without copying the payload */
+    if(frag_size == 0 && fast_forward()) {
+      return;
+    }
+#endif /* SICSLOWPAN_FAST_FORWARD && UIP_CONF_ROUTER */
   } else if(PACKETBUF_6LO_PTR[PACKETBUF_6LO_DISPATCH] == SICSLOWPAN_DISPATCH_IPV6) {
     LOG_DBG("uncompression: IPV6 dispatch\n");
     packetbuf_hdr_len += SICSLOWPAN_IPV6_HDR_LEN;
@@ -555,6 +555,39 @@ get_nexthop(uip_ipaddr_t *addr)
   return nexthop;
 }
 /*---------------------------------------------------------------------------*/
+const uip_lladdr_t *
+tcpip_ipv6_nexthop_lladdr(void)
+{
+  const uip_ipaddr_t *nexthop;
+  uip_ds6_route_t *route;
+  uip_ds6_nbr_t *nbr;
+
+  if(uip_ds6_is_addr_onlink(&UIP_IP_BUF->destipaddr)) {
+    nexthop = &UIP_IP_BUF->destipaddr;
+  } else if((route = uip_ds6_route_lookup(&UIP_IP_BUF->destipaddr)) != NULL) {
+    /* A dead route is left for get_nexthop to clean up */
+    nexthop = uip_ds6_route_nexthop(route);
+  } else {
+    nexthop = uip_ds6_defrt_choose();
+  }
+  if(nexthop == NULL) {
+    return NULL;
+  }
+
+  nbr = uip_ds6_nbr_lookup(nexthop);
+  if(nbr == NULL) {
+    return NULL;
+  }
+#if UIP_ND6_SEND_NS
+  /* Incomplete and stale entries need the NUD state machine */
+  if(nbr->state == NBR_INCOMPLETE || nbr->state == NBR_STALE) {
+    return NULL;
+  }
+#endif /* UIP_ND6_SEND_NS */
+
+  return uip_ds6_nbr_get_ll(nbr);
+}
+/*---------------------------------------------------------------------------*/
 #if UIP_ND6_SEND_NS
 static int
 queue_packet(uip_ds6_nbr_t *nbr)
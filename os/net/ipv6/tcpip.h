@@ -347,6 +347,19 @@ uint8_t tcpip_output(const uip_lladdr_t *);
  */
 void tcpip_ipv6_output(void);
 
+/**
+ * \brief Look up the link-layer address of the next hop for the IPv6
+ * header in uip_buf, without side effects
+ *
+ * Unlike tcpip_ipv6_output, this neither sends NS, autofills or
+ * updates the neighbor cache, drops dead routes, nor uses the fallback
+ * interface. It is meant for forwarding shortcuts that can fall back to
+ * the full output path whenever it returns NULL.
+ *
+ * \return The link-layer address of a reachable next hop, or NULL
+ */
+const uip_lladdr_t *tcpip_ipv6_nexthop_lladdr(void);
+
 /**
  * \brief Is forwarding generally enabled?
  */
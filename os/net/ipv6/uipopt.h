@@ -559,6 +559,28 @@ void uip_log(char *msg);
 #define SICSLOWPAN_CONF_FRAG  1
 #endif
 
+/**
+ * Do we forward routed IPHC packets straight from packetbuf, rewriting
+ * only the hop limit and hop-by-hop options in the compressed frame,
+ * instead of uncompressing them to uip_buf and compressing them again
+ */
+#ifdef SICSLOWPAN_CONF_FAST_FORWARD
+#define SICSLOWPAN_FAST_FORWARD SICSLOWPAN_CONF_FAST_FORWARD
+#else
+#define SICSLOWPAN_FAST_FORWARD 0
+#endif
+
+/**
+ * The number of UDP flows for which we cache the compressed IPHC header,
+ * so that subsequent packets of the same flow are compressed by copying
+ * it and appending the UDP checksum (0 to disable)
+ */
+#ifdef SICSLOWPAN_CONF_IPHC_FLOW_CACHE
+#define SICSLOWPAN_IPHC_FLOW_CACHE SICSLOWPAN_CONF_IPHC_FLOW_CACHE
+#else
+#define SICSLOWPAN_IPHC_FLOW_CACHE 0
+#endif
+
 /** @} */
 
 /*------------------------------------------------------------------------------*/
@@ -166,11 +166,8 @@ backoff_period(void)
 }
 /*---------------------------------------------------------------------------*/
 static int
-send_one_packet(struct neighbor_queue *n, struct packet_queue *q)
+create_frame(void)
 {
-  int ret;
-  int last_sent_ok = 0;
-
   packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &linkaddr_node_addr);
   packetbuf_set_attr(PACKETBUF_ATTR_MAC_ACK, 1);
 
@@ -181,70 +178,94 @@ send_one_packet(struct neighbor_queue *n, struct packet_queue *q)
 #endif /* LLSEC802154_USES_EXPLICIT_KEYS */
 #endif /* LLSEC802154_ENABLED */
 
-  if(csma_security_create_frame() < 0) {
-    /* Failed to allocate space for headers */
-    LOG_ERR("failed to create packet, seqno: %d\n", packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO));
-    ret = MAC_TX_ERR_FATAL;
-  } else {
-    int is_broadcast;
-    uint8_t dsn;
-    dsn = ((uint8_t *)packetbuf_hdrptr())[2] & 0xff;
+  return csma_security_create_frame();
+}
+/*---------------------------------------------------------------------------*/
+static int
+transmit_frame(const uint8_t *frame, uint16_t len, int is_broadcast)
+{
+  int ret;
+  uint8_t dsn;
 
-    NETSTACK_RADIO.prepare(packetbuf_hdrptr(), packetbuf_totlen());
+  dsn = frame[2] & 0xff;
 
-    is_broadcast = packetbuf_holds_broadcast();
+  NETSTACK_RADIO.prepare(frame, len);
 
-    if(NETSTACK_RADIO.receiving_packet() ||
-       (!is_broadcast && NETSTACK_RADIO.pending_packet())) {
+  if(NETSTACK_RADIO.receiving_packet() ||
+     (!is_broadcast && NETSTACK_RADIO.pending_packet())) {
 
-      /* Currently receiving a packet over air or the radio has
-         already received a packet that needs to be read before
-         sending with auto ack. */
-      ret = MAC_TX_COLLISION;
-    } else {
+    /* Currently receiving a packet over air or the radio has
+       already received a packet that needs to be read before
+       sending with auto ack. */
+    ret = MAC_TX_COLLISION;
+  } else {
 
-      switch(NETSTACK_RADIO.transmit(packetbuf_totlen())) {
-      case RADIO_TX_OK:
-        if(is_broadcast) {
-          ret = MAC_TX_OK;
-        } else {
-          /* Check for ack */
-
-          /* Wait for max CSMA_ACK_WAIT_TIME */
-          RTIMER_BUSYWAIT_UNTIL(NETSTACK_RADIO.pending_packet(), CSMA_ACK_WAIT_TIME);
-
-          ret = MAC_TX_NOACK;
-          if(NETSTACK_RADIO.receiving_packet() ||
-             NETSTACK_RADIO.pending_packet() ||
-             NETSTACK_RADIO.channel_clear() == 0) {
-            int len;
-            uint8_t ackbuf[CSMA_ACK_LEN];
-
-            /* Wait an additional CSMA_AFTER_ACK_DETECTED_WAIT_TIME to complete reception */
-            RTIMER_BUSYWAIT_UNTIL(NETSTACK_RADIO.pending_packet(), CSMA_AFTER_ACK_DETECTED_WAIT_TIME);
-
-            if(NETSTACK_RADIO.pending_packet()) {
-              len = NETSTACK_RADIO.read(ackbuf, CSMA_ACK_LEN);
-              if(len == CSMA_ACK_LEN && ackbuf[2] == dsn) {
-                /* Ack received */
-                ret = MAC_TX_OK;
-              } else {
-                /* Not an ack or ack not for us: collision */
-                ret = MAC_TX_COLLISION;
-              }
+    switch(NETSTACK_RADIO.transmit(len)) {
+    case RADIO_TX_OK:
+      if(is_broadcast) {
+        ret = MAC_TX_OK;
+      } else {
+        /* Check for ack */
+
+        /* Wait for max CSMA_ACK_WAIT_TIME */
+        RTIMER_BUSYWAIT_UNTIL(NETSTACK_RADIO.pending_packet(), CSMA_ACK_WAIT_TIME);
+
+        ret = MAC_TX_NOACK;
+        if(NETSTACK_RADIO.receiving_packet() ||
+           NETSTACK_RADIO.pending_packet() ||
+           NETSTACK_RADIO.channel_clear() == 0) {
+          int len;
+          uint8_t ackbuf[CSMA_ACK_LEN];
+
+          /* Wait an additional CSMA_AFTER_ACK_DETECTED_WAIT_TIME to complete reception */
+          RTIMER_BUSYWAIT_UNTIL(NETSTACK_RADIO.pending_packet(), CSMA_AFTER_ACK_DETECTED_WAIT_TIME);
+
+          if(NETSTACK_RADIO.pending_packet()) {
+            len = NETSTACK_RADIO.read(ackbuf, CSMA_ACK_LEN);
+            if(len == CSMA_ACK_LEN && ackbuf[2] == dsn) {
+              /* Ack received */
+              ret = MAC_TX_OK;
+            } else {
+              /* Not an ack or ack not for us: collision */
+              ret = MAC_TX_COLLISION;
             }
           }
         }
-        break;
-      case RADIO_TX_COLLISION:
-        ret = MAC_TX_COLLISION;
-        break;
-      default:
-        ret = MAC_TX_ERR;
-        break;
       }
+      break;
+    case RADIO_TX_COLLISION:
+      ret = MAC_TX_COLLISION;
+      break;
+    default:
+      ret = MAC_TX_ERR;
+      break;
     }
   }
+
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+static int
+send_one_packet(struct neighbor_queue *n, struct packet_queue *q)
+{
+  int ret;
+  int last_sent_ok = 0;
+
+#if CSMA_SEND_FROM_QUEUEBUF
+  /* The frame was created when the packet was queued */
+  ret = transmit_frame(queuebuf_dataptr(q->buf), queuebuf_datalen(q->buf),
+                       linkaddr_cmp(queuebuf_addr(q->buf, PACKETBUF_ADDR_RECEIVER),
+                                    &linkaddr_null));
+#else /* CSMA_SEND_FROM_QUEUEBUF */
+  if(create_frame() < 0) {
+    /* Failed to allocate space for headers */
+    LOG_ERR("failed to create packet, seqno: %d\n", packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO));
+    ret = MAC_TX_ERR_FATAL;
+  } else {
+    ret = transmit_frame(packetbuf_hdrptr(), packetbuf_totlen(),
+                         packetbuf_holds_broadcast());
+  }
+#endif /* CSMA_SEND_FROM_QUEUEBUF */
   if(ret == MAC_TX_OK) {
     last_sent_ok = 1;
   }
@@ -266,7 +287,13 @@ transmit_from_queue(void *ptr)
         queuebuf_attr(q->buf, PACKETBUF_ATTR_MAC_SEQNO),
         n->transmissions, list_length(n->packet_queue));
       /* Send first packet in the neighbor queue */
+#if CSMA_SEND_FROM_QUEUEBUF
+      /* The frame is sent from the queuebuf, but the radio driver and
+         the sent callback expect the attributes in packetbuf */
+      queuebuf_attr_to_packetbuf(q->buf);
+#else /* CSMA_SEND_FROM_QUEUEBUF */
       queuebuf_to_packetbuf(q->buf);
+#endif /* CSMA_SEND_FROM_QUEUEBUF */
       send_one_packet(n, q);
     }
   }
@@ -335,7 +362,7 @@ tx_done(int status, struct packet_queue *q, struct neighbor_queue *n)
   LOG_INFO("packet sent to ");
   LOG_INFO_LLADDR(&n->addr);
   LOG_INFO_(", seqno %u, status %u, tx %u, coll %u\n",
-              packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO),
+              queuebuf_attr(q->buf, PACKETBUF_ATTR_MAC_SEQNO),
               status, n->transmissions, n->collisions);
 
   free_packet(n, q, status);
@@ -416,7 +443,7 @@ packet_sent(struct neighbor_queue *n,
   LOG_INFO("tx to ");
   LOG_INFO_LLADDR(&n->addr);
   LOG_INFO_(", seqno %u, status %u, tx %u, coll %u\n",
-            packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO),
+            queuebuf_attr(q->buf, PACKETBUF_ATTR_MAC_SEQNO),
             status, n->transmissions, n->collisions);
 
   switch(status) {
@@ -460,6 +487,15 @@ csma_output_packet(mac_callback_t sent, void *ptr)
   packetbuf_set_attr(PACKETBUF_ATTR_MAC_SEQNO, seqno++);
   packetbuf_set_attr(PACKETBUF_ATTR_FRAME_TYPE, FRAME802154_DATAFRAME);
 
+#if CSMA_SEND_FROM_QUEUEBUF
+  /* Create the frame once, all transmissions are done from the queuebuf */
+  if(create_frame() < 0) {
+    LOG_ERR("failed to create packet, seqno: %d\n", packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO));
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR_FATAL, 1);
+    return;
+  }
+#endif /* CSMA_SEND_FROM_QUEUEBUF */
+
   /* Look for the neighbor entry */
   n = neighbor_queue_from_addr(addr);
   if(n == NULL) {
@@ -72,6 +72,17 @@
 #define CSMA_AFTER_ACK_DETECTED_WAIT_TIME       RTIMER_SECOND / 1500
 #endif /* CSMA_CONF_AFTER_ACK_DETECTED_WAIT_TIME */
 
+/* When set, the frame is created once when the packet is queued, and
+ * every (re)transmission is done straight from the queuebuf instead of
+ * copying it back to packetbuf and framing it again. Only the packet
+ * attributes are loaded into packetbuf for each transmission, so the
+ * sent callback finds them there, but not the packet data. */
+#ifdef CSMA_CONF_SEND_FROM_QUEUEBUF
+#define CSMA_SEND_FROM_QUEUEBUF CSMA_CONF_SEND_FROM_QUEUEBUF
+#else /* CSMA_CONF_SEND_FROM_QUEUEBUF */
+#define CSMA_SEND_FROM_QUEUEBUF 0
+#endif /* CSMA_CONF_SEND_FROM_QUEUEBUF */
+
 #define CSMA_ACK_LEN 3
 
 /* just a default - with LLSEC, etc */
@@ -79,6 +79,8 @@ static sixp_trans_mode_t determine_trans_mode(const sixp_pkt_t *req);
 MEMB(trans_memb, sixp_trans_t, SIXTOP_MAX_TRANSACTIONS);
 LIST(trans_list);
 
+struct sixp_trans_stats sixp_trans_stats;
+
 /*---------------------------------------------------------------------------*/
 void sixp_handle_trans_timeout(void *ptr)
 {
@@ -90,6 +92,7 @@ void sixp_handle_trans_timeout(void *ptr)
   }
 
   LOG_DBG("trans(%p) timeout wake\n", trans);
+  sixp_trans_stats.timeouts++;
 
   if(trans->sf->timeout != NULL) {
     trans->sf->timeout(trans->cmd,
@@ -139,11 +142,13 @@ void sixp_process_trans(void *ptr)
     case SIXP_TRANS_STATE_RESPONSE_SENT:
     case SIXP_TRANS_STATE_RESPONSE_RECEIVED:
       if(trans->mode == SIXP_TRANS_MODE_2_STEP) {
+        sixp_trans_stats.completed++;
         (void)sixp_trans_transit_state(trans, SIXP_TRANS_STATE_TERMINATING);
       }
       break;
     case SIXP_TRANS_STATE_CONFIRMATION_SENT:
     case SIXP_TRANS_STATE_CONFIRMATION_RECEIVED:
+      sixp_trans_stats.completed++;
       (void)sixp_trans_transit_state(trans, SIXP_TRANS_STATE_TERMINATING);
       break;
     case SIXP_TRANS_STATE_TERMINATING:
@@ -416,6 +421,7 @@ sixp_trans_alloc(const sixp_pkt_t *pkt, const linkaddr_t *peer_addr)
 
   if((trans = memb_alloc(&trans_memb)) == NULL) {
     LOG_ERR("6P-trans: sixp_trans_alloc() fails because of lack of memory\n");
+    sixp_trans_stats.alloc_fails++;
     return NULL;
   }
 
@@ -583,6 +589,7 @@ sixp_trans_abort(sixp_trans_t *trans)
     LOG_INFO("6P-trans: trans [peer_addr:");
     LOG_INFO_LLADDR((const linkaddr_t *)&trans->peer_addr);
     LOG_INFO_(", seqno:%u] is going to be aborted\n", trans->seqno);
+    sixp_trans_stats.aborted++;
     sixp_trans_terminate(trans);
     sixp_trans_invoke_callback(trans, SIXP_OUTPUT_STATUS_ABORTED);
     /* process_trans() should be scheduled, which we will be stop */
@@ -594,6 +601,12 @@ sixp_trans_abort(sixp_trans_t *trans)
 }
 /*---------------------------------------------------------------------------*/
 int
+sixp_trans_count(void)
+{
+  return list_length(trans_list);
+}
+/*---------------------------------------------------------------------------*/
+int
 sixp_trans_init(void)
 {
   sixp_trans_t *trans, *next_trans;
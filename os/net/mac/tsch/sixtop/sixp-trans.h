@@ -245,6 +245,22 @@ sixp_trans_t *sixp_trans_find_for_sfid(const linkaddr_t *peer_addr, uint8_t sfid
 // @return true - some transaction are active
 bool    sixp_trans_any();
 
+/**
+ * \brief Outcomes of the 6P transactions since boot
+ */
+struct sixp_trans_stats {
+  uint16_t completed;   /**< Transactions that ran to their last step */
+  uint16_t timeouts;    /**< Transactions terminated by their SF timeout */
+  uint16_t aborted;     /**< Transactions aborted with sixp_trans_abort() */
+  uint16_t alloc_fails; /**< Transactions refused for lack of memory */
+};
+extern struct sixp_trans_stats sixp_trans_stats;
+
+/**
+ * \brief Return the number of transactions in progress
+ */
+int sixp_trans_count(void);
+
 /**
  * \brief Initialize Memory and List for 6P transactions
  * This function removes and frees existing transactions.
@@ -280,14 +280,14 @@ sixp_input(const uint8_t *buf, uint16_t len, const linkaddr_t *src_addr)
          * RC_ERR_SEQNUM. in this case, we don't want to allocate
          * another transaction for this new request.
          */
-        LOG_DBG("seq break: %u expects %u\n", pkt.seqno, seqno);
+        LOG_DBG("seq break: %u expects %u\n", pkt.seqno, (unsigned)seqno);
         handle_schedule_inconsistency(sf, (const sixp_pkt_t *)&pkt, src_addr);
         return;
       } else {
         /* Error: not supposed to have another transaction with the peer. */
         LOG_ERR("6P: sixp_input() fails because another request [peer_addr:");
         LOG_ERR_LLADDR((const linkaddr_t *)src_addr);
-        LOG_ERR_(" seqno:%u] is in process\n", seqno);
+        LOG_ERR_(" seqno:%u] is in process\n", (unsigned)seqno);
         /*
          * Although RFC 8480 says in Section 3.4.3 that we MUST send
          * RC_RESET back in this case, we use RC_ERR_BUSY
@@ -356,7 +356,7 @@ sixp_input(const uint8_t *buf, uint16_t len, const linkaddr_t *src_addr)
       return;
     } else if( seqno != pkt.seqno ) {
       LOG_ERR("6P: sixp_input() fails because of invalid seqno [seqno:%u, %u]\n",
-              seqno, pkt.seqno);
+              (unsigned)seqno, pkt.seqno);
       /*
        * Figure 31 of RFC 8480 implies there is a chance to receive a
        * 6P Response having RC_ERR_SEQNUM and SeqNum of 0. But, it
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2026, agent <agent@local>.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Live TSCH, MSF and 6P counters for remote monitoring
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-monitor.h"
+#if TSCH_WITH_SIXTOP
+#include "net/mac/tsch/sixtop/sixp-trans.h"
+#endif
+#if BUILD_WITH_MSF
+#include "services/shell/shell.h"
+#include "services/msf/msf-num-cells.h"
+#endif
+
+/*---------------------------------------------------------------------------*/
+#if TSCH_STATS_ON
+/* Mean over all channels of a time source statistic, unscaled */
+static int32_t
+time_source_mean(tsch_monitor_counter_t counter)
+{
+  struct tsch_neighbor_stats *stats;
+  struct tsch_channel_stats *ch;
+  int32_t sum;
+  int i;
+
+  stats = tsch_stats_get_from_neighbor(tsch_queue_get_time_source());
+  if(stats == NULL) {
+    return 0;
+  }
+
+  sum = 0;
+  for(i = 0; i < TSCH_STATS_NUM_CHANNELS; i++) {
+    ch = &stats->channel_stats[i];
+    if(counter == TSCH_MONITOR_TS_RSSI) {
+      sum += ch->rssi;
+    } else if(counter == TSCH_MONITOR_TS_LQI) {
+      sum += ch->lqi;
+    } else {
+      sum += ch->p_tx_success;
+    }
+  }
+  sum /= TSCH_STATS_NUM_CHANNELS;
+
+  if(counter == TSCH_MONITOR_TS_RSSI) {
+    return sum / TSCH_STATS_RSSI_SCALING_FACTOR;
+  } else if(counter == TSCH_MONITOR_TS_LQI) {
+    return sum / TSCH_STATS_LQI_SCALING_FACTOR;
+  }
+  return sum * 100 / TSCH_STATS_BINARY_SCALING_FACTOR;
+}
+#endif /* TSCH_STATS_ON */
+/*---------------------------------------------------------------------------*/
+#if BUILD_WITH_MSF
+static int32_t
+msf_counter(msf_negotiated_cell_type_t cell_type, tsch_monitor_counter_t counter)
+{
+  const msf_num_cells_t *num_cells = msf_num_cells_get(cell_type);
+
+  switch(counter) {
+  case TSCH_MONITOR_MSF_TX_SCHEDULED:
+  case TSCH_MONITOR_MSF_RX_SCHEDULED:
+    return num_cells->scheduled;
+  case TSCH_MONITOR_MSF_TX_REQUIRED:
+  case TSCH_MONITOR_MSF_RX_REQUIRED:
+    return num_cells->required;
+  case TSCH_MONITOR_MSF_TX_USED:
+  case TSCH_MONITOR_MSF_RX_USED:
+    return num_cells->used;
+  default:
+    return num_cells->elapsed;
+  }
+}
+#endif /* BUILD_WITH_MSF */
+/*---------------------------------------------------------------------------*/
+int32_t
+tsch_monitor_get(tsch_monitor_counter_t counter)
+{
+  switch(counter) {
+  case TSCH_MONITOR_ASSOCIATED:
+    return tsch_is_associated;
+  case TSCH_MONITOR_TX_QUEUE_LENGTH:
+    return tsch_queue_global_packet_count();
+  case TSCH_MONITOR_TS_TX_QUEUE_LENGTH:
+    return MAX(tsch_queue_nbr_packet_count(tsch_queue_get_time_source()), 0);
+#if TSCH_STATS_ON
+  case TSCH_MONITOR_MAX_SYNC_ERROR:
+    return tsch_stats.max_sync_error;
+  case TSCH_MONITOR_DISASSOCIATIONS:
+    return tsch_stats.num_disassociations;
+  case TSCH_MONITOR_TX_QUEUE_DROPS:
+    return tsch_stats.num_tx_queue_drops;
+  case TSCH_MONITOR_INPUT_QUEUE_DROPS:
+    return tsch_stats.num_input_queue_drops;
+  case TSCH_MONITOR_DEADLINE_MISSES:
+    return tsch_stats.num_deadline_misses;
+  case TSCH_MONITOR_TS_P_TX_SUCCESS:
+  case TSCH_MONITOR_TS_RSSI:
+  case TSCH_MONITOR_TS_LQI:
+    return time_source_mean(counter);
+#endif /* TSCH_STATS_ON */
+#if BUILD_WITH_MSF
+  case TSCH_MONITOR_MSF_TX_SCHEDULED:
+  case TSCH_MONITOR_MSF_TX_REQUIRED:
+  case TSCH_MONITOR_MSF_TX_USED:
+  case TSCH_MONITOR_MSF_TX_ELAPSED:
+    return msf_counter(MSF_NEGOTIATED_CELL_TYPE_TX, counter);
+  case TSCH_MONITOR_MSF_RX_SCHEDULED:
+  case TSCH_MONITOR_MSF_RX_REQUIRED:
+  case TSCH_MONITOR_MSF_RX_USED:
+  case TSCH_MONITOR_MSF_RX_ELAPSED:
+    return msf_counter(MSF_NEGOTIATED_CELL_TYPE_RX, counter);
+#endif /* BUILD_WITH_MSF */
+#if TSCH_WITH_SIXTOP
+  case TSCH_MONITOR_SIXP_COMPLETED:
+    return sixp_trans_stats.completed;
+  case TSCH_MONITOR_SIXP_TIMEOUTS:
+    return sixp_trans_stats.timeouts;
+  case TSCH_MONITOR_SIXP_ABORTED:
+    return sixp_trans_stats.aborted;
+  case TSCH_MONITOR_SIXP_ALLOC_FAILS:
+    return sixp_trans_stats.alloc_fails;
+  case TSCH_MONITOR_SIXP_ACTIVE:
+    return sixp_trans_count();
+#endif /* TSCH_WITH_SIXTOP */
+  default:
+    return 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
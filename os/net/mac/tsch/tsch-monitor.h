@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026, agent <agent@local>.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Live TSCH, MSF and 6P counters for remote monitoring
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+*/
+
+#ifndef __TSCH_MONITOR_H__
+#define __TSCH_MONITOR_H__
+
+#include "contiki.h"
+
+/*
+ * The counters exported to SNMP and LwM2M. The numbering is part of the
+ * management interface: append new counters, do not reorder them.
+ * Counters of features that are not built in read as 0.
+ */
+typedef enum {
+  TSCH_MONITOR_ASSOCIATED,            /* 1 when associated to a TSCH network */
+  TSCH_MONITOR_MAX_SYNC_ERROR,        /* tsch_stats (TSCH_STATS_ON) */
+  TSCH_MONITOR_DISASSOCIATIONS,
+  TSCH_MONITOR_TX_QUEUE_DROPS,
+  TSCH_MONITOR_INPUT_QUEUE_DROPS,
+  TSCH_MONITOR_DEADLINE_MISSES,
+  TSCH_MONITOR_TX_QUEUE_LENGTH,       /* packets in all TX queues */
+  TSCH_MONITOR_TS_TX_QUEUE_LENGTH,    /* time source neighbor */
+  TSCH_MONITOR_TS_P_TX_SUCCESS,       /* %, mean over channels */
+  TSCH_MONITOR_TS_RSSI,               /* dBm, mean over channels */
+  TSCH_MONITOR_TS_LQI,                /* mean over channels */
+  TSCH_MONITOR_MSF_TX_SCHEDULED,      /* MSF NumCells* (BUILD_WITH_MSF) */
+  TSCH_MONITOR_MSF_TX_REQUIRED,
+  TSCH_MONITOR_MSF_TX_USED,
+  TSCH_MONITOR_MSF_TX_ELAPSED,
+  TSCH_MONITOR_MSF_RX_SCHEDULED,
+  TSCH_MONITOR_MSF_RX_REQUIRED,
+  TSCH_MONITOR_MSF_RX_USED,
+  TSCH_MONITOR_MSF_RX_ELAPSED,
+  TSCH_MONITOR_SIXP_COMPLETED,        /* 6P transactions (TSCH_WITH_SIXTOP) */
+  TSCH_MONITOR_SIXP_TIMEOUTS,
+  TSCH_MONITOR_SIXP_ABORTED,
+  TSCH_MONITOR_SIXP_ALLOC_FAILS,
+  TSCH_MONITOR_SIXP_ACTIVE,
+  TSCH_MONITOR_COUNT,
+} tsch_monitor_counter_t;
+
+/**
+ * \brief Read a counter from the live TSCH, MSF and 6P structures
+ * \param counter The counter
+ * \return The value, 0 for an unknown or unavailable counter
+ */
+int32_t tsch_monitor_get(tsch_monitor_counter_t counter);
+
+#endif /* __TSCH_MONITOR_H__ */
+/** @} */
@@ -143,6 +143,12 @@ struct tsch_global_stats {
   uint32_t max_sync_error;
   /* number of disassociations */
   uint16_t num_disassociations;
+  /* packets that did not fit a TX queue */
+  uint32_t num_tx_queue_drops;
+  /* received frames dropped because the input queue was full */
+  uint32_t num_input_queue_drops;
+  /* slot operations skipped because their deadline had passed */
+  uint32_t num_deadline_misses;
 #if TSCH_STATS_SAMPLE_NOISE_RSSI
   /* per-channel noise estimates */
   tsch_stat_t noise_rssi[TSCH_STATS_NUM_CHANNELS];
@@ -180,6 +186,9 @@ extern struct tsch_neighbor_stats tsch_neighbor_stats;
 
 /************ Functions ***********/
 
+/* Increment one of the tsch_stats counters */
+#define TSCH_STATS_INC(field) (tsch_stats.field++)
+
 void tsch_stats_init(void);
 
 void tsch_stats_tx_packet(struct tsch_neighbor *, uint8_t mac_status, uint8_t channel);
@@ -196,6 +205,7 @@ void tsch_stats_reset_neighbor_stats(void);
 
 #else /* TSCH_STATS_ON */
 
+#define TSCH_STATS_INC(field)
 #define tsch_stats_init()
 #define tsch_stats_tx_packet(n, mac_status, channel)
 #define tsch_stats_rx_packet(n, rssi, lqi, channel)
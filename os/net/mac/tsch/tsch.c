@@ -459,7 +459,7 @@ eb_input(struct input_packet *current_input)
       int32_t asn_diff = TSCH_ASN_DIFF(current_input->rx_asn, eb_ies.ie_asn);
       if(asn_diff != 0) {
         /* We disagree with our time source's ASN -- leave the network */
-        LOG_WARN("! ASN drifted by %ld, leaving the network\n", asn_diff);
+        LOG_WARN("! ASN drifted by %ld, leaving the network\n", (long)asn_diff);
         tsch_disassociate();
       }
 
@@ -583,7 +583,8 @@ tsch_start_coordinator(void)
   tsch_join_priority = 0;
 
   LOG_INFO("starting as coordinator, PAN ID %x, asn-%x.%lx\n",
-      frame802154_get_pan_id(), tsch_current_asn.ms1b, tsch_current_asn.ls4b);
+      frame802154_get_pan_id(), tsch_current_asn.ms1b,
+      (unsigned long)tsch_current_asn.ls4b);
 
 #ifdef TSCH_CALLBACK_JOINING_NETWORK
       TSCH_CALLBACK_JOINING_NETWORK();
@@ -599,6 +600,7 @@ tsch_disassociate(void)
 {
   if(tsch_is_associated == 1) {
     tsch_is_associated = 0;
+    TSCH_STATS_INC(num_disassociations);
     tsch_adaptive_timesync_reset();
     process_poll(&tsch_process);
 #ifdef TSCH_CALLBACK_LEAVING_NETWORK
@@ -772,7 +774,8 @@ tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
              tsch_association_count,
              tsch_is_pan_secured,
              frame.src_pid,
-             tsch_current_asn.ms1b, tsch_current_asn.ls4b, tsch_join_priority,
+             tsch_current_asn.ms1b, (unsigned long)tsch_current_asn.ls4b,
+             tsch_join_priority,
              ies.ie_tsch_timeslot_id,
              ies.ie_channel_hopping_sequence_id,
              ies.ie_tsch_slotframe_and_link.slotframe_size,
@@ -1012,11 +1015,12 @@ tsch_init(void)
   radio_value_t radio_rx_mode;
   radio_value_t radio_tx_mode;
   radio_value_t radio_max_payload_len;
+  const uint16_t *default_timing = TSCH_DEFAULT_TIMESLOT_TIMING;
 
   rtimer_clock_t t;
 
   /* Check that the platform provides a TSCH timeslot timing template */
-  if(TSCH_DEFAULT_TIMESLOT_TIMING == NULL) {
+  if(default_timing == NULL) {
     LOG_ERR("! platform does not provide a timeslot timing template.\n");
     return;
   }
@@ -1231,6 +1235,9 @@ turn_on(void)
   if(tsch_is_initialized == 1 && tsch_is_started == 0) {
     tsch_is_started = 1;
     /* Process tx/rx callback and log messages whenever polled */
+#if PROCESS_PRIORITIES
+    process_set_priority(&tsch_pending_events_process, PROCESS_PRIO_HIGH);
+#endif /* PROCESS_PRIORITIES */
     process_start(&tsch_pending_events_process, NULL);
     if(TSCH_EB_PERIOD > 0) {
       /* periodically send TSCH EBs */
@@ -133,6 +133,15 @@ packetbuf_hdrreduce(int size)
 }
 /*---------------------------------------------------------------------------*/
 void
+packetbuf_compact(void)
+{
+  if(bufptr > 0) {
+    memmove(packetbuf + hdrlen, packetbuf_dataptr(), buflen);
+    bufptr = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
 packetbuf_set_datalen(uint16_t len)
 {
   PRINTF("packetbuf_set_len: len %d\n", len);
@@ -192,6 +192,19 @@ int packetbuf_hdralloc(int size);
  */
 int packetbuf_hdrreduce(int size);
 
+/**
+ * \brief      Move the data of an incoming packet to the start of the packetbuf
+ *
+ *             After packetbuf_hdrreduce() has been called on an
+ *             incoming packet, the reduced header is still kept in
+ *             front of the data. This function discards it so that
+ *             the packetbuf can be sent out again, with a new header
+ *             allocated by packetbuf_hdralloc(), without copying the
+ *             data to another buffer first.
+ *
+ */
+void packetbuf_compact(void);
+
 /* Packet attributes stuff below: */
 
 typedef uint16_t packetbuf_attr_t;
@@ -426,6 +426,15 @@ queuebuf_to_packetbuf(struct queuebuf *b)
   }
 }
 /*---------------------------------------------------------------------------*/
+void
+queuebuf_attr_to_packetbuf(struct queuebuf *b)
+{
+  if(memb_inmemb(&bufmem, b)) {
+    struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
+    packetbuf_attr_copyfrom(buframptr->attrs, buframptr->addrs);
+  }
+}
+/*---------------------------------------------------------------------------*/
 void *
 queuebuf_dataptr(struct queuebuf *b)
 {
@@ -302,6 +302,34 @@
 #define RPL_REPAIR_ON_DAO_NACK 0
 #endif /* RPL_CONF_RPL_REPAIR_ON_DAO_NACK */
 
+/*
+ * RPL DAO aggregation (storing mode only). When enabled, DAOs received
+ * from children are not forwarded one by one: their targets are
+ * collected for RPL_DAO_AGGREGATION_DELAY and sent to the preferred
+ * parent as one DAO carrying up to RPL_DAO_AGGREGATION_MAX_TARGETS
+ * Target/Transit pairs. DAO-ACKs for such a DAO are fanned out to every
+ * child that contributed a target. All nodes of a storing mode network
+ * must agree on this setting, since non-aggregating nodes only consider
+ * the last target of a DAO.
+ * */
+#ifdef RPL_CONF_DAO_AGGREGATION
+#define RPL_DAO_AGGREGATION RPL_CONF_DAO_AGGREGATION
+#else
+#define RPL_DAO_AGGREGATION 0
+#endif /* RPL_CONF_DAO_AGGREGATION */
+
+#ifdef RPL_CONF_DAO_AGGREGATION_DELAY
+#define RPL_DAO_AGGREGATION_DELAY RPL_CONF_DAO_AGGREGATION_DELAY
+#else
+#define RPL_DAO_AGGREGATION_DELAY (CLOCK_SECOND / 2)
+#endif /* RPL_CONF_DAO_AGGREGATION_DELAY */
+
+#ifdef RPL_CONF_DAO_AGGREGATION_MAX_TARGETS
+#define RPL_DAO_AGGREGATION_MAX_TARGETS RPL_CONF_DAO_AGGREGATION_MAX_TARGETS
+#else
+#define RPL_DAO_AGGREGATION_MAX_TARGETS 8
+#endif /* RPL_CONF_DAO_AGGREGATION_MAX_TARGETS */
+
 /*
  * Setting the DIO_REFRESH_DAO_ROUTES will make the RPL root always
  * increase the DTSN (Destination Advertisement Trigger Sequence Number)
@@ -93,6 +93,28 @@ static uint8_t dao_sequence = RPL_LOLLIPOP_INIT;
 #if RPL_WITH_MULTICAST
 static uip_mcast6_route_t *mcast_group;
 #endif
+
+/* No DAO-ACK is to be sent for a received DAO (yet) */
+#define DAO_ACK_NONE -1
+
+#if RPL_WITH_STORING && RPL_DAO_AGGREGATION
+/* Room for the targets of a full aggregated DAO received while almost
+   a full one is already queued */
+#define DAO_AGGR_QUEUE_LEN (2 * RPL_DAO_AGGREGATION_MAX_TARGETS)
+
+struct dao_aggr_target {
+  rpl_instance_t *instance;
+  uip_ipaddr_t prefix;
+  uint8_t prefixlen;
+  uint8_t lifetime;
+};
+
+static struct dao_aggr_target dao_aggr_targets[DAO_AGGR_QUEUE_LEN];
+static uint8_t dao_aggr_count;
+static struct ctimer dao_aggr_timer;
+
+static void dao_aggr_flush(void);
+#endif /* RPL_WITH_STORING && RPL_DAO_AGGREGATION */
 /*---------------------------------------------------------------------------*/
 /* Initialise RPL ICMPv6 message handlers */
 UIP_ICMP6_HANDLER(dis_handler, ICMP6_RPL, RPL_CODE_DIS, dis_input);
@@ -101,7 +123,7 @@ UIP_ICMP6_HANDLER(dao_handler, ICMP6_RPL, RPL_CODE_DAO, dao_input);
 UIP_ICMP6_HANDLER(dao_ack_handler, ICMP6_RPL, RPL_CODE_DAO_ACK, dao_ack_input);
 /*---------------------------------------------------------------------------*/
 
-#if RPL_WITH_DAO_ACK
+#if RPL_WITH_DAO_ACK && !RPL_DAO_AGGREGATION
 static uip_ds6_route_t *
 find_route_entry_by_dao_ack(uint8_t seq)
 {
@@ -116,9 +138,9 @@ find_route_entry_by_dao_ack(uint8_t seq)
   }
   return NULL;
 }
-#endif /* RPL_WITH_DAO_ACK */
+#endif /* RPL_WITH_DAO_ACK && !RPL_DAO_AGGREGATION */
 
-#if RPL_WITH_STORING
+#if RPL_WITH_STORING && !RPL_DAO_AGGREGATION
 /* prepare for forwarding of DAO */
 static uint8_t
 prepare_for_dao_fwd(uint8_t sequence, uip_ds6_route_t *rep)
@@ -132,7 +154,7 @@ prepare_for_dao_fwd(uint8_t sequence, uip_ds6_route_t *rep)
   RPL_ROUTE_SET_DAO_PENDING(rep);
   return dao_sequence;
 }
-#endif /* RPL_WITH_STORING */
+#endif /* RPL_WITH_STORING && !RPL_DAO_AGGREGATION */
 /*---------------------------------------------------------------------------*/
 static int
 get_global_addr(uip_ipaddr_t *addr)
@@ -636,153 +658,96 @@ dio_output(rpl_instance_t *instance, uip_ipaddr_t *uc_addr)
 #endif /* RPL_LEAF_ONLY */
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_STORING
+#if RPL_DAO_AGGREGATION
 static void
-dao_input_storing(void)
+dao_aggr_timeout(void *ptr)
 {
-#if RPL_WITH_STORING
-  uip_ipaddr_t dao_sender_addr;
-  rpl_dag_t *dag;
-  rpl_instance_t *instance;
-  unsigned char *buffer;
-  uint16_t sequence;
-  uint8_t instance_id;
-  uint8_t lifetime;
-  uint8_t prefixlen;
-  uint8_t flags;
-  uint8_t subopt_type;
-  /*
-    uint8_t pathcontrol;
-    uint8_t pathsequence;
-  */
-  uip_ipaddr_t prefix;
-  uip_ds6_route_t *rep;
-  uint8_t buffer_length;
-  int pos;
-  int len;
+  dao_aggr_flush();
+}
+/*---------------------------------------------------------------------------*/
+/* Queue a target of a received DAO for the next aggregated DAO. */
+static void
+dao_aggr_add(rpl_instance_t *instance, uip_ipaddr_t *prefix,
+             uint8_t prefixlen, uint8_t lifetime, uint8_t sequence,
+             uip_ds6_route_t *rep)
+{
+  struct dao_aggr_target *t;
   int i;
-  int learned_from;
-  rpl_parent_t *parent;
-  uip_ds6_nbr_t *nbr;
-  int is_root;
-
-  prefixlen = 0;
-  parent = NULL;
-  memset(&prefix, 0, sizeof(prefix));
 
-  uip_ipaddr_copy(&dao_sender_addr, &UIP_IP_BUF->srcipaddr);
-
-  buffer = UIP_ICMP_PAYLOAD;
-  buffer_length = uip_len - uip_l3_icmp_hdr_len;
-
-  pos = 0;
-  instance_id = buffer[pos++];
-
-  instance = rpl_get_instance(instance_id);
-
-  lifetime = instance->default_lifetime;
-
-  flags = buffer[pos++];
-  /* reserved */
-  pos++;
-  sequence = buffer[pos++];
-
-  dag = instance->current_dag;
-  is_root = (dag->rank == ROOT_RANK(instance));
-
-  /* Is the DAG ID present? */
-  if(flags & RPL_DAO_D_FLAG) {
-    if(memcmp(&dag->dag_id, &buffer[pos], sizeof(dag->dag_id))) {
-      LOG_INFO("Ignoring a DAO for a DAG different from ours\n");
-      return;
-    }
-    pos += 16;
+  if(rep != NULL) {
+    /* The outgoing sequence number is set when the DAO is sent */
+    rep->state.dao_seqno_in = sequence;
+    RPL_ROUTE_SET_DAO_PENDING(rep);
   }
 
-  learned_from = uip_is_addr_mcast(&dao_sender_addr) ?
-    RPL_ROUTE_FROM_MULTICAST_DAO : RPL_ROUTE_FROM_UNICAST_DAO;
-
-  /* Destination Advertisement Object */
-  LOG_DBG("Received a (%s) DAO with sequence number %u from ",
-         learned_from == RPL_ROUTE_FROM_UNICAST_DAO? "unicast": "multicast", sequence);
-  LOG_DBG_6ADDR(&dao_sender_addr);
-  LOG_DBG_("\n");
-
-  if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
-    /* Check whether this is a DAO forwarding loop. */
-    parent = rpl_find_parent(dag, &dao_sender_addr);
-    /* check if this is a new DAO registration with an "illegal" rank */
-    /* if we already route to this node it is likely */
-    if(parent != NULL &&
-       DAG_RANK(parent->rank, instance) < DAG_RANK(dag->rank, instance)) {
-      LOG_WARN("Loop detected when receiving a unicast DAO from a node with a lower rank! (%u < %u)\n",
-             DAG_RANK(parent->rank, instance), DAG_RANK(dag->rank, instance));
-      parent->rank = RPL_INFINITE_RANK;
-      parent->flags |= RPL_PARENT_FLAG_UPDATED;
+  for(i = 0; i < dao_aggr_count; i++) {
+    t = &dao_aggr_targets[i];
+    if(t->instance == instance && t->prefixlen == prefixlen &&
+       uip_ipaddr_cmp(&t->prefix, prefix)) {
+      /* Already queued, e.g., a retransmission from the child */
+      t->lifetime = lifetime;
       return;
     }
+  }
 
-    /* If we get the DAO from our parent, we also have a loop. */
-    if(parent != NULL && parent == dag->preferred_parent) {
-      LOG_WARN("Loop detected when receiving a unicast DAO from our parent\n");
-      parent->rank = RPL_INFINITE_RANK;
-      parent->flags |= RPL_PARENT_FLAG_UPDATED;
-      return;
+  if(dao_aggr_count >= DAO_AGGR_QUEUE_LEN) {
+    LOG_WARN("DAO aggregation queue full, dropping target ");
+    LOG_WARN_6ADDR(prefix);
+    LOG_WARN_("\n");
+    if(rep != NULL) {
+      RPL_ROUTE_CLEAR_DAO_PENDING(rep);
     }
+    return;
   }
 
-  /* Check if there are any RPL options present. */
-  for(i = pos; i < buffer_length; i += len) {
-    subopt_type = buffer[i];
-    if(subopt_type == RPL_OPTION_PAD1) {
-      len = 1;
-    } else {
-      /* The option consists of a two-byte header and a payload. */
-      len = 2 + buffer[i + 1];
-    }
+  t = &dao_aggr_targets[dao_aggr_count++];
+  t->instance = instance;
+  uip_ipaddr_copy(&t->prefix, prefix);
+  t->prefixlen = prefixlen;
+  t->lifetime = lifetime;
 
-    switch(subopt_type) {
-      case RPL_OPTION_TARGET:
-        /* Handle the target option. */
-        prefixlen = buffer[i + 3];
-        if(prefixlen == 0) {
-          /* Ignore option targets with a prefix length of 0. */
-          break;
-        }
-        if(prefixlen > 128) {
-          LOG_ERR("Too large target prefix length %d\n", prefixlen);
-          return;
-        }
-        if(i + 4 + ((prefixlen + 7) / CHAR_BIT) > buffer_length) {
-          LOG_ERR("Insufficient space to copy RPL Target of %d bits\n",
-                  prefixlen);
-          return;
-        }
-        memset(&prefix, 0, sizeof(prefix));
-        memcpy(&prefix, buffer + i + 4, (prefixlen + 7) / CHAR_BIT);
-        break;
-      case RPL_OPTION_TRANSIT:
-        /* The path sequence and control are ignored. */
-        /*      pathcontrol = buffer[i + 3];
-                pathsequence = buffer[i + 4];*/
-        lifetime = buffer[i + 5];
-        /* The parent address is also ignored. */
-        break;
-    }
+  if(dao_aggr_count == 1) {
+    ctimer_set(&dao_aggr_timer, RPL_DAO_AGGREGATION_DELAY,
+               dao_aggr_timeout, NULL);
   }
+}
+#endif /* RPL_DAO_AGGREGATION */
+/*---------------------------------------------------------------------------*/
+/* Handle a single target of a DAO received in storing mode. Returns the
+   DAO-ACK status to report to the sender for this target, or DAO_ACK_NONE
+   if no DAO-ACK is to be sent (yet). */
+static int
+dao_input_storing_target(rpl_instance_t *instance,
+                         uip_ipaddr_t *dao_sender_addr, uint8_t flags,
+                         uint8_t sequence, int learned_from,
+                         uip_ipaddr_t *prefix, uint8_t prefixlen,
+                         uint8_t lifetime, uint8_t buffer_length)
+{
+  rpl_dag_t *dag;
+  uip_ds6_route_t *rep;
+  uip_ds6_nbr_t *nbr;
+  int is_root;
+#if !RPL_DAO_AGGREGATION
+  unsigned char *buffer;
+#endif /* !RPL_DAO_AGGREGATION */
+
+  dag = instance->current_dag;
+  is_root = (dag->rank == ROOT_RANK(instance));
 
   LOG_INFO("DAO lifetime: %u, prefix length: %u prefix: ",
          (unsigned)lifetime, (unsigned)prefixlen);
-  LOG_INFO_6ADDR(&prefix);
+  LOG_INFO_6ADDR(prefix);
   LOG_INFO_("\n");
 
 #if RPL_WITH_MULTICAST
-  if(uip_is_addr_mcast_global(&prefix)) {
+  if(uip_is_addr_mcast_global(prefix)) {
     /*
      * "rep" is used for a unicast route which we don't need now; so set NULL so
      * that operations on "rep" will be skipped.
      */
     rep = NULL;
-    mcast_group = uip_mcast6_route_add(&prefix);
+    mcast_group = uip_mcast6_route_add(prefix);
     if(mcast_group) {
       mcast_group->dag = dag;
       mcast_group->lifetime = RPL_LIFETIME(instance, lifetime);
@@ -791,7 +756,7 @@ dao_input_storing(void)
   }
 #endif
 
-  rep = uip_ds6_route_lookup(&prefix);
+  rep = uip_ds6_route_lookup(prefix);
 
   if(lifetime == RPL_ZERO_LIFETIME) {
     LOG_INFO("No-Path DAO received\n");
@@ -800,9 +765,9 @@ dao_input_storing(void)
        !RPL_ROUTE_IS_NOPATH_RECEIVED(rep) &&
        rep->length == prefixlen &&
        uip_ds6_route_nexthop(rep) != NULL &&
-       uip_ipaddr_cmp(uip_ds6_route_nexthop(rep), &dao_sender_addr)) {
+       uip_ipaddr_cmp(uip_ds6_route_nexthop(rep), dao_sender_addr)) {
       LOG_DBG("Setting expiration timer for prefix ");
-      LOG_DBG_6ADDR(&prefix);
+      LOG_DBG_6ADDR(prefix);
       LOG_DBG_("\n");
       RPL_ROUTE_SET_NOPATH_RECEIVED(rep);
       rep->state.lifetime = RPL_NOPATH_REMOVAL_DELAY;
@@ -811,6 +776,9 @@ dao_input_storing(void)
          one. */
       if(dag->preferred_parent != NULL &&
          rpl_parent_get_ipaddr(dag->preferred_parent) != NULL) {
+#if RPL_DAO_AGGREGATION
+        dao_aggr_add(instance, prefix, prefixlen, lifetime, sequence, rep);
+#else /* RPL_DAO_AGGREGATION */
         uint8_t out_seq;
         out_seq = prepare_for_dao_fwd(sequence, rep);
 
@@ -823,47 +791,44 @@ dao_input_storing(void)
         buffer[3] = out_seq; /* add an outgoing seq no before fwd */
         uip_icmp6_send(rpl_parent_get_ipaddr(dag->preferred_parent),
                        ICMP6_RPL, RPL_CODE_DAO, buffer_length);
+#endif /* RPL_DAO_AGGREGATION */
       }
     }
     /* independent if we remove or not - ACK the request */
     if(flags & RPL_DAO_K_FLAG) {
       /* indicate that we accepted the no-path DAO */
-      uipbuf_clear();
-      dao_ack_output(instance, &dao_sender_addr, sequence,
-                     RPL_DAO_ACK_UNCONDITIONAL_ACCEPT);
+      return RPL_DAO_ACK_UNCONDITIONAL_ACCEPT;
     }
-    return;
+    return DAO_ACK_NONE;
   }
 
   LOG_INFO("Adding DAO route\n");
 
   /* Update and add neighbor - if no room - fail. */
-  if((nbr = rpl_icmp6_update_nbr_table(&dao_sender_addr, NBR_TABLE_REASON_RPL_DAO, instance)) == NULL) {
+  if((nbr = rpl_icmp6_update_nbr_table(dao_sender_addr, NBR_TABLE_REASON_RPL_DAO, instance)) == NULL) {
     LOG_ERR("Out of Memory, dropping DAO from ");
-    LOG_ERR_6ADDR(&dao_sender_addr);
+    LOG_ERR_6ADDR(dao_sender_addr);
     LOG_ERR_(", ");
     LOG_ERR_LLADDR(packetbuf_addr(PACKETBUF_ADDR_SENDER));
     LOG_ERR_("\n");
     if(flags & RPL_DAO_K_FLAG) {
       /* signal the failure to add the node */
-      dao_ack_output(instance, &dao_sender_addr, sequence,
-                     is_root ? RPL_DAO_ACK_UNABLE_TO_ADD_ROUTE_AT_ROOT :
-                     RPL_DAO_ACK_UNABLE_TO_ACCEPT);
+      return is_root ? RPL_DAO_ACK_UNABLE_TO_ADD_ROUTE_AT_ROOT :
+        RPL_DAO_ACK_UNABLE_TO_ACCEPT;
     }
-    return;
+    return DAO_ACK_NONE;
   }
 
-  rep = rpl_add_route(dag, &prefix, prefixlen, &dao_sender_addr);
+  rep = rpl_add_route(dag, prefix, prefixlen, dao_sender_addr);
   if(rep == NULL) {
     RPL_STAT(rpl_stats.mem_overflows++);
     LOG_ERR("Could not add a route after receiving a DAO\n");
     if(flags & RPL_DAO_K_FLAG) {
       /* signal the failure to add the node */
-      dao_ack_output(instance, &dao_sender_addr, sequence,
-                     is_root ? RPL_DAO_ACK_UNABLE_TO_ADD_ROUTE_AT_ROOT :
-                     RPL_DAO_ACK_UNABLE_TO_ACCEPT);
+      return is_root ? RPL_DAO_ACK_UNABLE_TO_ADD_ROUTE_AT_ROOT :
+        RPL_DAO_ACK_UNABLE_TO_ACCEPT;
     }
-    return;
+    return DAO_ACK_NONE;
   }
 
   /* set lifetime and clear NOPATH bit */
@@ -895,6 +860,9 @@ fwd_dao:
 
     if(dag->preferred_parent != NULL &&
        rpl_parent_get_ipaddr(dag->preferred_parent) != NULL) {
+#if RPL_DAO_AGGREGATION
+      dao_aggr_add(instance, prefix, prefixlen, lifetime, sequence, rep);
+#else /* RPL_DAO_AGGREGATION */
       uint8_t out_seq = 0;
       if(rep != NULL) {
         /* if this is pending and we get the same seq no it is a retrans */
@@ -915,14 +883,223 @@ fwd_dao:
       buffer[3] = out_seq; /* add an outgoing seq no before fwd */
       uip_icmp6_send(rpl_parent_get_ipaddr(dag->preferred_parent),
                      ICMP6_RPL, RPL_CODE_DAO, buffer_length);
+#endif /* RPL_DAO_AGGREGATION */
     }
     if(should_ack) {
-      LOG_DBG("Sending DAO ACK\n");
-      uipbuf_clear();
-      dao_ack_output(instance, &dao_sender_addr, sequence,
-                     RPL_DAO_ACK_UNCONDITIONAL_ACCEPT);
+      return RPL_DAO_ACK_UNCONDITIONAL_ACCEPT;
     }
   }
+  return DAO_ACK_NONE;
+}
+/*---------------------------------------------------------------------------*/
+#if RPL_DAO_AGGREGATION
+/* Combine the DAO-ACK status of one more target into the status of the
+   whole DAO: a refusal of any target wins, and the DAO is acknowledged
+   right away only if all of its targets are. */
+static int
+merge_dao_ack_status(int status, int target_status)
+{
+  if(status >= RPL_DAO_ACK_UNABLE_TO_ACCEPT) {
+    return status;
+  }
+  if(target_status >= RPL_DAO_ACK_UNABLE_TO_ACCEPT) {
+    return target_status;
+  }
+  if(status == DAO_ACK_NONE || target_status == DAO_ACK_NONE) {
+    return DAO_ACK_NONE;
+  }
+  return status;
+}
+#endif /* RPL_DAO_AGGREGATION */
+#endif /* RPL_WITH_STORING */
+/*---------------------------------------------------------------------------*/
+static void
+dao_input_storing(void)
+{
+#if RPL_WITH_STORING
+  uip_ipaddr_t dao_sender_addr;
+  rpl_dag_t *dag;
+  rpl_instance_t *instance;
+  unsigned char *buffer;
+  uint16_t sequence;
+  uint8_t instance_id;
+  uint8_t lifetime;
+  uint8_t prefixlen;
+  uint8_t flags;
+  uint8_t subopt_type;
+  /*
+    uint8_t pathcontrol;
+    uint8_t pathsequence;
+  */
+  uip_ipaddr_t prefix;
+  uint8_t buffer_length;
+  int pos;
+  int len;
+  int i;
+  int learned_from;
+  rpl_parent_t *parent;
+  int ack_status;
+#if RPL_DAO_AGGREGATION
+  int targets = 0;
+#endif /* RPL_DAO_AGGREGATION */
+
+  prefixlen = 0;
+  parent = NULL;
+  memset(&prefix, 0, sizeof(prefix));
+
+  uip_ipaddr_copy(&dao_sender_addr, &UIP_IP_BUF->srcipaddr);
+
+  buffer = UIP_ICMP_PAYLOAD;
+  buffer_length = uip_len - uip_l3_icmp_hdr_len;
+
+  pos = 0;
+  instance_id = buffer[pos++];
+
+  instance = rpl_get_instance(instance_id);
+
+  lifetime = instance->default_lifetime;
+
+  flags = buffer[pos++];
+  /* reserved */
+  pos++;
+  sequence = buffer[pos++];
+
+  dag = instance->current_dag;
+
+  /* Is the DAG ID present? */
+  if(flags & RPL_DAO_D_FLAG) {
+    if(memcmp(&dag->dag_id, &buffer[pos], sizeof(dag->dag_id))) {
+      LOG_INFO("Ignoring a DAO for a DAG different from ours\n");
+      return;
+    }
+    pos += 16;
+  }
+
+  learned_from = uip_is_addr_mcast(&dao_sender_addr) ?
+    RPL_ROUTE_FROM_MULTICAST_DAO : RPL_ROUTE_FROM_UNICAST_DAO;
+
+  /* Destination Advertisement Object */
+  LOG_DBG("Received a (%s) DAO with sequence number %u from ",
+         learned_from == RPL_ROUTE_FROM_UNICAST_DAO? "unicast": "multicast", sequence);
+  LOG_DBG_6ADDR(&dao_sender_addr);
+  LOG_DBG_("\n");
+
+  if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
+    /* Check whether this is a DAO forwarding loop. */
+    parent = rpl_find_parent(dag, &dao_sender_addr);
+    /* check if this is a new DAO registration with an "illegal" rank */
+    /* if we already route to this node it is likely */
+    if(parent != NULL &&
+       DAG_RANK(parent->rank, instance) < DAG_RANK(dag->rank, instance)) {
+      LOG_WARN("Loop detected when receiving a unicast DAO from a node with a lower rank! (%u < %u)\n",
+             DAG_RANK(parent->rank, instance), DAG_RANK(dag->rank, instance));
+      parent->rank = RPL_INFINITE_RANK;
+      parent->flags |= RPL_PARENT_FLAG_UPDATED;
+      return;
+    }
+
+    /* If we get the DAO from our parent, we also have a loop. */
+    if(parent != NULL && parent == dag->preferred_parent) {
+      LOG_WARN("Loop detected when receiving a unicast DAO from our parent\n");
+      parent->rank = RPL_INFINITE_RANK;
+      parent->flags |= RPL_PARENT_FLAG_UPDATED;
+      return;
+    }
+  }
+
+#if RPL_DAO_AGGREGATION
+  ack_status = RPL_DAO_ACK_UNCONDITIONAL_ACCEPT;
+#endif /* RPL_DAO_AGGREGATION */
+
+  /* Check if there are any RPL options present. */
+  for(i = pos; i < buffer_length; i += len) {
+    subopt_type = buffer[i];
+    if(subopt_type == RPL_OPTION_PAD1) {
+      len = 1;
+    } else {
+      /* The option consists of a two-byte header and a payload. */
+      len = 2 + buffer[i + 1];
+    }
+
+    switch(subopt_type) {
+      case RPL_OPTION_TARGET:
+#if RPL_DAO_AGGREGATION
+        if(prefixlen > 0) {
+          /* The previous target had no transit information of its own */
+          ack_status = merge_dao_ack_status(ack_status,
+            dao_input_storing_target(instance, &dao_sender_addr, flags,
+                                     sequence, learned_from, &prefix,
+                                     prefixlen, lifetime, buffer_length));
+          targets++;
+        }
+#endif /* RPL_DAO_AGGREGATION */
+        /* Handle the target option. */
+        prefixlen = buffer[i + 3];
+        if(prefixlen == 0) {
+          /* Ignore option targets with a prefix length of 0. */
+          break;
+        }
+        if(prefixlen > 128) {
+          LOG_ERR("Too large target prefix length %d\n", prefixlen);
+          return;
+        }
+        if(i + 4 + ((prefixlen + 7) / CHAR_BIT) > buffer_length) {
+          LOG_ERR("Insufficient space to copy RPL Target of %d bits\n",
+                  prefixlen);
+          return;
+        }
+        memset(&prefix, 0, sizeof(prefix));
+        memcpy(&prefix, buffer + i + 4, (prefixlen + 7) / CHAR_BIT);
+        break;
+      case RPL_OPTION_TRANSIT:
+        /* The path sequence and control are ignored. */
+        /*      pathcontrol = buffer[i + 3];
+                pathsequence = buffer[i + 4];*/
+        lifetime = buffer[i + 5];
+        /* The parent address is also ignored. */
+#if RPL_DAO_AGGREGATION
+        if(prefixlen > 0) {
+          ack_status = merge_dao_ack_status(ack_status,
+            dao_input_storing_target(instance, &dao_sender_addr, flags,
+                                     sequence, learned_from, &prefix,
+                                     prefixlen, lifetime, buffer_length));
+          targets++;
+          prefixlen = 0;
+        }
+#endif /* RPL_DAO_AGGREGATION */
+        break;
+    }
+  }
+
+#if RPL_DAO_AGGREGATION
+  if(prefixlen > 0) {
+    ack_status = merge_dao_ack_status(ack_status,
+      dao_input_storing_target(instance, &dao_sender_addr, flags,
+                               sequence, learned_from, &prefix,
+                               prefixlen, lifetime, buffer_length));
+    targets++;
+  }
+  if(targets == 0) {
+    ack_status = DAO_ACK_NONE;
+  }
+#else /* RPL_DAO_AGGREGATION */
+  ack_status = dao_input_storing_target(instance, &dao_sender_addr, flags,
+                                        sequence, learned_from, &prefix,
+                                        prefixlen, lifetime, buffer_length);
+#endif /* RPL_DAO_AGGREGATION */
+
+  if(ack_status != DAO_ACK_NONE) {
+    LOG_DBG("Sending DAO ACK\n");
+    uipbuf_clear();
+    dao_ack_output(instance, &dao_sender_addr, sequence, ack_status);
+  }
+
+#if RPL_DAO_AGGREGATION
+  /* uip_buf is free again, send right away if a DAO is full */
+  if(dao_aggr_count >= RPL_DAO_AGGREGATION_MAX_TARGETS) {
+    dao_aggr_flush();
+  }
+#endif /* RPL_DAO_AGGREGATION */
 #endif /* RPL_WITH_STORING */
 }
 /*---------------------------------------------------------------------------*/
@@ -1297,6 +1474,135 @@ dao_output_target_seq(rpl_parent_t *parent, uip_ipaddr_t *prefix,
   }
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_STORING && RPL_DAO_AGGREGATION
+/* Send the queued targets to the preferred parent, in as few DAOs as
+   possible. All routes announced in one DAO share its sequence number,
+   so that its DAO-ACK can be fanned out to their next hops. Targets of
+   an instance that has no preferred parent stay queued until it has. */
+static void
+dao_aggr_flush(void)
+{
+  rpl_instance_t *instance;
+  rpl_dag_t *dag;
+  rpl_parent_t *parent;
+  uip_ipaddr_t *parent_ipaddr;
+  uip_ds6_route_t *rep;
+  struct dao_aggr_target *t;
+  unsigned char *buffer;
+  uint8_t targets;
+  int ack_requested;
+  int pos;
+  int i;
+
+  ctimer_stop(&dao_aggr_timer);
+
+  for(;;) {
+    /* Find an instance with queued targets and a parent to send them to */
+    parent_ipaddr = NULL;
+    for(i = 0; i < dao_aggr_count;) {
+      instance = dao_aggr_targets[i].instance;
+      if(!instance->used) {
+        /* The instance is gone, and so are its routes */
+        dao_aggr_targets[i] = dao_aggr_targets[--dao_aggr_count];
+        continue;
+      }
+      dag = instance->current_dag;
+      parent = dag != NULL ? dag->preferred_parent : NULL;
+      parent_ipaddr = parent != NULL ? rpl_parent_get_ipaddr(parent) : NULL;
+      if(parent_ipaddr != NULL) {
+        break;
+      }
+      i++;
+    }
+    if(parent_ipaddr == NULL) {
+      break;
+    }
+
+    RPL_LOLLIPOP_INCREMENT(dao_sequence);
+
+    uipbuf_clear();
+    buffer = UIP_ICMP_PAYLOAD;
+    pos = 0;
+
+    buffer[pos++] = instance->instance_id;
+    buffer[pos] = 0;
+#if RPL_DAO_SPECIFY_DAG
+    buffer[pos] |= RPL_DAO_D_FLAG;
+#endif /* RPL_DAO_SPECIFY_DAG */
+    ++pos;
+    buffer[pos++] = 0; /* reserved */
+    buffer[pos++] = dao_sequence;
+#if RPL_DAO_SPECIFY_DAG
+    if(dag != NULL) {
+      memcpy(buffer + pos, &dag->dag_id, sizeof(dag->dag_id));
+    }
+    pos += sizeof(dag->dag_id);
+#endif /* RPL_DAO_SPECIFY_DAG */
+
+    targets = 0;
+    ack_requested = 0;
+    for(i = 0; i < dao_aggr_count;) {
+      t = &dao_aggr_targets[i];
+      if(t->instance != instance ||
+         targets >= RPL_DAO_AGGREGATION_MAX_TARGETS) {
+        i++;
+        continue;
+      }
+
+      rep = uip_ds6_route_lookup(&t->prefix);
+      if(rep != NULL && rep->length == t->prefixlen) {
+        rep->state.dao_seqno_out = dao_sequence;
+      }
+
+      /* Target option followed by its own transit information */
+      buffer[pos++] = RPL_OPTION_TARGET;
+      buffer[pos++] = 2 + ((t->prefixlen + 7) / CHAR_BIT);
+      buffer[pos++] = 0; /* reserved */
+      buffer[pos++] = t->prefixlen;
+      memcpy(buffer + pos, &t->prefix, (t->prefixlen + 7) / CHAR_BIT);
+      pos += ((t->prefixlen + 7) / CHAR_BIT);
+
+      buffer[pos++] = RPL_OPTION_TRANSIT;
+      buffer[pos++] = 4;
+      buffer[pos++] = 0; /* flags - ignored */
+      buffer[pos++] = 0; /* path control - ignored */
+      buffer[pos++] = 0; /* path seq - ignored */
+      buffer[pos++] = t->lifetime;
+
+      if(t->lifetime != RPL_ZERO_LIFETIME) {
+        ack_requested = 1;
+      }
+      targets++;
+
+      /* Remove the target from the queue, order does not matter */
+      *t = dao_aggr_targets[--dao_aggr_count];
+    }
+
+#if RPL_WITH_DAO_ACK
+    if(ack_requested) {
+      buffer[1] |= RPL_DAO_K_FLAG;
+    }
+#else /* RPL_WITH_DAO_ACK */
+    (void)ack_requested;
+#endif /* RPL_WITH_DAO_ACK */
+
+    LOG_INFO("Sending an aggregated DAO with sequence number %u, %u targets, to ",
+             dao_sequence, targets);
+    LOG_INFO_6ADDR(parent_ipaddr);
+    LOG_INFO_("\n");
+
+    uip_icmp6_send(parent_ipaddr, ICMP6_RPL, RPL_CODE_DAO, pos);
+  }
+
+  if(dao_aggr_count > 0) {
+    LOG_WARN("No parent to send %u aggregated DAO targets to, retrying\n",
+             dao_aggr_count);
+    ctimer_set(&dao_aggr_timer, RPL_DAO_AGGREGATION_DELAY,
+               dao_aggr_timeout, NULL);
+  }
+}
+#endif /* RPL_WITH_STORING && RPL_DAO_AGGREGATION */
+/*---------------------------------------------------------------------------*/
 static void
 dao_ack_input(void)
 {
@@ -1366,6 +1672,57 @@ dao_ack_input(void)
 #endif
 
   } else if(RPL_IS_STORING(instance)) {
+#if RPL_DAO_AGGREGATION
+    /* this DAO ACK covers the targets of an aggregated DAO: forward it to
+       each child that registered one of them, once per child DAO */
+    uip_ds6_route_t *re;
+    uip_ds6_route_t *next;
+    const uip_ipaddr_t *nexthop;
+    uip_ipaddr_t acked_addr[RPL_DAO_AGGREGATION_MAX_TARGETS];
+    uint8_t acked_seqno[RPL_DAO_AGGREGATION_MAX_TARGETS];
+    uint8_t acked = 0;
+    uint8_t j;
+
+    for(re = uip_ds6_route_head(); re != NULL; re = next) {
+      next = uip_ds6_route_next(re);
+      if(re->state.dao_seqno_out != sequence || !RPL_ROUTE_IS_DAO_PENDING(re)) {
+        continue;
+      }
+      RPL_ROUTE_CLEAR_DAO_PENDING(re);
+
+      nexthop = uip_ds6_route_nexthop(re);
+      if(nexthop == NULL) {
+        LOG_WARN("No next hop to fwd DAO ACK to\n");
+      } else {
+        for(j = 0; j < acked; j++) {
+          if(acked_seqno[j] == re->state.dao_seqno_in &&
+             uip_ipaddr_cmp(&acked_addr[j], nexthop)) {
+            break;
+          }
+        }
+        if(j == acked) {
+          LOG_INFO("Fwd DAO ACK to:");
+          LOG_INFO_6ADDR(nexthop);
+          LOG_INFO_("\n");
+          if(acked < RPL_DAO_AGGREGATION_MAX_TARGETS) {
+            uip_ipaddr_copy(&acked_addr[acked], nexthop);
+            acked_seqno[acked++] = re->state.dao_seqno_in;
+          }
+          uipbuf_clear();
+          dao_ack_output(instance, (uip_ipaddr_t *)nexthop,
+                         re->state.dao_seqno_in, status);
+        }
+      }
+
+      if(status >= RPL_DAO_ACK_UNABLE_TO_ACCEPT) {
+        /* this node did not get in to the routing tables above... - remove */
+        uip_ds6_route_rm(re);
+      }
+    }
+    if(acked == 0) {
+      LOG_WARN("No route entry found to forward DAO ACK (seqno %u)\n", sequence);
+    }
+#else /* RPL_DAO_AGGREGATION */
     /* this DAO ACK should be forwarded to another recently registered route */
     uip_ds6_route_t *re;
     const uip_ipaddr_t *nexthop;
@@ -1392,6 +1749,7 @@ dao_ack_input(void)
     } else {
       LOG_WARN("No route entry found to forward DAO ACK (seqno %u)\n", sequence);
     }
+#endif /* RPL_DAO_AGGREGATION */
   }
 #endif /* RPL_WITH_DAO_ACK */
   uipbuf_clear();
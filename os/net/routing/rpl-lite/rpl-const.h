@@ -89,6 +89,8 @@
 /* IANA Objective Code Point as defined in RFC6550 */
 #define RPL_OCP_OF0     0
 #define RPL_OCP_MRHOF   1
+/* Not IANA-assigned: schedule capacity aware OF of the MSF service */
+#define RPL_OCP_MSF_CAPACITY 0xff01
 
 /*---------------------------------------------------------------------------*/
 /* RPL message types */
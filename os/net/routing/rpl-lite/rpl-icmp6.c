@@ -250,6 +250,12 @@ dio_input(void)
         } else if(dio.mc.type == RPL_DAG_MC_ENERGY) {
           dio.mc.obj.energy.flags = buffer[i + 6];
           dio.mc.obj.energy.energy_est = buffer[i + 7];
+        } else if(dio.mc.type == RPL_DAG_MC_THROUGHPUT) {
+          if(len < 10) {
+            LOG_WARN("dio_input: invalid DAG MC throughput, len %u, discard\n", len);
+            goto discard;
+          }
+          dio.mc.obj.throughput = get32(buffer, i + 6);
         } else {
           LOG_WARN("dio_input: unsupported DAG MC type %u, discard\n", (unsigned)dio.mc.type);
           goto discard;
@@ -382,7 +388,7 @@ rpl_icmp6_dio_output(uip_ipaddr_t *uc_addr)
   if(!rpl_get_leaf_only()) {
     if(curr_instance.mc.type != RPL_DAG_MC_NONE) {
       buffer[pos++] = RPL_OPTION_DAG_METRIC_CONTAINER;
-      buffer[pos++] = 6;
+      buffer[pos++] = curr_instance.mc.type == RPL_DAG_MC_THROUGHPUT ? 8 : 6;
       buffer[pos++] = curr_instance.mc.type;
       buffer[pos++] = curr_instance.mc.flags >> 1;
       buffer[pos] = (curr_instance.mc.flags & 1) << 7;
@@ -395,6 +401,10 @@ rpl_icmp6_dio_output(uip_ipaddr_t *uc_addr)
         buffer[pos++] = 2;
         buffer[pos++] = curr_instance.mc.obj.energy.flags;
         buffer[pos++] = curr_instance.mc.obj.energy.energy_est;
+      } else if(curr_instance.mc.type == RPL_DAG_MC_THROUGHPUT) {
+        buffer[pos++] = 4;
+        set32(buffer, pos, curr_instance.mc.obj.throughput);
+        pos += 4;
       } else {
         LOG_ERR("unable to send DIO because of unsupported DAG MC type %u\n",
                (unsigned)curr_instance.mc.type);
@@ -119,6 +119,7 @@ struct rpl_metric_container {
   union metric_object {
    struct rpl_metric_object_energy energy;
    uint16_t etx;
+   uint32_t throughput;
   } obj;
 };
 typedef struct rpl_metric_container rpl_metric_container_t;
@@ -47,6 +47,7 @@
 #include "lwm2m-device.h"
 #include "lwm2m-plain-text.h"
 #include "lwm2m-json.h"
+#include "lwm2m-senml-cbor.h"
 #include "coap-constants.h"
 #include "coap-engine.h"
 #include "lwm2m-tlv.h"
@@ -98,6 +99,8 @@
 #endif /* LWM2M_QUEUE_MODE_OBJECT_ENABLED */
 #endif /* LWM2M_QUEUE_MODE_ENABLED */
 
+#include "lwm2m-tsch-object.h"
+
 /* MACRO for getting out resource ID from resource array ID + flags */
 #define RSC_ID(x)       ((uint16_t)(x & 0xffff))
 #define RSC_READABLE(x) ((x & LWM2M_RESOURCE_READ) > 0)
@@ -285,7 +288,7 @@ get_method_as_string(coap_resource_flags_t method)
 static const char *
 get_status_as_string(lwm2m_status_t status)
 {
-  static char buffer[8];
+  static char buffer[13];
   switch(status) {
   case LWM2M_STATUS_OK:
     return "OK";
@@ -314,7 +317,7 @@ get_status_as_string(lwm2m_status_t status)
   case LWM2M_STATUS_SERVICE_UNAVAILABLE:
     return "SERVICE UNAVAILABLE";
   default:
-    snprintf(buffer, sizeof(buffer) - 1, "<%u>", status);
+    snprintf(buffer, sizeof(buffer), "<%u>", status);
     return buffer;
   }
 }
@@ -571,6 +574,10 @@ lwm2m_engine_init(void)
 #if LWM2M_QUEUE_MODE_ENABLED && LWM2M_QUEUE_MODE_OBJECT_ENABLED
   lwm2m_queue_mode_object_init();
 #endif
+
+#if LWM2M_TSCH_OBJECT_ENABLED && MAC_CONF_WITH_TSCH
+  lwm2m_tsch_object_init();
+#endif
 }
 /*---------------------------------------------------------------------------*/
 /*
@@ -598,6 +605,9 @@ lwm2m_engine_select_writer(lwm2m_context_t *context, unsigned int accept)
     case APPLICATION_JSON:
       context->writer = &lwm2m_json_writer;
       break;
+    case LWM2M_SENML_CBOR:
+      context->writer = &lwm2m_senml_cbor_writer;
+      break;
     default:
       LOG_WARN("Unknown Accept type %u, using LWM2M plain text\n", accept);
       context->writer = &lwm2m_plain_text_writer;
@@ -1653,6 +1663,58 @@ lwm2m_queue_mode_request_received();
   return COAP_HANDLER_STATUS_PROCESSED;
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * Append the readable resources of ctx->object_id/ctx->object_instance_id
+ * (all of them for level 2, ctx->resource_id only for level 3) to
+ * ctx->outbuf with ctx->writer. The writer framing (init_write/end_write)
+ * is left to the caller so that several paths can share one payload.
+ *
+ * Returns LWM2M_STATUS_ERROR when a record did not fit in the buffer.
+ */
+lwm2m_status_t
+lwm2m_engine_read_records(lwm2m_context_t *ctx)
+{
+  lwm2m_object_instance_t *instance;
+  lwm2m_status_t status = LWM2M_STATUS_OK;
+  uint16_t len;
+  uint8_t lv;
+  int i;
+
+  instance = get_instance(ctx->object_id, ctx->object_instance_id, NULL);
+  if(instance == NULL || instance->callback == NULL) {
+    return LWM2M_STATUS_NOT_FOUND;
+  }
+
+  lv = ctx->level;
+  ctx->operation = LWM2M_OP_READ;
+  current_opaque_callback = NULL;
+  for(i = 0; i < instance->resource_count; i++) {
+    if(!RSC_READABLE(instance->resource_ids[i]) ||
+       (lv == 3 && RSC_ID(instance->resource_ids[i]) != ctx->resource_id)) {
+      continue;
+    }
+    ctx->resource_id = RSC_ID(instance->resource_ids[i]);
+    ctx->level = 3;
+    len = ctx->outbuf->len;
+    status = instance->callback(instance, ctx);
+    if(current_opaque_callback != NULL) {
+      /* Opaque streams need block transfers - not part of a record batch */
+      current_opaque_callback = NULL;
+      status = LWM2M_STATUS_ERROR;
+    } else if(status == LWM2M_STATUS_OK && ctx->outbuf->len == len) {
+      /* The writers output nothing when the record does not fit */
+      status = LWM2M_STATUS_ERROR;
+    } else if(status == LWM2M_STATUS_NOT_FOUND && lv < 3) {
+      status = LWM2M_STATUS_OK;
+    }
+    if(status != LWM2M_STATUS_OK) {
+      break;
+    }
+  }
+  ctx->level = lv;
+  return status;
+}
+/*---------------------------------------------------------------------------*/
 static void
 lwm2m_send_notification(char* path)
 {
@@ -58,7 +58,8 @@ typedef enum {
   LWM2M_JSON       = 11543,
   LWM2M_OLD_TLV    = 1542,
   LWM2M_OLD_JSON   = 1543,
-  LWM2M_OLD_OPAQUE  = 1544
+  LWM2M_OLD_OPAQUE  = 1544,
+  LWM2M_SENML_CBOR = 112
 } lwm2m_content_format_t;
 
 void lwm2m_engine_init(void);
@@ -114,6 +115,8 @@ void lwm2m_engine_remove_generic_object(lwm2m_object_t *object);
 void lwm2m_notify_object_observers(lwm2m_object_instance_t *obj,
                                    uint16_t resource);
 
+lwm2m_status_t lwm2m_engine_read_records(lwm2m_context_t *ctx);
+
 void lwm2m_engine_set_opaque_callback(lwm2m_context_t *ctx, lwm2m_write_opaque_callback cb);
 
 #endif /* LWM2M_ENGINE_H */
@@ -47,7 +47,12 @@
 
 #include "lwm2m-queue-mode.h"
 #include "lwm2m-engine.h"
+#include "lwm2m-rd-client.h"
 #include "coap-engine.h"
+#if LWM2M_QUEUE_MODE_BATCH_REPORT
+#include "lwm2m-senml-cbor.h"
+#include "coap-callback-api.h"
+#endif
 #include "lib/memb.h"
 #include "lib/list.h"
 #include <string.h>
@@ -99,7 +104,11 @@ is_notification_path_present(uint16_t object_id, uint16_t instance_id, uint16_t
   notification_path_t *iteration_path = (notification_path_t *)list_head(notification_paths_queue);
   while(iteration_path != NULL) {
     if(iteration_path->reduced_path[0] == object_id && iteration_path->reduced_path[1] == instance_id
-       && iteration_path->reduced_path[2] == resource_id) {
+       && (iteration_path->level == 2 || iteration_path->reduced_path[2] == resource_id)) {
+#if LWM2M_QUEUE_MODE_BATCH_REPORT
+      /* The report in flight has an older value, keep the path queued */
+      iteration_path->reported = 0;
+#endif /* LWM2M_QUEUE_MODE_BATCH_REPORT */
       return 1;
     }
     iteration_path = iteration_path->next;
@@ -114,6 +123,36 @@ remove_notification_path(notification_path_t *path)
   memb_free(&notification_memb, path);
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * The queue is full: fold the new change and the queued changes of the
+ * same object instance into one instance level path. Returns 1 if the
+ * change is covered after that.
+ */
+static int
+aggregate_notification_path(uint16_t object_id, uint16_t instance_id)
+{
+  notification_path_t *instance_path = NULL;
+  notification_path_t *iteration_path = (notification_path_t *)list_head(notification_paths_queue);
+  notification_path_t *aux;
+
+  while(iteration_path != NULL) {
+    aux = iteration_path;
+    iteration_path = iteration_path->next;
+    if(aux->reduced_path[0] == object_id && aux->reduced_path[1] == instance_id) {
+      if(instance_path == NULL) {
+        instance_path = aux;
+        instance_path->level = 2;
+#if LWM2M_QUEUE_MODE_BATCH_REPORT
+        instance_path->reported = 0;
+#endif /* LWM2M_QUEUE_MODE_BATCH_REPORT */
+      } else {
+        remove_notification_path(aux);
+      }
+    }
+  }
+  return instance_path != NULL;
+}
+/*---------------------------------------------------------------------------*/
 void
 lwm2m_notification_queue_add_notification_path(uint16_t object_id, uint16_t instance_id, uint16_t resource_id)
 {
@@ -123,13 +162,20 @@ lwm2m_notification_queue_add_notification_path(uint16_t object_id, uint16_t inst
   }
   notification_path_t *path_object = memb_alloc(&notification_memb);
   if(path_object == NULL) {
-    LOG_DBG("Queue is full, could not allocate new notification\n");
+    if(aggregate_notification_path(object_id, instance_id)) {
+      LOG_DBG("Queue is full, aggregated notification into %u/%u\n", object_id, instance_id);
+    } else {
+      LOG_DBG("Queue is full, could not allocate new notification\n");
+    }
     return;
   }
   path_object->reduced_path[0] = object_id;
   path_object->reduced_path[1] = instance_id;
   path_object->reduced_path[2] = resource_id;
   path_object->level = 3;
+#if LWM2M_QUEUE_MODE_BATCH_REPORT
+  path_object->reported = 0;
+#endif /* LWM2M_QUEUE_MODE_BATCH_REPORT */
   list_add(notification_paths_queue, path_object);
   LOG_DBG("Notification path added to the list: %u/%u/%u\n", object_id, instance_id, resource_id);
 }
@@ -155,5 +201,142 @@ lwm2m_notification_queue_send_notifications()
     remove_notification_path(aux);
   }
 }
+#if LWM2M_QUEUE_MODE_BATCH_REPORT
+/*---------------------------------------------------------------------------*/
+static coap_message_t report_request[1];
+static coap_callback_request_state_t report_state;
+static uint8_t report_buffer[LWM2M_QUEUE_MODE_BATCH_REPORT_SIZE];
+static uint8_t report_pending;
+static uint8_t report_acked;
+/*---------------------------------------------------------------------------*/
+static void
+report_callback(coap_callback_request_state_t *callback_state)
+{
+  coap_request_state_t *state = &callback_state->state;
+  notification_path_t *iteration_path;
+  notification_path_t *aux;
+
+  if(state->status == COAP_REQUEST_STATUS_RESPONSE ||
+     state->status == COAP_REQUEST_STATUS_MORE) {
+    LOG_DBG("Batched report response: %d\n", state->response->code);
+    report_acked = state->response->code >= CREATED_2_01 &&
+      state->response->code <= CONTENT_2_05;
+    return;
+  }
+
+  LOG_DBG("Batched report done. Status: %d\n", state->status);
+  report_pending = 0;
+
+  iteration_path = (notification_path_t *)list_head(notification_paths_queue);
+  while(iteration_path != NULL) {
+    aux = iteration_path;
+    iteration_path = iteration_path->next;
+    if(!aux->reported) {
+      continue;
+    }
+    if(state->status == COAP_REQUEST_STATUS_FINISHED && report_acked) {
+      remove_notification_path(aux);
+    } else {
+      aux->reported = 0;
+    }
+  }
+
+  if(state->status != COAP_REQUEST_STATUS_FINISHED || !report_acked) {
+    LOG_DBG("Batched report failed, falling back to notifications\n");
+  }
+
+  /* Changes queued while the report was in flight, or not delivered by
+     it, are sent now if the client is awake, else at the next wake-up */
+  if(lwm2m_rd_client_is_client_awake()) {
+    lwm2m_notification_queue_send_notifications();
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Render every queued path into one SenML-CBOR payload */
+static int
+build_report(lwm2m_buffer_t *outbuf)
+{
+  lwm2m_context_t ctx;
+  notification_path_t *iteration_path;
+
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.outbuf = outbuf;
+  ctx.writer = &lwm2m_senml_cbor_writer;
+  ctx.content_type = LWM2M_SENML_CBOR;
+
+  outbuf->len += ctx.writer->init_write(&ctx);
+  for(iteration_path = (notification_path_t *)list_head(notification_paths_queue);
+      iteration_path != NULL;
+      iteration_path = iteration_path->next) {
+    ctx.object_id = iteration_path->reduced_path[0];
+    ctx.object_instance_id = iteration_path->reduced_path[1];
+    ctx.resource_id = iteration_path->reduced_path[2];
+    ctx.level = iteration_path->level;
+    /* Each path starts a new base name */
+    ctx.writer_flags &= ~WRITER_OUTPUT_VALUE;
+    if(lwm2m_engine_read_records(&ctx) != LWM2M_STATUS_OK) {
+      return 0;
+    }
+  }
+  if(ctx.writer->end_write(&ctx) == 0) {
+    return 0;
+  }
+  outbuf->len++;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+lwm2m_notification_queue_send_report(coap_endpoint_t *server_ep)
+{
+  lwm2m_buffer_t outbuf;
+  notification_path_t *iteration_path;
+
+  if(list_head(notification_paths_queue) == NULL) {
+    return;
+  }
+
+  if(report_pending) {
+    /* The queue is flushed when the report in flight completes */
+    LOG_DBG("Batched report in flight, keeping the notifications queued\n");
+    return;
+  }
+
+  outbuf.buffer = report_buffer;
+  outbuf.size = sizeof(report_buffer);
+  outbuf.len = 0;
+  outbuf.pos = 0;
+
+  if(!build_report(&outbuf)) {
+    LOG_DBG("Batched report not possible, sending notifications\n");
+    lwm2m_notification_queue_send_notifications();
+    return;
+  }
+
+  coap_init_message(report_request, COAP_TYPE_CON, COAP_POST, 0);
+  coap_set_header_uri_path(report_request, "/dp");
+  coap_set_header_content_format(report_request, LWM2M_SENML_CBOR);
+  coap_set_payload(report_request, report_buffer, outbuf.len);
+  if(!coap_send_request(&report_state, server_ep, report_request, report_callback)) {
+    LOG_DBG("Could not send batched report, sending notifications\n");
+    lwm2m_notification_queue_send_notifications();
+    return;
+  }
+  report_pending = 1;
+  report_acked = 0;
+  LOG_DBG("Sent batched report with %u bytes\n", outbuf.len);
+
+#if LWM2M_QUEUE_MODE_INCLUDE_DYNAMIC_ADAPTATION
+  if(lwm2m_queue_mode_get_dynamic_adaptation_flag()) {
+    lwm2m_queue_mode_set_handler_from_notification();
+  }
+#endif
+  /* The paths are removed once the server acknowledges the report */
+  for(iteration_path = (notification_path_t *)list_head(notification_paths_queue);
+      iteration_path != NULL;
+      iteration_path = iteration_path->next) {
+    iteration_path->reported = 1;
+  }
+}
+#endif /* LWM2M_QUEUE_MODE_BATCH_REPORT */
 #endif /* LWM2M_QUEUE_MODE_ENABLED */
 /** @} */
\ No newline at end of file
@@ -46,6 +46,7 @@
 
 #include "contiki.h"
 #include "lwm2m-queue-mode-conf.h"
+#include "coap-endpoint.h"
 
 #include <inttypes.h>
 
@@ -53,6 +54,9 @@ typedef struct notification_path {
   struct notification_path *next;
   uint16_t reduced_path[3];
   uint8_t level; /* The depth level of the path: 1. object, 2. object/instance, 3. object/instance/resource */
+#if LWM2M_QUEUE_MODE_BATCH_REPORT
+  uint8_t reported; /* Included in the batched report in flight */
+#endif /* LWM2M_QUEUE_MODE_BATCH_REPORT */
 } notification_path_t;
 
 void lwm2m_notification_queue_init(void);
@@ -61,5 +65,13 @@ void lwm2m_notification_queue_add_notification_path(uint16_t object_id, uint16_t
 
 void lwm2m_notification_queue_send_notifications();
 
+#if LWM2M_QUEUE_MODE_BATCH_REPORT
+/* Send all queued changes in one SenML-CBOR report to the server. The
+   changes stay queued until the server acknowledges the report with a
+   2.xx response. Falls back to lwm2m_notification_queue_send_notifications()
+   if they do not fit in one message, or if the report fails. */
+void lwm2m_notification_queue_send_report(coap_endpoint_t *server_ep);
+#endif /* LWM2M_QUEUE_MODE_BATCH_REPORT */
+
 #endif /* LWM2M_NOTIFICATION_QUEUE_H */
 /** @} */
\ No newline at end of file
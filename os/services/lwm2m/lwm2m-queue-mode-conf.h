@@ -90,6 +90,23 @@
 #define LWM2M_QUEUE_MODE_OBJECT_ENABLED 0 /* not included */
 #endif /* LWM2M_QUEUE_MODE_OBJECT_ENABLED */
 
+/* Send all the notifications queued while sleeping as one SenML-CBOR
+   report (LWM2M Send, POST /dp) on wake-up instead of one notification
+   per path. The Send operation is part of LWM2M 1.1, so enabling this
+   makes the client register as lwm2m=1.1. */
+#ifdef LWM2M_QUEUE_MODE_CONF_BATCH_REPORT
+#define LWM2M_QUEUE_MODE_BATCH_REPORT LWM2M_QUEUE_MODE_CONF_BATCH_REPORT
+#else
+#define LWM2M_QUEUE_MODE_BATCH_REPORT 0 /* disabled */
+#endif /* LWM2M_QUEUE_MODE_BATCH_REPORT */
+
+/* Payload size of the batched report */
+#ifdef LWM2M_QUEUE_MODE_CONF_BATCH_REPORT_SIZE
+#define LWM2M_QUEUE_MODE_BATCH_REPORT_SIZE LWM2M_QUEUE_MODE_CONF_BATCH_REPORT_SIZE
+#else
+#define LWM2M_QUEUE_MODE_BATCH_REPORT_SIZE COAP_MAX_CHUNK_SIZE
+#endif /* LWM2M_QUEUE_MODE_BATCH_REPORT_SIZE */
+
 
 
 #endif /* LWM2M_QUEUE_MODE_CONF_H */
@@ -497,7 +497,11 @@ update_callback(coap_callback_request_state_t *callback_state)
       if(lwm2m_queue_mode_is_waked_up_by_notification()) {
 
         lwm2m_queue_mode_clear_waked_up_by_notification();
+#if LWM2M_QUEUE_MODE_BATCH_REPORT
+        lwm2m_notification_queue_send_report(&session_info->server_ep);
+#else
         lwm2m_notification_queue_send_notifications();
+#endif /* LWM2M_QUEUE_MODE_BATCH_REPORT */
       }
 #if LWM2M_QUEUE_MODE_INCLUDE_DYNAMIC_ADAPTATION
       if(lwm2m_queue_mode_get_dynamic_adaptation_flag()) {
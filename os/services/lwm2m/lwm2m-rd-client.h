@@ -59,10 +59,15 @@ typedef enum {
 #define LWM2M_RD_CLIENT_DEREGISTER_FAILED  4
 #define LWM2M_RD_CLIENT_DISCONNECTED       5
 
-#define LWM2M_PROTOCOL_VERSION     "1.0"
-
 #include "lwm2m-object.h"
 #include "lwm2m-queue-mode-conf.h"
+
+/* The batched queue mode report uses the LWM2M 1.1 Send operation */
+#if LWM2M_QUEUE_MODE_ENABLED && LWM2M_QUEUE_MODE_BATCH_REPORT
+#define LWM2M_PROTOCOL_VERSION     "1.1"
+#else
+#define LWM2M_PROTOCOL_VERSION     "1.0"
+#endif
 #include "coap-endpoint.h"
 #include "coap-callback-api.h"
 
@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2026, agent <agent@local>.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup lwm2m
+ * @{
+ */
+
+/**
+ * \file
+ *         Implementation of the Contiki OMA LWM2M SenML-CBOR writer
+ *         (RFC 8428, content-format 112)
+ */
+
+#include "lwm2m-object.h"
+#include "lwm2m-senml-cbor.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+/* Log configuration */
+#include "coap-log.h"
+#define LOG_MODULE "lwm2m-senml-cbor"
+#define LOG_LEVEL  LOG_LEVEL_NONE
+/*---------------------------------------------------------------------------*/
+
+/* CBOR major types */
+#define CBOR_UINT          0x00
+#define CBOR_NINT          0x20
+#define CBOR_TEXT          0x60
+#define CBOR_MAP           0xa0
+#define CBOR_ARRAY_INDEF   0x9f
+#define CBOR_FALSE         0xf4
+#define CBOR_TRUE          0xf5
+#define CBOR_FLOAT32       0xfa
+#define CBOR_BREAK         0xff
+
+/* SenML labels */
+#define SENML_BASE_NAME    -2
+#define SENML_NAME          0
+#define SENML_VALUE         2
+#define SENML_STRING_VALUE  3
+#define SENML_BOOL_VALUE    4
+
+/*---------------------------------------------------------------------------*/
+static size_t
+cbor_head(uint8_t *outbuf, size_t outlen, uint8_t major, uint32_t value)
+{
+  size_t len;
+  if(value < 24) {
+    len = 1;
+  } else if(value <= 0xff) {
+    len = 2;
+  } else if(value <= 0xffff) {
+    len = 3;
+  } else {
+    len = 5;
+  }
+  if(len > outlen) {
+    return 0;
+  }
+  switch(len) {
+  case 1:
+    outbuf[0] = major | value;
+    break;
+  case 2:
+    outbuf[0] = major | 24;
+    outbuf[1] = value;
+    break;
+  case 3:
+    outbuf[0] = major | 25;
+    outbuf[1] = value >> 8;
+    outbuf[2] = value;
+    break;
+  default:
+    outbuf[0] = major | 26;
+    outbuf[1] = value >> 24;
+    outbuf[2] = value >> 16;
+    outbuf[3] = value >> 8;
+    outbuf[4] = value;
+    break;
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+cbor_int(uint8_t *outbuf, size_t outlen, int32_t value)
+{
+  if(value < 0) {
+    return cbor_head(outbuf, outlen, CBOR_NINT, -1 - value);
+  }
+  return cbor_head(outbuf, outlen, CBOR_UINT, value);
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+cbor_text(uint8_t *outbuf, size_t outlen, const char *value, size_t stringlen)
+{
+  size_t len = cbor_head(outbuf, outlen, CBOR_TEXT, stringlen);
+  if(len == 0 || len + stringlen > outlen) {
+    return 0;
+  }
+  memcpy(&outbuf[len], value, stringlen);
+  return len + stringlen;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Convert a fixed point value to an IEEE 754 single without pulling in
+ * floating point support. Precision beyond 24 bits is truncated.
+ */
+static uint32_t
+fix_to_float32(int32_t value, int bits)
+{
+  uint32_t sign = 0;
+  uint32_t mantissa;
+  int exponent;
+
+  if(value == 0) {
+    return 0;
+  }
+  if(value < 0) {
+    sign = 0x80000000UL;
+    mantissa = -(uint32_t)value;
+  } else {
+    mantissa = value;
+  }
+  /* value = mantissa * 2^(exponent - 23) once the leading one is at bit 23 */
+  exponent = 23 - bits;
+  while(mantissa >= (1UL << 24)) {
+    mantissa >>= 1;
+    exponent++;
+  }
+  while(mantissa < (1UL << 23)) {
+    mantissa <<= 1;
+    exponent--;
+  }
+  return sign | ((uint32_t)(exponent + 127) << 23) | (mantissa & 0x7fffffUL);
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Write the map header, the base name (first record after init only), the
+ * record name and the label of the value that follows.
+ */
+static size_t
+write_record_head(lwm2m_context_t *ctx, uint8_t *outbuf, size_t outlen,
+                  int label)
+{
+  char name[16]; /* "/65535/65535/" */
+  uint8_t with_base = (ctx->writer_flags & WRITER_OUTPUT_VALUE) == 0;
+  size_t len;
+  size_t res;
+  int n;
+
+  len = cbor_head(outbuf, outlen, CBOR_MAP, with_base ? 3 : 2);
+  if(len == 0) {
+    return 0;
+  }
+  if(with_base) {
+    n = snprintf(name, sizeof(name), "/%u/%u/",
+                 ctx->object_id, ctx->object_instance_id);
+    if((res = cbor_int(&outbuf[len], outlen - len, SENML_BASE_NAME)) == 0) {
+      return 0;
+    }
+    len += res;
+    if((res = cbor_text(&outbuf[len], outlen - len, name, n)) == 0) {
+      return 0;
+    }
+    len += res;
+  }
+  if(ctx->writer_flags & WRITER_RESOURCE_INSTANCE) {
+    n = snprintf(name, sizeof(name), "%u/%u",
+                 ctx->resource_id, ctx->resource_instance_id);
+  } else {
+    n = snprintf(name, sizeof(name), "%u", ctx->resource_id);
+  }
+  if((res = cbor_int(&outbuf[len], outlen - len, SENML_NAME)) == 0) {
+    return 0;
+  }
+  len += res;
+  if((res = cbor_text(&outbuf[len], outlen - len, name, n)) == 0) {
+    return 0;
+  }
+  len += res;
+  if((res = cbor_int(&outbuf[len], outlen - len, label)) == 0) {
+    return 0;
+  }
+  return len + res;
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+init_write(lwm2m_context_t *ctx)
+{
+  ctx->writer_flags = 0; /* set flags to zero */
+  if(ctx->outbuf->len >= ctx->outbuf->size) {
+    return 0;
+  }
+  ctx->outbuf->buffer[ctx->outbuf->len] = CBOR_ARRAY_INDEF;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+end_write(lwm2m_context_t *ctx)
+{
+  if(ctx->outbuf->len >= ctx->outbuf->size) {
+    return 0;
+  }
+  ctx->outbuf->buffer[ctx->outbuf->len] = CBOR_BREAK;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+enter_sub(lwm2m_context_t *ctx)
+{
+  LOG_DBG("Enter sub-resource rsc=%d\n", ctx->resource_id);
+  ctx->writer_flags |= WRITER_RESOURCE_INSTANCE;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+exit_sub(lwm2m_context_t *ctx)
+{
+  LOG_DBG("Exit sub-resource rsc=%d\n", ctx->resource_id);
+  ctx->writer_flags &= ~WRITER_RESOURCE_INSTANCE;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+write_boolean(lwm2m_context_t *ctx, uint8_t *outbuf, size_t outlen,
+              int value)
+{
+  size_t len = write_record_head(ctx, outbuf, outlen, SENML_BOOL_VALUE);
+  if(len == 0 || len >= outlen) {
+    return 0;
+  }
+  outbuf[len++] = value ? CBOR_TRUE : CBOR_FALSE;
+  ctx->writer_flags |= WRITER_OUTPUT_VALUE;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+write_int(lwm2m_context_t *ctx, uint8_t *outbuf, size_t outlen,
+          int32_t value)
+{
+  size_t len = write_record_head(ctx, outbuf, outlen, SENML_VALUE);
+  size_t res;
+  if(len == 0) {
+    return 0;
+  }
+  if((res = cbor_int(&outbuf[len], outlen - len, value)) == 0) {
+    return 0;
+  }
+  LOG_DBG("Write int:%"PRId32"\n", value);
+  ctx->writer_flags |= WRITER_OUTPUT_VALUE;
+  return len + res;
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+write_float32fix(lwm2m_context_t *ctx, uint8_t *outbuf, size_t outlen,
+                 int32_t value, int bits)
+{
+  size_t len;
+  uint32_t f;
+
+  if((value & ((1L << bits) - 1)) == 0) {
+    /* Integral values are shorter as CBOR integers */
+    return write_int(ctx, outbuf, outlen, value >> bits);
+  }
+  len = write_record_head(ctx, outbuf, outlen, SENML_VALUE);
+  if(len == 0 || len + 5 > outlen) {
+    return 0;
+  }
+  f = fix_to_float32(value, bits);
+  outbuf[len++] = CBOR_FLOAT32;
+  outbuf[len++] = f >> 24;
+  outbuf[len++] = f >> 16;
+  outbuf[len++] = f >> 8;
+  outbuf[len++] = f;
+  ctx->writer_flags |= WRITER_OUTPUT_VALUE;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+write_string(lwm2m_context_t *ctx, uint8_t *outbuf, size_t outlen,
+             const char *value, size_t stringlen)
+{
+  size_t len = write_record_head(ctx, outbuf, outlen, SENML_STRING_VALUE);
+  size_t res;
+  if(len == 0) {
+    return 0;
+  }
+  if((res = cbor_text(&outbuf[len], outlen - len, value, stringlen)) == 0) {
+    return 0;
+  }
+  ctx->writer_flags |= WRITER_OUTPUT_VALUE;
+  return len + res;
+}
+/*---------------------------------------------------------------------------*/
+const lwm2m_writer_t lwm2m_senml_cbor_writer = {
+  init_write,
+  end_write,
+  enter_sub,
+  exit_sub,
+  write_int,
+  write_string,
+  write_float32fix,
+  write_boolean
+};
+/*---------------------------------------------------------------------------*/
+/** @} */
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2026, agent <agent@local>.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup lwm2m
+ * @{
+ */
+
+/**
+ * \file
+ *         LWM2M object exposing TSCH, MSF and 6P counters
+ */
+
+#include "lwm2m-object.h"
+#include "lwm2m-engine.h"
+#include "lwm2m-tsch-object.h"
+
+#if LWM2M_TSCH_OBJECT_ENABLED && MAC_CONF_WITH_TSCH
+
+#include "net/mac/tsch/tsch-monitor.h"
+
+static const lwm2m_resource_id_t resources[] =
+{ RO(TSCH_MONITOR_ASSOCIATED),
+  RO(TSCH_MONITOR_MAX_SYNC_ERROR),
+  RO(TSCH_MONITOR_DISASSOCIATIONS),
+  RO(TSCH_MONITOR_TX_QUEUE_DROPS),
+  RO(TSCH_MONITOR_INPUT_QUEUE_DROPS),
+  RO(TSCH_MONITOR_DEADLINE_MISSES),
+  RO(TSCH_MONITOR_TX_QUEUE_LENGTH),
+  RO(TSCH_MONITOR_TS_TX_QUEUE_LENGTH),
+  RO(TSCH_MONITOR_TS_P_TX_SUCCESS),
+  RO(TSCH_MONITOR_TS_RSSI),
+  RO(TSCH_MONITOR_TS_LQI),
+  RO(TSCH_MONITOR_MSF_TX_SCHEDULED),
+  RO(TSCH_MONITOR_MSF_TX_REQUIRED),
+  RO(TSCH_MONITOR_MSF_TX_USED),
+  RO(TSCH_MONITOR_MSF_TX_ELAPSED),
+  RO(TSCH_MONITOR_MSF_RX_SCHEDULED),
+  RO(TSCH_MONITOR_MSF_RX_REQUIRED),
+  RO(TSCH_MONITOR_MSF_RX_USED),
+  RO(TSCH_MONITOR_MSF_RX_ELAPSED),
+  RO(TSCH_MONITOR_SIXP_COMPLETED),
+  RO(TSCH_MONITOR_SIXP_TIMEOUTS),
+  RO(TSCH_MONITOR_SIXP_ABORTED),
+  RO(TSCH_MONITOR_SIXP_ALLOC_FAILS),
+  RO(TSCH_MONITOR_SIXP_ACTIVE),
+};
+/*---------------------------------------------------------------------------*/
+static lwm2m_status_t
+lwm2m_callback(lwm2m_object_instance_t *object, lwm2m_context_t *ctx)
+{
+  if(ctx->operation == LWM2M_OP_READ &&
+     ctx->resource_id < TSCH_MONITOR_COUNT) {
+    lwm2m_object_write_int(ctx, tsch_monitor_get(ctx->resource_id));
+    return LWM2M_STATUS_OK;
+  }
+
+  return LWM2M_STATUS_OPERATION_NOT_ALLOWED;
+}
+/*---------------------------------------------------------------------------*/
+static lwm2m_object_instance_t tsch_object = {
+  .object_id = LWM2M_TSCH_OBJECT_ID,
+  .instance_id = 0,
+  .resource_ids = resources,
+  .resource_count = sizeof(resources) / sizeof(lwm2m_resource_id_t),
+  .resource_dim_callback = NULL,
+  .callback = lwm2m_callback,
+};
+/*---------------------------------------------------------------------------*/
+void
+lwm2m_tsch_object_init(void)
+{
+  lwm2m_engine_add_object(&tsch_object);
+}
+#endif /* LWM2M_TSCH_OBJECT_ENABLED && MAC_CONF_WITH_TSCH */
+/** @} */
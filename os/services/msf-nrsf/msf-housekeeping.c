@@ -229,6 +229,10 @@ msf_housekeeping_start(void)
   parent_addr = NULL;
   msf_num_cells_reset(true);
   cell_to_relocate = NULL;
+#if PROCESS_PRIORITIES
+  /* Housekeeping can wait for the MAC and network processes */
+  process_set_priority(&msf_housekeeping_process, PROCESS_PRIO_BACKGROUND);
+#endif /* PROCESS_PRIORITIES */
   process_start(&msf_housekeeping_process, NULL);
 }
 /*---------------------------------------------------------------------------*/
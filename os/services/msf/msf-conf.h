@@ -185,6 +185,26 @@
 #define MSF_WAIT_DURATION_MAX_SECONDS 60
 #endif /* MSF_CONF_WAIT_DURATION_MAX_SECONDS */
 
+/**
+ * \brief The largest path cost the capacity aware RPL OF adds for a
+ * parent without any spare capacity, in ETX units (128 = ETX 1)
+ */
+#ifdef MSF_CONF_RPL_OF_LOAD_WEIGHT
+#define MSF_RPL_OF_LOAD_WEIGHT MSF_CONF_RPL_OF_LOAD_WEIGHT
+#else
+#define MSF_RPL_OF_LOAD_WEIGHT 256
+#endif /* MSF_CONF_RPL_OF_LOAD_WEIGHT */
+
+/**
+ * \brief The number of load levels the capacity aware RPL OF
+ * distinguishes; coarser levels mean less rank churn
+ */
+#ifdef MSF_CONF_RPL_OF_LOAD_LEVELS
+#define MSF_RPL_OF_LOAD_LEVELS MSF_CONF_RPL_OF_LOAD_LEVELS
+#else
+#define MSF_RPL_OF_LOAD_LEVELS 8
+#endif /* MSF_CONF_RPL_OF_LOAD_LEVELS */
+
 #endif /* !_MSF_CONF_H_ */
 
 /** @} */
@@ -44,19 +44,15 @@
 #include "msf-autonomous-cell.h"
 #include "msf-housekeeping.h"
 #include "msf-negotiated-cell.h"
+#include "msf-num-cells.h"
 #include "msf-sixp.h"
 
 #include "sys/log.h"
 #define LOG_MODULE "MSF num"
 #define LOG_LEVEL LOG_LEVEL_MSF
 
-static struct CellsStats {
-  uint8_t scheduled;
-  uint8_t required;
-  uint8_t elapsed;
-  unsigned used;
-} tx_num_cells, rx_num_cells;
-typedef struct CellsStats CellsStats;
+static msf_num_cells_t tx_num_cells, rx_num_cells;
+typedef msf_num_cells_t CellsStats;
 
 static bool need_keep_alive = false;
 
@@ -310,6 +306,12 @@ void msf_num_cells_trigger_6p_del_transaction(void){
     }
 }
 
+/*---------------------------------------------------------------------------*/
+const msf_num_cells_t *
+msf_num_cells_get(msf_negotiated_cell_type_t cell_type)
+{
+  return cell_type == MSF_NEGOTIATED_CELL_TYPE_TX ? &tx_num_cells : &rx_num_cells;
+}
 /*---------------------------------------------------------------------------*/
 void
 msf_num_cells_show(shell_output_func output)
@@ -44,6 +44,16 @@
 
 #include "msf-negotiated-cell.h"
 
+/**
+ * \brief NumCells* counters of one cell direction to the parent
+ */
+typedef struct {
+  uint8_t scheduled;
+  uint8_t required;
+  uint8_t elapsed;
+  unsigned used;
+} msf_num_cells_t;
+
 /**
  * \brief Reset NumCells* counters
  * \param clear_num_cells_required Specify whether you want to reset
@@ -98,6 +108,12 @@ bool msf_num_cells_request_rx_link(void);
 void msf_num_cells_trigger_6p_add_transaction(void);
 void msf_num_cells_trigger_6p_del_transaction(void);
 
+/**
+ * \brief Return the live NumCells* counters of a cell direction
+ * \param cell_type MSF_NEGOTIATED_CELL_TYPE_TX or MSF_NEGOTIATED_CELL_TYPE_RX
+ */
+const msf_num_cells_t *msf_num_cells_get(msf_negotiated_cell_type_t cell_type);
+
 /**
  * \brief Show NumCells* counters in the shell
  * \param output A pointer to shell_output_func
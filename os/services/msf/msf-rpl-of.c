@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2026, agent <agent@local>.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Schedule capacity aware RPL objective function
+ */
+
+#include "contiki.h"
+#include "lib/list.h"
+#include "net/queuebuf.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/routing/rpl-lite/rpl.h"
+
+#include "msf.h"
+#include "msf-negotiated-cell.h"
+#include "msf-rpl-of.h"
+
+#include "sys/log.h"
+#define LOG_MODULE "MSF of"
+#define LOG_LEVEL LOG_LEVEL_MSF
+
+/* Hysteresis, as in MRHOF: the path cost must differ more than
+ * RANK_THRESHOLD, or a neighbor must have been better for at least
+ * TIME_THRESHOLD, to switch preferred parent. */
+#define RANK_THRESHOLD 192 /* Eq ETX of 1.5 */
+#define TIME_THRESHOLD (10 * 60 * CLOCK_SECOND)
+
+extern rpl_of_t rpl_mrhof;
+
+/*---------------------------------------------------------------------------*/
+/* The throughput of a node with no negotiated cell and empty queues */
+static uint32_t
+max_throughput(void)
+{
+  return (uint32_t)TSCH_PACKET_MAX_LEN * TSCH_SLOTS_PER_SECOND;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+msf_rpl_of_local_throughput(void)
+{
+  tsch_slotframe_t *sf;
+  uint16_t len;
+  uint16_t used;
+  uint32_t free_cells;
+  uint32_t free_queue;
+  int queued;
+
+  sf = msf_negotiated_cell_get_slotframe();
+  if(!msf_is_activated() || sf == NULL || sf->size.val == 0) {
+    /* Nothing is known about our schedule yet, do not scare children off */
+    return max_throughput();
+  }
+
+  len = sf->size.val;
+  used = list_length(sf->links_list);
+  free_cells = used < len ? len - used : 0;
+
+  queued = tsch_queue_global_packet_count();
+  free_queue = queued < QUEUEBUF_NUM ? QUEUEBUF_NUM - queued : 0;
+
+  /* The cells left free in the negotiated slotframe, of which a backlog
+     in the queues will take its share first */
+  return (uint32_t)(((uint64_t)max_throughput() * free_cells * free_queue) /
+                    ((uint32_t)len * QUEUEBUF_NUM));
+}
+/*---------------------------------------------------------------------------*/
+#if RPL_WITH_MC
+/* The path cost added for a parent advertising a given spare throughput.
+ * It is quantised to MSF_RPL_OF_LOAD_LEVELS levels, so that small load
+ * variations do not make the rank of the children oscillate. */
+static uint16_t
+load_cost(uint32_t throughput)
+{
+  uint32_t max = max_throughput();
+  uint32_t level;
+
+  if(throughput >= max) {
+    return 0;
+  }
+
+  level = ((max - throughput) * MSF_RPL_OF_LOAD_LEVELS + max - 1) / max;
+  return level * MSF_RPL_OF_LOAD_WEIGHT / MSF_RPL_OF_LOAD_LEVELS;
+}
+/*---------------------------------------------------------------------------*/
+static void
+reset(void)
+{
+  LOG_INFO("reset capacity aware OF\n");
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+nbr_link_metric(rpl_nbr_t *nbr)
+{
+  return rpl_mrhof.nbr_link_metric(nbr);
+}
+/*---------------------------------------------------------------------------*/
+static int
+nbr_has_usable_link(rpl_nbr_t *nbr)
+{
+  return rpl_mrhof.nbr_has_usable_link(nbr);
+}
+/*---------------------------------------------------------------------------*/
+static int
+nbr_is_acceptable_parent(rpl_nbr_t *nbr)
+{
+  /* A loaded parent is a worse parent, not an unacceptable one */
+  return rpl_mrhof.nbr_is_acceptable_parent(nbr);
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+nbr_path_cost(rpl_nbr_t *nbr)
+{
+  uint32_t path_cost;
+
+  if(nbr == NULL) {
+    return 0xffff;
+  }
+
+  /* Rank plus link ETX, as MRHOF computes it without ETX metric container.
+     The rank of the neighbor already holds the load costs further up, so
+     only the load of the neighbor itself is added. */
+  path_cost = rpl_mrhof.nbr_path_cost(nbr);
+  if(nbr->mc.type == RPL_DAG_MC_THROUGHPUT) {
+    path_cost += load_cost(nbr->mc.obj.throughput);
+  }
+
+  return MIN(path_cost, 0xffff);
+}
+/*---------------------------------------------------------------------------*/
+static rpl_rank_t
+rank_via_nbr(rpl_nbr_t *nbr)
+{
+  if(nbr == NULL) {
+    return RPL_INFINITE_RANK;
+  }
+
+  /* Rank lower-bound: nbr rank + min_hoprankinc */
+  return MAX(MIN((uint32_t)nbr->rank + curr_instance.min_hoprankinc,
+                 RPL_INFINITE_RANK), nbr_path_cost(nbr));
+}
+/*---------------------------------------------------------------------------*/
+static int
+within_hysteresis(rpl_nbr_t *nbr)
+{
+  uint16_t path_cost = nbr_path_cost(nbr);
+  uint16_t parent_path_cost = nbr_path_cost(curr_instance.dag.preferred_parent);
+
+  int within_rank_hysteresis = path_cost + RANK_THRESHOLD > parent_path_cost;
+  int within_time_hysteresis = nbr->better_parent_since == 0
+    || (clock_time() - nbr->better_parent_since) <= TIME_THRESHOLD;
+
+  return within_rank_hysteresis && within_time_hysteresis;
+}
+/*---------------------------------------------------------------------------*/
+static rpl_nbr_t *
+best_parent(rpl_nbr_t *nbr1, rpl_nbr_t *nbr2)
+{
+  int nbr1_is_acceptable;
+  int nbr2_is_acceptable;
+
+  nbr1_is_acceptable = nbr1 != NULL && nbr_is_acceptable_parent(nbr1);
+  nbr2_is_acceptable = nbr2 != NULL && nbr_is_acceptable_parent(nbr2);
+
+  if(!nbr1_is_acceptable) {
+    return nbr2_is_acceptable ? nbr2 : NULL;
+  }
+  if(!nbr2_is_acceptable) {
+    return nbr1;
+  }
+
+  /* Maintain stability of the preferred parent */
+  if(nbr1 == curr_instance.dag.preferred_parent && within_hysteresis(nbr2)) {
+    return nbr1;
+  }
+  if(nbr2 == curr_instance.dag.preferred_parent && within_hysteresis(nbr1)) {
+    return nbr2;
+  }
+
+  return nbr_path_cost(nbr1) < nbr_path_cost(nbr2) ? nbr1 : nbr2;
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_metric_container(void)
+{
+  if(!curr_instance.used) {
+    LOG_WARN("cannot update the metric container when not joined\n");
+    return;
+  }
+
+  if(curr_instance.dag.rank == ROOT_RANK) {
+    /* Configure MC at root only, other nodes are auto-configured when joining.
+       Every node advertises its own throughput; the load costs derived
+       from it add up along the path through the rank. */
+    curr_instance.mc.type = RPL_DAG_MC_THROUGHPUT;
+    curr_instance.mc.flags = 0;
+    curr_instance.mc.aggr = RPL_DAG_MC_AGGR_ADDITIVE;
+    curr_instance.mc.prec = 0;
+  }
+
+  if(curr_instance.mc.type != RPL_DAG_MC_THROUGHPUT) {
+    LOG_WARN("capacity aware OF, non-supported MC %u\n", curr_instance.mc.type);
+    return;
+  }
+
+  curr_instance.mc.length = sizeof(curr_instance.mc.obj.throughput);
+  curr_instance.mc.obj.throughput = msf_rpl_of_local_throughput();
+}
+/*---------------------------------------------------------------------------*/
+rpl_of_t msf_rpl_of = {
+  reset,
+  nbr_link_metric,
+  nbr_has_usable_link,
+  nbr_is_acceptable_parent,
+  nbr_path_cost,
+  rank_via_nbr,
+  best_parent,
+  update_metric_container,
+  RPL_OCP_MSF_CAPACITY
+};
+#endif /* RPL_WITH_MC */
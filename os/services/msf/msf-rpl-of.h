@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026, agent <agent@local>.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup msf
+ * @{
+ */
+/**
+ * \file
+ *         Schedule capacity aware RPL objective function
+ *
+ *         An MRHOF variant for RPL Lite that also accounts for the
+ *         spare capacity of candidate parents. Each node advertises in
+ *         a DIO throughput metric container (RFC6551) its own spare
+ *         capacity, estimated from the free cells of the MSF negotiated
+ *         slotframe and the occupancy of its TSCH queues. Children add
+ *         a cost, up to MSF_RPL_OF_LOAD_WEIGHT, that grows as this
+ *         capacity shrinks, so that they spread over under-utilised
+ *         parents instead of piling up on the one with the best ETX.
+ *         The costs of the nodes further up add up through their rank.
+ *
+ *         To use it, build with RPL_CONF_WITH_MC=1, add &msf_rpl_of to
+ *         RPL_CONF_SUPPORTED_OFS and set RPL_CONF_OF_OCP to
+ *         RPL_OCP_MSF_CAPACITY at the root. RPL Lite only declares its
+ *         own objective functions, so the project configuration that
+ *         lists msf_rpl_of must also declare it, as
+ *         "struct rpl_of; extern struct rpl_of msf_rpl_of;".
+ */
+
+#ifndef _MSF_RPL_OF_H_
+#define _MSF_RPL_OF_H_
+
+#include "net/routing/rpl-lite/rpl.h"
+
+/**
+ * \brief The capacity aware objective function
+ */
+extern rpl_of_t msf_rpl_of;
+
+/**
+ * \brief Return the spare upward throughput of this node, in bytes
+ * per second, as advertised in its DIOs
+ */
+uint32_t msf_rpl_of_local_throughput(void);
+
+#endif /* !_MSF_RPL_OF_H_ */
+/** @} */
@@ -140,7 +140,7 @@ const struct MSFConstantInfo msf_constants_patern[] = {
 };
 
 void msf_constants_describe(MSFConstantInfo* info){
-    memcpy(info, msf_constants_patern, MSFCONSTANTS_NUM* sizeof(MSFConstantInfo) );
+    memcpy(info, msf_constants_patern, sizeof(msf_constants_patern));
     info[2].val = tsch_hopping_sequence_length.val;
 }
 
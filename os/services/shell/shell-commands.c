@@ -46,6 +46,7 @@
 #include "shell.h"
 #include "shell-commands.h"
 #include "lib/list.h"
+#include "lib/memb.h"
 #include "sys/log.h"
 #include "dev/watchdog.h"
 #include "net/ipv6/uip.h"
@@ -69,6 +70,9 @@
 #if BUILD_WITH_MSF
 #include "os/services/msf/msf.h"
 #endif
+#ifdef HEAPMEM_CONF_ARENA_SIZE
+#include "lib/heapmem.h"
+#endif
 
 /* For RPL-specific commands */
 #if ROUTING_CONF_RPL_LITE
@@ -949,6 +953,54 @@ PT_THREAD(cmd_llsec_setkey(struct pt *pt, shell_output_func output, char *args))
 }
 #endif /* LLSEC802154_ENABLED */
 /*---------------------------------------------------------------------------*/
+#ifdef HEAPMEM_CONF_ARENA_SIZE
+static
+PT_THREAD(cmd_heapmem(struct pt *pt, shell_output_func output, char *args))
+{
+  heapmem_stats_t stats;
+  size_t free_space;
+
+  PT_BEGIN(pt);
+
+  heapmem_stats(&stats);
+  free_space = stats.available;
+
+  SHELL_OUTPUT(output, "Heap of %lu bytes:\n", (unsigned long)HEAPMEM_CONF_ARENA_SIZE);
+  SHELL_OUTPUT(output, "-- Allocated: %lu bytes (max %lu)\n",
+               (unsigned long)stats.allocated, (unsigned long)stats.max_allocated);
+  SHELL_OUTPUT(output, "-- Available: %lu bytes, largest block %lu bytes\n",
+               (unsigned long)free_space, (unsigned long)stats.largest_free);
+  if(free_space > 0) {
+    SHELL_OUTPUT(output, "-- Fragmentation: %u%%\n",
+                 (unsigned)(100 - (uint64_t)stats.largest_free * 100 / free_space));
+  }
+  SHELL_OUTPUT(output, "-- Overhead: %lu bytes in %lu chunks, footprint %lu bytes\n",
+               (unsigned long)stats.overhead, (unsigned long)stats.chunks,
+               (unsigned long)stats.footprint);
+
+  PT_END(pt);
+}
+#endif /* HEAPMEM_CONF_ARENA_SIZE */
+/*---------------------------------------------------------------------------*/
+#if MEMB_STATS
+static
+PT_THREAD(cmd_memb(struct pt *pt, shell_output_func output, char *args))
+{
+  struct memb *m;
+
+  PT_BEGIN(pt);
+
+  SHELL_OUTPUT(output, "Memory block pools (used/total, max, failed):\n");
+  for(m = memb_stats_head(); m != NULL; m = memb_stats_next(m)) {
+    SHELL_OUTPUT(output, "-- %s: %u/%u of %u bytes, max %u, failed %u%s\n",
+                 m->name, m->count, m->num, m->size, m->max_count, m->failed,
+                 m->max_count == m->num ? " (exhausted)" : "");
+  }
+
+  PT_END(pt);
+}
+#endif /* MEMB_STATS */
+/*---------------------------------------------------------------------------*/
 void
 shell_commands_init(void)
 {
@@ -998,6 +1050,12 @@ shell_command_lookup(const char *name)
 const struct shell_command_t builtin_shell_commands[] = {
   { "help",                 cmd_help,                 "'> help': Shows this help" },
   { "reboot",               cmd_reboot,               "'> reboot': Reboot the board by watchdog_reboot()" },
+#ifdef HEAPMEM_CONF_ARENA_SIZE
+  { "heapmem",              cmd_heapmem,              "'> heapmem': Shows heap memory usage and fragmentation" },
+#endif /* HEAPMEM_CONF_ARENA_SIZE */
+#if MEMB_STATS
+  { "memb",                 cmd_memb,                 "'> memb': Shows the usage of all memory block pools" },
+#endif /* MEMB_STATS */
   { "log",                  cmd_log,                  "'> log module level': Sets log level (0--4) for a given module (or \"all\"). For module \"mac\", level 4 also enables per-slot logging." },
   { "mac-addr",             cmd_macaddr,               "'> mac-addr': Shows the node's MAC address" },
 #if NETSTACK_CONF_WITH_IPV6
@@ -65,6 +65,11 @@
 #define DB_FEATURE_COFFEE		1
 #endif /* DB_FEATURE_COFFEE */
 
+/* Support B+-tree indexes, which handle range queries efficiently. */
+#ifndef DB_FEATURE_BPLUSTREE
+#define DB_FEATURE_BPLUSTREE		0
+#endif /* DB_FEATURE_BPLUSTREE */
+
 /* Enable basic data integrity checks. */
 #ifndef DB_FEATURE_INTEGRITY
 #define DB_FEATURE_INTEGRITY		0
@@ -215,6 +220,26 @@
 #define DB_HEAP_CACHE_LIMIT		1
 #endif /* DB_HEAP_CACHE_LIMIT */
 
+/* The maximum number of B+-tree indexes. */
+#ifndef DB_BPLUSTREE_INDEX_LIMIT
+#define DB_BPLUSTREE_INDEX_LIMIT	1
+#endif /* DB_BPLUSTREE_INDEX_LIMIT */
+
+/* The maximum number of keys in a B+-tree node. */
+#ifndef DB_BPLUSTREE_ORDER
+#define DB_BPLUSTREE_ORDER		16
+#endif /* DB_BPLUSTREE_ORDER */
+
+/* The maximum number of nodes in a B+-tree index file. */
+#ifndef DB_BPLUSTREE_NODE_LIMIT
+#define DB_BPLUSTREE_NODE_LIMIT		128
+#endif /* DB_BPLUSTREE_NODE_LIMIT */
+
+/* The number of B+-tree nodes cached in RAM, shared by all B+-trees. */
+#ifndef DB_BPLUSTREE_CACHE_LIMIT
+#define DB_BPLUSTREE_CACHE_LIMIT	3
+#endif /* DB_BPLUSTREE_CACHE_LIMIT */
+
 /*----------------------------------------------------------------------------*/
 
 /* LVM options. */
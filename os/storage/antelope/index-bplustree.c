@@ -0,0 +1,728 @@
+/*
+ * Copyright (c) 2026, agent <agent@local>.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *     A B+-tree index for flash memory.
+ *
+ *     The tree is stored in a single file that starts with a small
+ *     header, followed by an array of fixed-size nodes. Leaves hold
+ *     sorted (key, tuple id) pairs and are chained from left to right,
+ *     so that a range query descends once from the root to the first
+ *     matching key and then follows the leaf chain. Internal nodes use
+ *     the same pair layout, with the value referring to a child node
+ *     and the key being the lower bound of the keys in that child.
+ *
+ *     Keys inserted at the right edge of the tree, which is the normal
+ *     case for time series and auto-incremented keys, are appended to
+ *     the rightmost leaf without moving other pairs. When that leaf is
+ *     full, the new key starts a fresh leaf instead of splitting the
+ *     old leaf in half. Loading a relation that is sorted on the
+ *     indexed attribute therefore builds the tree bottom-up with
+ *     completely filled nodes, and each append rewrites only the new
+ *     pair and the node header.
+ *
+ *     A small cache of recently used nodes keeps the upper levels of
+ *     the tree in RAM. Writes go through the cache to the storage.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "cfs/cfs.h"
+#include "lib/memb.h"
+
+#include "db-options.h"
+#include "index.h"
+#include "result.h"
+#include "storage.h"
+
+#define DEBUG DEBUG_NONE
+#include "net/ipv6/uip-debug.h"
+
+#define BPLUSTREE_ORDER		DB_BPLUSTREE_ORDER
+#define NODE_LIMIT		DB_BPLUSTREE_NODE_LIMIT
+#define MAX_HEIGHT		8
+#define NO_NODE			0xffff
+
+#if BPLUSTREE_ORDER < 4 || BPLUSTREE_ORDER > 255
+#error "DB_BPLUSTREE_ORDER must be between 4 and 255."
+#endif
+
+typedef long bplustree_key_t;
+typedef uint16_t node_id_t;
+
+struct pair {
+  bplustree_key_t key;
+  tuple_id_t value;
+};
+
+struct node {
+  node_id_t next;
+  uint8_t leaf;
+  uint8_t count;
+  struct pair pairs[BPLUSTREE_ORDER];
+};
+typedef struct node node_t;
+
+struct tree_header {
+  node_id_t root;
+  node_id_t node_count;
+  uint8_t height;
+};
+
+struct tree {
+  db_storage_id_t storage;
+  struct tree_header header;
+};
+typedef struct tree tree_t;
+
+struct node_cache {
+  tree_t *tree;
+  node_id_t node_id;
+  uint8_t age;
+  node_t node;
+};
+
+/* The position of the next pair to return in a range iteration. */
+struct cursor {
+  index_iterator_t *iterator;
+  node_id_t node_id;
+  uint8_t position;
+};
+
+static struct node_cache node_cache[DB_BPLUSTREE_CACHE_LIMIT];
+static struct cursor cursor;
+MEMB(trees, tree_t, DB_BPLUSTREE_INDEX_LIMIT);
+
+static db_result_t create(index_t *);
+static db_result_t destroy(index_t *);
+static db_result_t load(index_t *);
+static db_result_t release(index_t *);
+static db_result_t insert(index_t *, attribute_value_t *, tuple_id_t);
+static db_result_t delete(index_t *, attribute_value_t *);
+static tuple_id_t get_next(index_iterator_t *);
+
+index_api_t index_bplustree = {
+  INDEX_BPLUSTREE,
+  INDEX_API_EXTERNAL | INDEX_API_RANGE_QUERIES,
+  create,
+  destroy,
+  load,
+  release,
+  insert,
+  delete,
+  get_next
+};
+
+static unsigned long
+node_offset(node_id_t node_id)
+{
+  return sizeof(struct tree_header) + (unsigned long)node_id * sizeof(node_t);
+}
+
+static struct node_cache *
+cache_lookup(tree_t *tree, node_id_t node_id)
+{
+  int i;
+  struct node_cache *entry;
+
+  entry = NULL;
+  for(i = 0; i < DB_BPLUSTREE_CACHE_LIMIT; i++) {
+    if(node_cache[i].tree == tree && node_cache[i].node_id == node_id) {
+      entry = &node_cache[i];
+    } else if(node_cache[i].age < 255) {
+      node_cache[i].age++;
+    }
+  }
+
+  if(entry != NULL) {
+    entry->age = 0;
+  }
+  return entry;
+}
+
+static struct node_cache *
+cache_victim(void)
+{
+  int i;
+  struct node_cache *victim;
+
+  victim = &node_cache[0];
+  for(i = 0; i < DB_BPLUSTREE_CACHE_LIMIT; i++) {
+    if(node_cache[i].tree == NULL) {
+      return &node_cache[i];
+    }
+    if(node_cache[i].age > victim->age) {
+      victim = &node_cache[i];
+    }
+  }
+  return victim;
+}
+
+static void
+cache_invalidate(tree_t *tree)
+{
+  int i;
+
+  for(i = 0; i < DB_BPLUSTREE_CACHE_LIMIT; i++) {
+    if(node_cache[i].tree == tree) {
+      node_cache[i].tree = NULL;
+    }
+  }
+}
+
+static node_t *
+node_read(tree_t *tree, node_id_t node_id)
+{
+  struct node_cache *entry;
+
+  entry = cache_lookup(tree, node_id);
+  if(entry != NULL) {
+    return &entry->node;
+  }
+
+  entry = cache_victim();
+  entry->tree = NULL;
+  if(DB_ERROR(storage_read(tree->storage, &entry->node,
+                           node_offset(node_id), sizeof(node_t)))) {
+    PRINTF("DB: Failed to read B+-tree node %u\n", (unsigned)node_id);
+    return NULL;
+  }
+
+  entry->tree = tree;
+  entry->node_id = node_id;
+  entry->age = 0;
+  return &entry->node;
+}
+
+/*
+ * Write a node, and update its cached copy if there is one. If only
+ * the pair at position "pair" has changed along with the node header,
+ * just those bytes are written, which keeps appends to a leaf cheap on
+ * flash. Nodes that are not cached are written around the cache, so
+ * that writing a new node never evicts a node that is being modified.
+ */
+static int
+node_write(tree_t *tree, node_id_t node_id, node_t *node, int pair)
+{
+  struct node_cache *entry;
+  unsigned long offset;
+  db_result_t result;
+
+  entry = cache_lookup(tree, node_id);
+  if(entry != NULL && &entry->node != node) {
+    memcpy(&entry->node, node, sizeof(node_t));
+  }
+
+  offset = node_offset(node_id);
+  if(pair >= 0) {
+    result = storage_write(tree->storage, &node->pairs[pair],
+                           offset + offsetof(node_t, pairs) +
+                           pair * sizeof(struct pair), sizeof(struct pair));
+    if(!DB_ERROR(result)) {
+      result = storage_write(tree->storage, node, offset,
+                             offsetof(node_t, pairs));
+    }
+  } else {
+    result = storage_write(tree->storage, node, offset, sizeof(node_t));
+  }
+
+  if(DB_ERROR(result)) {
+    PRINTF("DB: Failed to write B+-tree node %u\n", (unsigned)node_id);
+    if(entry != NULL) {
+      entry->tree = NULL;
+    }
+    return 0;
+  }
+  return 1;
+}
+
+static int
+header_write(tree_t *tree)
+{
+  return !DB_ERROR(storage_write(tree->storage, &tree->header, 0,
+                                 sizeof(tree->header)));
+}
+
+/* Find the first pair whose key is greater than the given key. */
+static int
+upper_bound(node_t *node, bplustree_key_t key)
+{
+  int low;
+  int high;
+  int middle;
+
+  low = 0;
+  high = node->count;
+  while(low < high) {
+    middle = (low + high) / 2;
+    if(node->pairs[middle].key <= key) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+/* Find the first pair whose key is not less than the given key. */
+static int
+lower_bound(node_t *node, bplustree_key_t key)
+{
+  int low;
+  int high;
+  int middle;
+
+  low = 0;
+  high = node->count;
+  while(low < high) {
+    middle = (low + high) / 2;
+    if(node->pairs[middle].key < key) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+/*
+ * Insert a pair at a position of a full node, and move the upper part
+ * of the pairs into an empty node. If "append" is set, the pair is
+ * placed alone in the new node, which keeps the old node full.
+ */
+static void
+split_node(node_t *left, node_t *right, int position, struct pair *pair,
+           int append)
+{
+  int total;
+  int split;
+  int i;
+
+  total = left->count + 1;
+  split = append ? left->count : total / 2;
+
+  right->leaf = left->leaf;
+  right->count = total - split;
+  for(i = split; i < total; i++) {
+    if(i < position) {
+      right->pairs[i - split] = left->pairs[i];
+    } else if(i == position) {
+      right->pairs[i - split] = *pair;
+    } else {
+      right->pairs[i - split] = left->pairs[i - 1];
+    }
+  }
+
+  if(position < split) {
+    for(i = split - 1; i > position; i--) {
+      left->pairs[i] = left->pairs[i - 1];
+    }
+    left->pairs[position] = *pair;
+  }
+  left->count = split;
+}
+
+static int
+tree_insert(tree_t *tree, bplustree_key_t key, tuple_id_t value)
+{
+  node_id_t path[MAX_HEIGHT];
+  uint8_t positions[MAX_HEIGHT];
+  node_id_t node_id;
+  node_id_t new_id;
+  node_t *node;
+  node_t new_node;
+  struct pair pair;
+  int level;
+  int position;
+  int rightmost;
+  int i;
+
+  /* Descend to the leaf that should hold the key. */
+  node_id = tree->header.root;
+  rightmost = 1;
+  for(level = 0; level < tree->header.height - 1; level++) {
+    node = node_read(tree, node_id);
+    if(node == NULL) {
+      return 0;
+    }
+    position = upper_bound(node, key);
+    if(position > 0) {
+      position--;
+    }
+    if(position != node->count - 1) {
+      rightmost = 0;
+    }
+    path[level] = node_id;
+    positions[level] = position;
+    node_id = node->pairs[position].value;
+  }
+
+  pair.key = key;
+  pair.value = value;
+
+  for(;;) {
+    node = node_read(tree, node_id);
+    if(node == NULL) {
+      return 0;
+    }
+
+    if(level == tree->header.height - 1) {
+      position = upper_bound(node, key);
+    } else {
+      position = positions[level] + 1;
+    }
+
+    if(node->count < BPLUSTREE_ORDER) {
+      for(i = node->count; i > position; i--) {
+        node->pairs[i] = node->pairs[i - 1];
+      }
+      node->pairs[position] = pair;
+      node->count++;
+      if(!node_write(tree, node_id, node,
+                     position == node->count - 1 ? position : -1)) {
+        return 0;
+      }
+      /* Record the nodes allocated by any splits below this level. */
+      return level == tree->header.height - 1 || header_write(tree);
+    }
+
+    /* The node is full: move half of it, or just the new pair if it
+       belongs at the right edge of the tree, into a new node. */
+    if(tree->header.node_count >= NODE_LIMIT) {
+      PRINTF("DB: The B+-tree has no more nodes available\n");
+      return 0;
+    }
+    new_id = tree->header.node_count++;
+
+    split_node(node, &new_node, position, &pair,
+               rightmost && position == node->count);
+    if(node->leaf) {
+      new_node.next = node->next;
+      node->next = new_id;
+    } else {
+      new_node.next = NO_NODE;
+    }
+
+    pair.key = new_node.pairs[0].key;
+    pair.value = new_id;
+
+    /* Write the new node before the node that refers to it. */
+    if(!node_write(tree, new_id, &new_node, -1) ||
+       !node_write(tree, node_id, node, -1)) {
+      return 0;
+    }
+
+    if(level == 0) {
+      break;
+    }
+    node_id = path[--level];
+  }
+
+  /* The root was split; grow the tree by one level. */
+  if(tree->header.height >= MAX_HEIGHT ||
+     tree->header.node_count >= NODE_LIMIT) {
+    PRINTF("DB: Unable to grow the B+-tree\n");
+    return 0;
+  }
+  new_id = tree->header.node_count++;
+
+  new_node.next = NO_NODE;
+  new_node.leaf = 0;
+  new_node.count = 2;
+  new_node.pairs[0].key = node->pairs[0].key;
+  new_node.pairs[0].value = tree->header.root;
+  new_node.pairs[1] = pair;
+  if(!node_write(tree, new_id, &new_node, -1)) {
+    return 0;
+  }
+
+  tree->header.root = new_id;
+  tree->header.height++;
+
+  return header_write(tree);
+}
+
+/*
+ * Find the first leaf that may contain a key that is equal to or
+ * greater than the given key. Duplicates of a key may span several
+ * leaves, so the descent follows the last child whose lower bound is
+ * strictly less than the key.
+ */
+static node_id_t
+tree_find_leaf(tree_t *tree, bplustree_key_t key)
+{
+  node_id_t node_id;
+  node_t *node;
+  int level;
+  int position;
+
+  node_id = tree->header.root;
+  for(level = 0; level < tree->header.height - 1; level++) {
+    node = node_read(tree, node_id);
+    if(node == NULL) {
+      return NO_NODE;
+    }
+    position = lower_bound(node, key);
+    if(position > 0) {
+      position--;
+    }
+    node_id = node->pairs[position].value;
+  }
+
+  return node_id;
+}
+
+static int
+tree_init(tree_t *tree)
+{
+  node_t root;
+
+  memset(&root, 0, sizeof(root));
+  root.next = NO_NODE;
+  root.leaf = 1;
+
+  tree->header.root = 0;
+  tree->header.node_count = 1;
+  tree->header.height = 1;
+
+  return node_write(tree, 0, &root, -1) && header_write(tree);
+}
+
+static db_result_t
+create(index_t *index)
+{
+  char *filename;
+  tree_t *tree;
+
+  filename = storage_generate_file("bptree",
+                                   node_offset(NODE_LIMIT));
+  if(filename == NULL) {
+    PRINTF("DB: Failed to generate a B+-tree file\n");
+    return DB_INDEX_ERROR;
+  }
+
+  memcpy(index->descriptor_file, filename, sizeof(index->descriptor_file));
+
+  index->opaque_data = tree = memb_alloc(&trees);
+  if(tree == NULL) {
+    PRINTF("DB: Failed to allocate a B+-tree\n");
+    cfs_remove(index->descriptor_file);
+    index->descriptor_file[0] = '\0';
+    return DB_ALLOCATION_ERROR;
+  }
+
+  tree->storage = storage_open(index->descriptor_file);
+  if(tree->storage < 0 || !tree_init(tree)) {
+    if(tree->storage >= 0) {
+      storage_close(tree->storage);
+    }
+    memb_free(&trees, tree);
+    cfs_remove(index->descriptor_file);
+    index->descriptor_file[0] = '\0';
+    return DB_STORAGE_ERROR;
+  }
+
+  PRINTF("DB: Created a B+-tree index in %s\n", index->descriptor_file);
+
+  return DB_OK;
+}
+
+static db_result_t
+destroy(index_t *index)
+{
+  /* The index has already been released by the index component. */
+  cfs_remove(index->descriptor_file);
+  return DB_OK;
+}
+
+static db_result_t
+load(index_t *index)
+{
+  tree_t *tree;
+
+  index->opaque_data = tree = memb_alloc(&trees);
+  if(tree == NULL) {
+    PRINTF("DB: Failed to allocate a B+-tree\n");
+    return DB_ALLOCATION_ERROR;
+  }
+
+  tree->storage = storage_open(index->descriptor_file);
+  if(tree->storage < 0) {
+    memb_free(&trees, tree);
+    return DB_STORAGE_ERROR;
+  }
+
+  if(DB_ERROR(storage_read(tree->storage, &tree->header, 0,
+                           sizeof(tree->header)))) {
+    storage_close(tree->storage);
+    memb_free(&trees, tree);
+    return DB_STORAGE_ERROR;
+  }
+
+  PRINTF("DB: Loaded a B+-tree index of height %u with %u nodes from %s\n",
+         (unsigned)tree->header.height, (unsigned)tree->header.node_count,
+         index->descriptor_file);
+
+  return DB_OK;
+}
+
+static db_result_t
+release(index_t *index)
+{
+  tree_t *tree;
+
+  tree = index->opaque_data;
+
+  cache_invalidate(tree);
+  if(cursor.iterator != NULL && cursor.iterator->index == index) {
+    cursor.iterator = NULL;
+  }
+  storage_close(tree->storage);
+  memb_free(&trees, tree);
+
+  return DB_OK;
+}
+
+static db_result_t
+insert(index_t *index, attribute_value_t *key, tuple_id_t value)
+{
+  if(!tree_insert(index->opaque_data, db_value_to_long(key), value)) {
+    PRINTF("DB: Failed to insert key %ld into a B+-tree index\n",
+           db_value_to_long(key));
+    return DB_INDEX_ERROR;
+  }
+
+  return DB_OK;
+}
+
+/*
+ * Remove the first pair with the given key. Nodes are not merged when
+ * they become sparse, because the space in the index file is not
+ * reclaimed anyway.
+ */
+static db_result_t
+delete(index_t *index, attribute_value_t *value)
+{
+  tree_t *tree;
+  bplustree_key_t key;
+  node_id_t node_id;
+  node_t *node;
+  int position;
+  int i;
+
+  tree = index->opaque_data;
+  key = db_value_to_long(value);
+
+  for(node_id = tree_find_leaf(tree, key); node_id != NO_NODE;
+      node_id = node->next) {
+    node = node_read(tree, node_id);
+    if(node == NULL) {
+      return DB_STORAGE_ERROR;
+    }
+
+    position = lower_bound(node, key);
+    if(position < node->count) {
+      if(node->pairs[position].key != key) {
+        break;
+      }
+      for(i = position + 1; i < node->count; i++) {
+        node->pairs[i - 1] = node->pairs[i];
+      }
+      node->count--;
+      return node_write(tree, node_id, node, -1) ? DB_OK : DB_STORAGE_ERROR;
+    }
+  }
+
+  return DB_INDEX_ERROR;
+}
+
+static tuple_id_t
+get_next(index_iterator_t *iterator)
+{
+  tree_t *tree;
+  node_t *node;
+  bplustree_key_t min;
+  bplustree_key_t max;
+  tuple_id_t skip;
+
+  tree = iterator->index->opaque_data;
+  min = db_value_to_long(&iterator->min_value);
+  max = db_value_to_long(&iterator->max_value);
+
+  skip = 0;
+  if(cursor.iterator != iterator || iterator->next_item_no == 0) {
+    /*
+     * Position the cursor at the first key in the range. If another
+     * iteration has used the cursor in the meantime, the items that
+     * this iteration already returned are skipped.
+     */
+    cursor.iterator = iterator;
+    cursor.node_id = tree_find_leaf(tree, min);
+    cursor.position = 0;
+    skip = iterator->next_item_no;
+  }
+
+  while(cursor.node_id != NO_NODE) {
+    node = node_read(tree, cursor.node_id);
+    if(node == NULL) {
+      break;
+    }
+
+    if(cursor.position >= node->count) {
+      cursor.node_id = node->next;
+      cursor.position = 0;
+      continue;
+    }
+
+    if(node->pairs[cursor.position].key < min) {
+      cursor.position = lower_bound(node, min);
+      continue;
+    }
+
+    if(node->pairs[cursor.position].key > max) {
+      break;
+    }
+
+    if(skip > 0) {
+      skip--;
+      cursor.position++;
+      continue;
+    }
+
+    iterator->next_item_no++;
+    return node->pairs[cursor.position++].value;
+  }
+
+  cursor.iterator = NULL;
+  return INVALID_TUPLE;
+}
@@ -49,7 +49,11 @@
 #include "storage.h"
 
 static index_api_t *index_components[] = {&index_inline,
-	&index_maxheap};
+	&index_maxheap
+#if DB_FEATURE_BPLUSTREE
+	, &index_bplustree
+#endif /* DB_FEATURE_BPLUSTREE */
+	};
 
 LIST(indices);
 MEMB(index_memb, index_t, DB_INDEX_POOL_SIZE);
@@ -388,7 +392,7 @@ PROCESS_THREAD(db_indexer, ev, data)
       continue;
     }
 
-    for(;; row++) {
+    for(row = 0;; row++) {
       PROCESS_PAUSE();
 
       result = db_process(&handle);
@@ -68,6 +68,15 @@ struct source_dest_map {
 
 static struct source_dest_map attr_map[AQL_ATTRIBUTE_LIMIT];
 
+/*
+ * The part of a source row that holds the attributes referenced by the
+ * current selection. Only this part is read from storage, so that
+ * attributes that are neither projected nor used in the condition
+ * do not cost any I/O.
+ */
+static unsigned row_part_offset;
+static unsigned row_part_length;
+
 #if DB_FEATURE_JOIN
 /*
  * The source_map structure is used for mapping attributes to
@@ -568,9 +577,9 @@ aggregate(attribute_t *attr, attribute_value_t *value)
     attr->aggregation_value++;
     break;
   case AQL_SUM:
-    attr->aggregation_value += long_value;
-    break;
   case AQL_MEAN:
+    /* The mean is derived from the sum when the aggregation ends. */
+    attr->aggregation_value += long_value;
     break;
   case AQL_MEDIAN:
     break;
@@ -655,7 +664,8 @@ select_index(db_handle_t *handle, lvm_instance_t *lvm_instance)
 
       if(range <= min_range) {
         index = attr->index;
-        av_min.domain = av_max.domain = DOMAIN_INT;
+        min_range = range;
+        av_min.domain = av_max.domain = DOMAIN_LONG;
         VALUE_LONG(&av_min) = min.l;
         VALUE_LONG(&av_max) = max.l;
       }
@@ -677,6 +687,8 @@ generate_selection_result(db_handle_t *handle, relation_t *rel, aql_adt_t *adt)
   relation_t *result_rel;
   unsigned attribute_count;
   attribute_t *attr;
+  struct source_dest_map *attr_map_ptr;
+  unsigned end;
 
   result_rel = handle->result_rel;
 
@@ -696,7 +708,30 @@ generate_selection_result(db_handle_t *handle, relation_t *rel, aql_adt_t *adt)
     return DB_IMPLEMENTATION_ERROR;
   }
 
-  if(adt->lvm_instance != NULL) {
+  /* Push the projection down to the storage layer by reading only
+     the span of the row that covers the referenced attributes. */
+  row_part_offset = rel->row_length;
+  end = 0;
+  for(attr_map_ptr = attr_map;
+      attr_map_ptr < attr_map + attribute_count;
+      attr_map_ptr++) {
+    if(attr_map_ptr->from_offset < row_part_offset) {
+      row_part_offset = attr_map_ptr->from_offset;
+    }
+    if(attr_map_ptr->from_offset + attr_map_ptr->from_attr->element_size > end) {
+      end = attr_map_ptr->from_offset + attr_map_ptr->from_attr->element_size;
+    }
+  }
+  if(end <= row_part_offset) {
+    row_part_offset = 0;
+    end = rel->row_length;
+  }
+  row_part_length = end - row_part_offset;
+
+  /* An index can only narrow down the tuples that fulfil the condition,
+     so it is of no use when the condition is inverted for a removal. */
+  if(adt->lvm_instance != NULL &&
+     !(AQL_GET_FLAGS(adt) & AQL_FLAG_INVERSE_LOGIC)) {
     /* Try to establish acceptable ranges for the attribute values. */
     if(!LVM_ERROR(lvm_derive(adt->lvm_instance))) {
       select_index(handle, adt->lvm_instance);
@@ -741,9 +776,7 @@ relation_process_select(void *handle_ptr)
   struct source_dest_map *attr_map_ptr, *attr_map_end;
   attribute_t *result_attr;
   unsigned char *from_ptr;
-  unsigned char *to_ptr;
   operand_value_t operand_value;
-  uint8_t intbuf[2];
   attribute_value_t value;
   lvm_status_t wanted_result;
 
@@ -757,7 +790,8 @@ relation_process_select(void *handle_ptr)
     handle->tuple_id = index_get_next(&handle->index_iterator);
     if(handle->tuple_id == INVALID_TUPLE) {
       PRINTF("DB: An attribute value could not be found in the index\n");
-      if(handle->index_iterator.next_item_no == 0) {
+      if(handle->index_iterator.next_item_no == 0 &&
+         !(handle->index_iterator.index->api->flags & INDEX_API_RANGE_QUERIES)) {
         return DB_INDEX_ERROR;
       }
 
@@ -771,7 +805,8 @@ relation_process_select(void *handle_ptr)
 
   /* Put the tuples fulfilling the given condition into a new relation.
      The tuples may be projected. */
-  result = storage_get_row(handle->rel, &handle->tuple_id, row);
+  result = storage_get_row_part(handle->rel, &handle->tuple_id, row,
+                                row_part_offset, row_part_length);
   handle->tuple_id++;
   if(DB_ERROR(result)) {
     PRINTF("DB: Failed to get a row in relation %s!\n", handle->rel->name);
@@ -789,14 +824,14 @@ relation_process_select(void *handle_ptr)
     result_attr = attr_map_ptr->to_attr;
 
     /* Update the internal state of the PLE. */
-    if(result_attr->domain == DOMAIN_INT) {
-      operand_value.l = from_ptr[0] << 8 | from_ptr[1];
+    if(attr_map_ptr->from_attr->domain == DOMAIN_INT) {
+      operand_value.l = (int16_t)(from_ptr[0] << 8 | from_ptr[1]);
       lvm_set_variable_value(result_attr->name, operand_value);
-    } else if(result_attr->domain == DOMAIN_LONG) {
-      operand_value.l = (uint32_t)from_ptr[0] << 24 |
-                        (uint32_t)from_ptr[1] << 16 |
-                        (uint32_t)from_ptr[2] << 8 |
-                        from_ptr[3];
+    } else if(attr_map_ptr->from_attr->domain == DOMAIN_LONG) {
+      operand_value.l = (int32_t)((uint32_t)from_ptr[0] << 24 |
+                                  (uint32_t)from_ptr[1] << 16 |
+                                  (uint32_t)from_ptr[2] << 8 |
+                                  from_ptr[3]);
       lvm_set_variable_value(result_attr->name, operand_value);
     }
 
@@ -822,9 +857,15 @@ relation_process_select(void *handle_ptr)
   if(adt->lvm_instance == NULL ||
      lvm_execute(adt->lvm_instance) == wanted_result) {
     if(AQL_GET_FLAGS(adt) & AQL_FLAG_AGGREGATE) {
+      /* Aggregates are computed while scanning, so the matching tuples
+         are never stored. The current row counts the matches. */
+      handle->current_row++;
       for(attr_map_ptr = attr_map; attr_map_ptr < attr_map_end; attr_map_ptr++) {
+        if(attr_map_ptr->to_attr->aggregator == AQL_NONE) {
+          continue;
+        }
         from_ptr = row + attr_map_ptr->from_offset;
-        result = db_phy_to_value(&value, attr_map_ptr->to_attr, from_ptr);
+        result = db_phy_to_value(&value, attr_map_ptr->from_attr, from_ptr);
         if(DB_ERROR(result)) {
 	  return result;
         }
@@ -848,12 +889,16 @@ end_aggregation:
   /* Generate aggregated result if requested. */
   for(attr_map_ptr = attr_map; attr_map_ptr < attr_map_end; attr_map_ptr++) {
     result_attr = attr_map_ptr->to_attr;
-    to_ptr = result_row + attr_map_ptr->to_offset;
+    if(result_attr->flags & ATTRIBUTE_FLAG_NO_STORE) {
+      continue;
+    }
 
-    intbuf[0] = result_attr->aggregation_value >> 8;
-    intbuf[1] = result_attr->aggregation_value & 0xff;
-    from_ptr = intbuf;
-    memcpy(to_ptr, from_ptr, result_attr->element_size);
+    value.domain = DOMAIN_LONG;
+    VALUE_LONG(&value) = result_attr->aggregation_value;
+    if(result_attr->aggregator == AQL_MEAN && handle->current_row > 0) {
+      VALUE_LONG(&value) /= (long)handle->current_row;
+    }
+    db_value_to_phy(result_row + attr_map_ptr->to_offset, result_attr, &value);
   }
 
   if(AQL_GET_FLAGS(adt) & AQL_FLAG_ASSIGN) {
@@ -880,6 +925,7 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
   attribute_t *attr;
   int i;
   int normal_attributes;
+  int aggregated_attributes;
 
   adt = (aql_adt_t *)adt_ptr;
 
@@ -903,7 +949,8 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
     return DB_ALLOCATION_ERROR;
   }
 
-  for(i = normal_attributes = 0; i < AQL_ATTRIBUTE_COUNT(adt); i++) {
+  normal_attributes = aggregated_attributes = 0;
+  for(i = 0; i < AQL_ATTRIBUTE_COUNT(adt); i++) {
     attribute_name = adt->attributes[i].name;
 
     attr = relation_attribute_get(rel, attribute_name);
@@ -916,10 +963,12 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
     PRINTF("DB: Found attribute %s in relation %s\n",
 	attribute_name, rel->name);
 
+    /* Aggregated values are stored as long integers, regardless of
+       the domain of the attribute that they are computed from. */
     attr = relation_attribute_add(handle->result_rel, dir,
 				  attribute_name, 
-				  adt->aggregators[i] ? DOMAIN_INT : attr->domain,
-				  attr->element_size);
+				  adt->aggregators[i] ? DOMAIN_LONG : attr->domain,
+				  adt->aggregators[i] ? 4 : attr->element_size);
     if(attr == NULL) {
       PRINTF("DB: Failed to add a result attribute\n");
       relation_release(handle->result_rel);
@@ -935,12 +984,15 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
       }
       break;
     case AQL_MAX:
+      aggregated_attributes++;
       attr->aggregation_value = LONG_MIN;
       break;
     case AQL_MIN:
+      aggregated_attributes++;
       attr->aggregation_value = LONG_MAX;
       break;
     default:
+      aggregated_attributes++;
       attr->aggregation_value = 0;
       break;
     }
@@ -949,9 +1001,9 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
   }
 
   /* Preclude mixes of normal attributes and aggregated ones in 
-     selection results. */
-  if(normal_attributes > 0 &&
-     handle->result_rel->attribute_count > normal_attributes) {
+     selection results. Attributes that are only used in the condition
+     may accompany either kind. */
+  if(normal_attributes > 0 && aggregated_attributes > 0) {
      return DB_RELATIONAL_ERROR;
   }
 
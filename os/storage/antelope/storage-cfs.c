@@ -402,6 +402,18 @@ storage_put_index(index_t *index)
 
 db_result_t
 storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
+{
+  return storage_get_row_part(rel, tuple_id, row, 0, rel->row_length);
+}
+
+/*
+ * Read only the given byte range of a row, and place it at the same
+ * offset in the row buffer. This lets a selection skip the attributes
+ * that it does not reference.
+ */
+db_result_t
+storage_get_row_part(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row,
+                     unsigned offset, unsigned length)
 {
   int r;
   tuple_id_t nrows;
@@ -414,25 +426,31 @@ storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
     return DB_FINISHED;
   }
 
-  if(cfs_seek(rel->tuple_storage, *tuple_id * rel->row_length, CFS_SEEK_SET) ==
-              (cfs_offset_t)-1) {
+  if(length == 0 || offset + length > rel->row_length) {
+    return DB_ARGUMENT_ERROR;
+  }
+
+  if(cfs_seek(rel->tuple_storage, *tuple_id * rel->row_length + offset,
+              CFS_SEEK_SET) == (cfs_offset_t)-1) {
     return DB_STORAGE_ERROR;
   }
 
-  r = cfs_read(rel->tuple_storage, row, rel->row_length);
+  r = cfs_read(rel->tuple_storage, row + offset, length);
   if(r < 0) {
     PRINTF("DB: Reading failed on fd %d\n", rel->tuple_storage);
     return DB_STORAGE_ERROR;
   } else if(r == 0) {
     return DB_FINISHED;
-  } else if(r < rel->row_length) {
-    PRINTF("DB: Incomplete record: %d < %d\n", r, rel->row_length);
+  } else if(r < length) {
+    PRINTF("DB: Incomplete record: %d < %u\n", r, length);
     return DB_STORAGE_ERROR;
   }
 
-  row[rel->row_length - 1] ^= ROW_XOR;
+  if(offset + length == rel->row_length) {
+    row[rel->row_length - 1] ^= ROW_XOR;
+  }
 
-  PRINTF("DB: Read %d bytes from relation %s\n", rel->row_length, rel->name);
+  PRINTF("DB: Read %u bytes from relation %s\n", length, rel->name);
 
   return DB_OK;
 }
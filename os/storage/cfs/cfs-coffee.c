@@ -84,6 +84,78 @@
 #define COFFEE_EXTENDED_WEAR_LEVELLING  1
 #endif
 
+/*
+ * Keep an index in RAM that maps hashed file names to the pages at
+ * which the files start. The index is built by a single scan of the
+ * storage when a file is first looked up. After that, opening a file
+ * requires reading only the headers of files whose names have the same
+ * hash, and looking up a file that does not exist requires no reads.
+ */
+#ifndef COFFEE_NAME_INDEX
+#ifdef COFFEE_CONF_NAME_INDEX
+#define COFFEE_NAME_INDEX COFFEE_CONF_NAME_INDEX
+#else
+#define COFFEE_NAME_INDEX 0
+#endif
+#endif
+
+/* The number of files that the name index can hold. Lookups of files
+   beyond this number fall back to scanning the storage. */
+#ifndef COFFEE_NAME_INDEX_SIZE
+#ifdef COFFEE_CONF_NAME_INDEX_SIZE
+#define COFFEE_NAME_INDEX_SIZE COFFEE_CONF_NAME_INDEX_SIZE
+#else
+#define COFFEE_NAME_INDEX_SIZE 16
+#endif
+#endif
+
+/*
+ * Collect garbage from a background process once files have been
+ * removed, instead of leaving the work to the reservation that runs out
+ * of space. With COFFEE_EXTENDED_WEAR_LEVELLING, the collection is
+ * deferred until fewer than COFFEE_BACKGROUND_GC_FREE_SECTORS sectors
+ * remain past the allocation point, so that erasures still rotate
+ * through the whole storage. The number of erasures of each sector is
+ * also counted.
+ */
+#ifndef COFFEE_BACKGROUND_GC
+#ifdef COFFEE_CONF_BACKGROUND_GC
+#define COFFEE_BACKGROUND_GC COFFEE_CONF_BACKGROUND_GC
+#else
+#define COFFEE_BACKGROUND_GC 0
+#endif
+#endif
+
+#ifndef COFFEE_BACKGROUND_GC_FREE_SECTORS
+#ifdef COFFEE_CONF_BACKGROUND_GC_FREE_SECTORS
+#define COFFEE_BACKGROUND_GC_FREE_SECTORS COFFEE_CONF_BACKGROUND_GC_FREE_SECTORS
+#else
+#define COFFEE_BACKGROUND_GC_FREE_SECTORS 2
+#endif
+#endif
+
+/*
+ * Collect consecutive small appends through a file descriptor in a RAM
+ * buffer of this size, and write them to the storage as one. Only writes
+ * at the end of a file that has no micro log, or writes through a
+ * descriptor with CFS_COFFEE_IO_FLASH_AWARE semantics, are buffered.
+ * Files with a micro log are out of scope: their writes always go to
+ * the storage directly, one log record per cfs_write().
+ * The buffer is written out by the next call to any other Coffee
+ * function, or when the system becomes idle. If that fails, the next
+ * cfs_write() or cfs_seek() on the descriptor returns -1. A size of zero
+ * disables the buffer.
+ */
+#ifndef COFFEE_WRITE_BUFFER_SIZE
+#ifdef COFFEE_CONF_WRITE_BUFFER_SIZE
+#define COFFEE_WRITE_BUFFER_SIZE COFFEE_CONF_WRITE_BUFFER_SIZE
+#else
+#define COFFEE_WRITE_BUFFER_SIZE 0
+#endif
+#endif
+
+#define COFFEE_PROCESS (COFFEE_BACKGROUND_GC || COFFEE_WRITE_BUFFER_SIZE > 0)
+
 #if COFFEE_START & (COFFEE_SECTOR_SIZE - 1)
 #error COFFEE_START must point to the first byte in a sector.
 #endif
@@ -93,6 +165,7 @@
 #define COFFEE_FD_READ    0x1
 #define COFFEE_FD_WRITE   0x2
 #define COFFEE_FD_APPEND  0x4
+#define COFFEE_FD_WRITE_FAILED 0x80
 
 /* File object flags. */
 #define COFFEE_FILE_MODIFIED  0x1
@@ -112,6 +185,11 @@
 /* "Reluctant" garbage collection stops after erasing one sector. */
 #define GC_RELUCTANT      1
 
+/* Name index states. */
+#define NAME_INDEX_UNBUILT  0 /* Must be built before use. */
+#define NAME_INDEX_COMPLETE 1 /* Holds all files. */
+#define NAME_INDEX_PARTIAL  2 /* Some files did not fit. */
+
 /* File descriptor macros. */
 #define FD_VALID(fd)      ((fd) >= 0 && (fd) < COFFEE_FD_SET_SIZE && \
                            coffee_fd_set[(fd)].flags != COFFEE_FD_FREE)
@@ -158,6 +236,8 @@ struct sector_status {
   coffee_page_t active;
   coffee_page_t obsolete;
   coffee_page_t free;
+  /* Set if the sector starts within a file extent from a previous sector. */
+  uint8_t continued;
 };
 
 /* The structure of cached file objects. */
@@ -206,6 +286,44 @@ static struct file_desc coffee_fd_set[COFFEE_FD_SET_SIZE];
 static coffee_page_t next_free;
 static char gc_wait;
 
+#if COFFEE_NAME_INDEX
+struct name_index_entry {
+  uint16_t hash;
+  coffee_page_t page;
+};
+
+static struct name_index_entry name_index[COFFEE_NAME_INDEX_SIZE];
+static unsigned name_index_count;
+static uint8_t name_index_state;
+#endif /* COFFEE_NAME_INDEX */
+
+#if COFFEE_BACKGROUND_GC
+static uint16_t sector_erases[COFFEE_SECTOR_COUNT];
+static char gc_pending;
+#endif /* COFFEE_BACKGROUND_GC */
+
+#if COFFEE_WRITE_BUFFER_SIZE > 0
+static struct {
+  int fd;
+  uint16_t length;
+  char data[COFFEE_WRITE_BUFFER_SIZE];
+} write_buffer;
+#endif /* COFFEE_WRITE_BUFFER_SIZE > 0 */
+
+#if COFFEE_PROCESS
+PROCESS(coffee_process, "Coffee");
+#endif /* COFFEE_PROCESS */
+
+#if COFFEE_WRITE_BUFFER_SIZE > 0
+static int flush_write_buffer(void);
+static int write_failed(int fd);
+#define FLUSH_WRITE_BUFFER() flush_write_buffer()
+#define WRITE_FAILED(fd)     write_failed(fd)
+#else
+#define FLUSH_WRITE_BUFFER()
+#define WRITE_FAILED(fd)     0
+#endif /* COFFEE_WRITE_BUFFER_SIZE > 0 */
+
 /*---------------------------------------------------------------------------*/
 static void
 write_header(struct file_header *hdr, coffee_page_t page)
@@ -254,6 +372,7 @@ get_sector_status(coffee_page_t sector, struct sector_status *stats)
 
   sector_start = sector * COFFEE_PAGES_PER_SECTOR;
   sector_end = sector_start + COFFEE_PAGES_PER_SECTOR;
+  stats->continued = skip_pages > 0;
 
   /*
    * Account for pages belonging to a file starting in a previous
@@ -349,11 +468,33 @@ isolate_pages(coffee_page_t start, coffee_page_t skip_pages)
 }
 /*---------------------------------------------------------------------------*/
 static void
+erase_sector(coffee_page_t sector, coffee_page_t isolation_count)
+{
+  coffee_page_t first_page;
+
+  first_page = sector * COFFEE_PAGES_PER_SECTOR;
+  if(first_page < next_free) {
+    next_free = first_page;
+  }
+
+  if(isolation_count > 0) {
+    isolate_pages(first_page + COFFEE_PAGES_PER_SECTOR, isolation_count);
+  }
+
+  COFFEE_ERASE(sector);
+#if COFFEE_BACKGROUND_GC
+  sector_erases[sector]++;
+#endif /* COFFEE_BACKGROUND_GC */
+  PRINTF("Coffee: Erased sector %d!\n", sector);
+}
+/*---------------------------------------------------------------------------*/
+static void
 collect_garbage(int mode)
 {
   coffee_page_t sector;
   struct sector_status stats;
-  coffee_page_t first_page, isolation_count;
+  coffee_page_t isolation_count;
+  char erased;
 
   PRINTF("Coffee: Running the garbage collector in %s mode\n",
          mode == GC_RELUCTANT ? "reluctant" : "greedy");
@@ -361,29 +502,27 @@ collect_garbage(int mode)
    * The garbage collector erases as many sectors as possible. A sector is
    * erasable if there are only free or obsolete pages in it.
    */
+  erased = 0;
   for(sector = 0; sector < COFFEE_SECTOR_COUNT; sector++) {
     isolation_count = get_sector_status(sector, &stats);
     PRINTF("Coffee: Sector %u has %u active, %u obsolete, and %u free pages.\n",
            (unsigned)sector, (unsigned)stats.active,
            (unsigned)stats.obsolete, (unsigned)stats.free);
 
-    if(stats.active > 0) {
+    /*
+     * A sector that continues a file extent can only be erased along
+     * with the previous sector. Otherwise, the header of the extent
+     * would remain and cover pages that are later allocated to new files.
+     */
+    if(stats.active > 0 || (stats.continued && !erased)) {
+      erased = 0;
       continue;
     }
 
-    if((mode == GC_RELUCTANT && stats.free == 0) ||
-       (mode == GC_GREEDY && stats.obsolete > 0)) {
-      first_page = sector * COFFEE_PAGES_PER_SECTOR;
-      if(first_page < next_free) {
-        next_free = first_page;
-      }
-
-      if(isolation_count > 0) {
-        isolate_pages(first_page + COFFEE_PAGES_PER_SECTOR, isolation_count);
-      }
-
-      COFFEE_ERASE(sector);
-      PRINTF("Coffee: Erased sector %d!\n", sector);
+    erased = (mode == GC_RELUCTANT && stats.free == 0) ||
+             (mode == GC_GREEDY && stats.obsolete > 0);
+    if(erased) {
+      erase_sector(sector, isolation_count);
 
       if(mode == GC_RELUCTANT && isolation_count > 0) {
         break;
@@ -392,6 +531,40 @@ collect_garbage(int mode)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_PROCESS
+static void
+poll_coffee_process(void)
+{
+  if(!process_is_running(&coffee_process)) {
+#if PROCESS_PRIORITIES
+    /* Flushing and garbage collection can wait for other processes. */
+    process_set_priority(&coffee_process, PROCESS_PRIO_BACKGROUND);
+#endif /* PROCESS_PRIORITIES */
+    process_start(&coffee_process, NULL);
+  }
+  process_poll(&coffee_process);
+}
+#endif /* COFFEE_PROCESS */
+/*---------------------------------------------------------------------------*/
+#if COFFEE_BACKGROUND_GC
+static void
+request_gc(void)
+{
+  /*
+   * Erasing a sector moves next_free back to it. With extended wear
+   * levelling, the obsolete pages are therefore left until the
+   * allocations approach the end of the storage, so that the sectors
+   * are reused in turn rather than the lowest ones over and over.
+   */
+  if(gc_pending &&
+     (!COFFEE_EXTENDED_WEAR_LEVELLING ||
+      next_free + COFFEE_BACKGROUND_GC_FREE_SECTORS * COFFEE_PAGES_PER_SECTOR >=
+      COFFEE_PAGE_COUNT)) {
+    poll_coffee_process();
+  }
+}
+#endif /* COFFEE_BACKGROUND_GC */
+/*---------------------------------------------------------------------------*/
 static coffee_page_t
 next_file(coffee_page_t page, struct file_header *hdr)
 {
@@ -452,12 +625,106 @@ load_file(coffee_page_t start, struct file_header *hdr)
   return file;
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_NAME_INDEX
+static uint16_t
+name_hash(const char *name)
+{
+  uint16_t hash;
+  int i;
+
+  /* Only the part of the name that fits in a file header is hashed. */
+  hash = 5381;
+  for(i = 0; i < COFFEE_NAME_LENGTH - 1 && name[i] != '\0'; i++) {
+    hash = (hash << 5) + hash + (uint8_t)name[i];
+  }
+  return hash;
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_add(const char *name, coffee_page_t page)
+{
+  if(name_index_count == COFFEE_NAME_INDEX_SIZE) {
+    if(name_index_state == NAME_INDEX_COMPLETE) {
+      name_index_state = NAME_INDEX_PARTIAL;
+    }
+    return;
+  }
+
+  name_index[name_index_count].hash = name_hash(name);
+  name_index[name_index_count].page = page;
+  name_index_count++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_remove(coffee_page_t page)
+{
+  unsigned i;
+
+  for(i = 0; i < name_index_count; i++) {
+    if(name_index[i].page == page) {
+      name_index[i] = name_index[--name_index_count];
+      /* Files that did not fit before might fit now. */
+      if(name_index_state == NAME_INDEX_PARTIAL) {
+        name_index_state = NAME_INDEX_UNBUILT;
+      }
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_build(void)
+{
+  struct file_header hdr;
+  coffee_page_t page;
+
+  name_index_count = 0;
+  name_index_state = NAME_INDEX_COMPLETE;
+
+  for(page = 0; page < COFFEE_PAGE_COUNT; page = next_file(page, &hdr)) {
+    read_header(&hdr, page);
+    if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr)) {
+      name_index_add(hdr.name, page);
+    }
+  }
+
+  PRINTF("Coffee: Indexed %u files%s\n", name_index_count,
+         name_index_state == NAME_INDEX_PARTIAL ? " (index full)" : "");
+}
+/*---------------------------------------------------------------------------*/
+static struct file *
+name_index_find(const char *name, int *found)
+{
+  struct file_header hdr;
+  uint16_t hash;
+  unsigned i;
+
+  hash = name_hash(name);
+  for(i = 0; i < name_index_count; i++) {
+    if(name_index[i].hash == hash) {
+      read_header(&hdr, name_index[i].page);
+      if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr) && strcmp(name, hdr.name) == 0) {
+        *found = 1;
+        return load_file(name_index[i].page, &hdr);
+      }
+    }
+  }
+
+  *found = 0;
+  return NULL;
+}
+#endif /* COFFEE_NAME_INDEX */
+/*---------------------------------------------------------------------------*/
 static struct file *
 find_file(const char *name)
 {
   int i;
   struct file_header hdr;
   coffee_page_t page;
+#if COFFEE_NAME_INDEX
+  struct file *file;
+  int found;
+#endif /* COFFEE_NAME_INDEX */
 
   /* First check if the file metadata is cached. */
   for(i = 0; i < COFFEE_MAX_OPEN_FILES; i++) {
@@ -471,6 +738,17 @@ find_file(const char *name)
     }
   }
 
+#if COFFEE_NAME_INDEX
+  if(name_index_state == NAME_INDEX_UNBUILT) {
+    name_index_build();
+  }
+
+  file = name_index_find(name, &found);
+  if(found || name_index_state == NAME_INDEX_COMPLETE) {
+    return file;
+  }
+#endif /* COFFEE_NAME_INDEX */
+
   /* Scan the flash memory sequentially otherwise. */
   for(page = 0; page < COFFEE_PAGE_COUNT; page = next_file(page, &hdr)) {
     read_header(&hdr, page);
@@ -575,6 +853,10 @@ remove_by_page(coffee_page_t page, int remove_log,
 
   gc_wait = 0;
 
+#if COFFEE_NAME_INDEX
+  name_index_remove(page);
+#endif /* COFFEE_NAME_INDEX */
+
   /* Close all file descriptors that reference the removed file. */
   if(close_fds) {
     for(i = 0; i < COFFEE_FD_SET_SIZE; i++) {
@@ -592,9 +874,14 @@ remove_by_page(coffee_page_t page, int remove_log,
     }
   }
 
+#if COFFEE_BACKGROUND_GC
+  gc_pending = 1;
+  request_gc();
+#else /* COFFEE_BACKGROUND_GC */
   if(!COFFEE_EXTENDED_WEAR_LEVELLING && gc_allowed) {
     collect_garbage(GC_RELUCTANT);
   }
+#endif /* COFFEE_BACKGROUND_GC */
 
   return 0;
 }
@@ -637,9 +924,19 @@ reserve(const char *name, coffee_page_t pages,
   hdr.flags = HDR_FLAG_ALLOCATED | flags;
   write_header(&hdr, page);
 
+#if COFFEE_NAME_INDEX
+  if(!(flags & HDR_FLAG_LOG)) {
+    name_index_add(hdr.name, page);
+  }
+#endif /* COFFEE_NAME_INDEX */
+
   PRINTF("Coffee: Reserved %u pages starting from %u for file %s\n",
          (unsigned)pages, (unsigned)page, name);
 
+#if COFFEE_BACKGROUND_GC
+  request_gc();
+#endif /* COFFEE_BACKGROUND_GC */
+
   file = load_file(page, &hdr);
   if(file != NULL) {
     file->end = 0;
@@ -979,6 +1276,8 @@ cfs_open(const char *name, int flags)
   int fd;
   struct file_desc *fdp;
 
+  FLUSH_WRITE_BUFFER();
+
   fd = get_available_fd();
   if(fd < 0) {
     PRINTF("Coffee: Failed to allocate a new file descriptor!\n");
@@ -1013,7 +1312,12 @@ cfs_open(const char *name, int flags)
 void
 cfs_close(int fd)
 {
+  FLUSH_WRITE_BUFFER();
+
   if(FD_VALID(fd)) {
+    if(WRITE_FAILED(fd)) {
+      PRINTF("Coffee: Lost buffered data of fd %d\n", fd);
+    }
     coffee_fd_set[fd].flags = COFFEE_FD_FREE;
     coffee_fd_set[fd].file->references--;
     coffee_fd_set[fd].file = NULL;
@@ -1026,7 +1330,9 @@ cfs_seek(int fd, cfs_offset_t offset, int whence)
   struct file_desc *fdp;
   cfs_offset_t new_offset;
 
-  if(!FD_VALID(fd)) {
+  FLUSH_WRITE_BUFFER();
+
+  if(!FD_VALID(fd) || WRITE_FAILED(fd)) {
     return -1;
   }
   fdp = &coffee_fd_set[fd];
@@ -1068,6 +1374,8 @@ cfs_remove(const char *name)
    * sweeped by the garbage collector. The garbage collector is
    * called once a file reservation request cannot be granted.
    */
+  FLUSH_WRITE_BUFFER();
+
   file = find_file(name);
   if(file == NULL) {
     return -1;
@@ -1088,6 +1396,8 @@ cfs_read(int fd, void *buf, unsigned size)
   int r;
 #endif
 
+  FLUSH_WRITE_BUFFER();
+
   if(!(FD_VALID(fd) && FD_READABLE(fd))) {
     return -1;
   }
@@ -1137,8 +1447,8 @@ cfs_read(int fd, void *buf, unsigned size)
   return size;
 }
 /*---------------------------------------------------------------------------*/
-int
-cfs_write(int fd, const void *buf, unsigned size)
+static int
+write_data(int fd, const void *buf, unsigned size)
 {
   struct file_desc *fdp;
   struct file *file;
@@ -1230,6 +1540,106 @@ cfs_write(int fd, const void *buf, unsigned size)
   return size;
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_WRITE_BUFFER_SIZE > 0
+static int
+flush_write_buffer(void)
+{
+  uint16_t length;
+
+  if(write_buffer.length == 0) {
+    return 0;
+  }
+
+  /* Empty the buffer first, since writing can reenter Coffee when the
+     file is merged with its log. */
+  length = write_buffer.length;
+  write_buffer.length = 0;
+  if(write_data(write_buffer.fd, write_buffer.data, length) != length) {
+    /* Keep the error for the next operation on the descriptor. */
+    if(FD_VALID(write_buffer.fd)) {
+      coffee_fd_set[write_buffer.fd].flags |= COFFEE_FD_WRITE_FAILED;
+    }
+    return -1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+write_failed(int fd)
+{
+  if(coffee_fd_set[fd].flags & COFFEE_FD_WRITE_FAILED) {
+    coffee_fd_set[fd].flags &= ~COFFEE_FD_WRITE_FAILED;
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+write_bufferable(struct file_desc *fdp, unsigned size)
+{
+  struct file *file;
+
+  file = fdp->file;
+
+  /* Writing the data out later must not require the file to be extended. */
+  if(write_buffer.length + size > sizeof(write_buffer.data) ||
+     fdp->offset + write_buffer.length + size + sizeof(struct file_header) >
+     file->max_pages * COFFEE_PAGE_SIZE) {
+    return 0;
+  }
+
+  /*
+   * Only buffer writes that go straight to the file extent, so that
+   * writing them out later cannot fail on a full micro log. The offset
+   * of the descriptor is advanced when the buffer is written out.
+   */
+  if(fdp->io_flags & CFS_COFFEE_IO_FLASH_AWARE) {
+    return !(COFFEE_APPEND_ONLY && fdp->offset < file->end);
+  }
+  return fdp->offset == file->end && !FILE_MODIFIED(file);
+}
+#endif /* COFFEE_WRITE_BUFFER_SIZE > 0 */
+/*---------------------------------------------------------------------------*/
+int
+cfs_write(int fd, const void *buf, unsigned size)
+{
+#if COFFEE_WRITE_BUFFER_SIZE > 0
+  struct file_desc *fdp;
+
+  if(!(FD_VALID(fd) && FD_WRITABLE(fd))) {
+    return -1;
+  }
+  fdp = &coffee_fd_set[fd];
+
+  /* A failure to write out another descriptor's data is reported
+     through that descriptor. */
+  if(write_buffer.length > 0 && write_buffer.fd != fd) {
+    flush_write_buffer();
+  }
+
+  if(write_failed(fd)) {
+    return -1;
+  }
+
+  if(write_bufferable(fdp, size)) {
+    if(write_buffer.length == 0) {
+      write_buffer.fd = fd;
+      poll_coffee_process();
+    }
+    memcpy(&write_buffer.data[write_buffer.length], buf, size);
+    write_buffer.length += size;
+    return size;
+  }
+
+  if(flush_write_buffer() < 0) {
+    write_failed(fd);
+    return -1;
+  }
+#endif /* COFFEE_WRITE_BUFFER_SIZE > 0 */
+
+  return write_data(fd, buf, size);
+}
+/*---------------------------------------------------------------------------*/
 int
 cfs_opendir(struct cfs_dir *dir, const char *name)
 {
@@ -1237,6 +1647,7 @@ cfs_opendir(struct cfs_dir *dir, const char *name)
    * Coffee is only guaranteed to support the directory names "/" and ".",
    * but it does not enforce this currently.
    */
+  FLUSH_WRITE_BUFFER();
   memset(dir->state, 0, sizeof(coffee_page_t));
   return 0;
 }
@@ -1248,6 +1659,8 @@ cfs_readdir(struct cfs_dir *dir, struct cfs_dirent *record)
   coffee_page_t page;
   coffee_page_t next_page;
 
+  FLUSH_WRITE_BUFFER();
+
   memcpy(&page, dir->state, sizeof(coffee_page_t));
 
   while(page < COFFEE_PAGE_COUNT) {
@@ -1276,6 +1689,8 @@ cfs_closedir(struct cfs_dir *dir)
 int
 cfs_coffee_reserve(const char *name, cfs_offset_t size)
 {
+  FLUSH_WRITE_BUFFER();
+
   return reserve(name, page_count(size), 0, 0) == NULL ? -1 : 0;
 }
 /*---------------------------------------------------------------------------*/
@@ -1291,6 +1706,8 @@ cfs_coffee_configure_log(const char *filename, unsigned log_size,
     return -1;
   }
 
+  FLUSH_WRITE_BUFFER();
+
   file = find_file(filename);
   if(file == NULL) {
     return -1;
@@ -1312,6 +1729,8 @@ cfs_coffee_configure_log(const char *filename, unsigned log_size,
 int
 cfs_coffee_set_io_semantics(int fd, unsigned flags)
 {
+  FLUSH_WRITE_BUFFER();
+
   if(!FD_VALID(fd)) {
     return -1;
   }
@@ -1330,6 +1749,9 @@ cfs_coffee_format(void)
 
   for(i = 0; i < COFFEE_SECTOR_COUNT; i++) {
     COFFEE_ERASE(i);
+#if COFFEE_BACKGROUND_GC
+    sector_erases[i]++;
+#endif /* COFFEE_BACKGROUND_GC */
     PRINTF(".");
   }
 
@@ -1338,9 +1760,55 @@ cfs_coffee_format(void)
   memset(&coffee_fd_set, 0, sizeof(coffee_fd_set));
   next_free = 0;
   gc_wait = 1;
+#if COFFEE_WRITE_BUFFER_SIZE > 0
+  write_buffer.length = 0;
+#endif /* COFFEE_WRITE_BUFFER_SIZE > 0 */
+#if COFFEE_NAME_INDEX
+  /* An empty file system is fully indexed by an empty index. */
+  name_index_count = 0;
+  name_index_state = NAME_INDEX_COMPLETE;
+#endif /* COFFEE_NAME_INDEX */
 
   PRINTF(" done!\n");
 
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+int
+cfs_coffee_erase_count(unsigned sector)
+{
+#if COFFEE_BACKGROUND_GC
+  if(sector < COFFEE_SECTOR_COUNT) {
+    return sector_erases[sector];
+  }
+#endif /* COFFEE_BACKGROUND_GC */
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+#if COFFEE_PROCESS
+PROCESS_THREAD(coffee_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    FLUSH_WRITE_BUFFER();
+
+#if COFFEE_BACKGROUND_GC
+    /*
+     * The sectors are collected in a single pass, because the status of
+     * a sector depends on the files that extend into it from previous
+     * sectors, and other processes could allocate pages in between.
+     */
+    if(gc_pending) {
+      gc_pending = 0;
+      collect_garbage(GC_GREEDY);
+    }
+#endif /* COFFEE_BACKGROUND_GC */
+  }
+
+  PROCESS_END();
+}
+#endif /* COFFEE_PROCESS */
+/*---------------------------------------------------------------------------*/
@@ -140,6 +140,19 @@ int cfs_coffee_set_io_semantics(int fd, unsigned flags);
  */
 int cfs_coffee_format(void);
 
+/**
+ * \brief Get the number of times that a sector has been erased.
+ * \param sector The sector number.
+ * \return The number of erasures, or -1 if the sector does not exist or
+ *         erasures are not tracked.
+ *
+ * Erasures are counted when Coffee is built with background garbage
+ * collection (COFFEE_CONF_BACKGROUND_GC). The counters are kept in RAM
+ * only and start from zero at every boot, so they show the wear since
+ * boot rather than over the lifetime of the storage.
+ */
+int cfs_coffee_erase_count(unsigned sector);
+
 /** @} */
 /** @} */
 
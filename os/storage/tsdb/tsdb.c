@@ -0,0 +1,709 @@
+/*
+ * Copyright (c) 2026, agent <agent@local>.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         A time-series store for CFS.
+ *
+ *         A series consists of up to TSDB_SEGMENTS pairs of files. The
+ *         data file of a segment holds a stream of samples, each
+ *         encoded as a zigzag varint value followed by a varint time:
+ *
+ *         - A key sample stores (time - base time) * 2 + 1 and the
+ *           absolute value.
+ *
+ *         - A delta sample stores (time - previous time) * 2 + 2 and
+ *           the difference from the previous value.
+ *
+ *         The last byte of a sample is thus never zero, which lets
+ *         Coffee find the end of a reserved file. The index file of a
+ *         segment holds a header with the sequence number and base
+ *         time of the segment, followed by one entry for each key
+ *         sample. Both files are only ever appended to.
+ */
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#if TSDB_COFFEE
+#include "cfs/cfs-coffee.h"
+#endif
+#include "tsdb.h"
+
+#include <string.h>
+
+/* The index file header: sequence, base time, and a magic number. */
+#define HEADER_SIZE      10
+#define HEADER_MAGIC_0   'T'
+#define HEADER_MAGIC_1   'S'
+
+/* An index entry: time, offset, padding, and a non-zero marker. */
+#define ENTRY_SIZE       8
+#define ENTRY_MARKER     0xa5
+
+#define MAX_VARINT_SIZE  5
+#define MAX_SAMPLE_SIZE  (2 * MAX_VARINT_SIZE)
+
+/* The largest time offset from the base time of a segment that can be
+   encoded without overflowing the tagged time. */
+#define MAX_TIME_OFFSET  0x7ffffffeUL
+
+#define INDEX_RESERVE_SIZE \
+  (HEADER_SIZE + ENTRY_SIZE * (TSDB_SEGMENT_SIZE / TSDB_BLOCK_SIZE + 1))
+/*---------------------------------------------------------------------------*/
+static void
+file_name(char *buf, const tsdb_t *db, uint32_t seq, int index)
+{
+  size_t len;
+
+  len = strlen(db->name);
+  memcpy(buf, db->name, len);
+  buf[len++] = '.';
+  buf[len++] = '0' + seq % TSDB_SEGMENTS;
+  if(index) {
+    buf[len++] = 'i';
+  }
+  buf[len] = '\0';
+}
+/*---------------------------------------------------------------------------*/
+static void
+put_u32(uint8_t *buf, uint32_t v)
+{
+  buf[0] = v & 0xff;
+  buf[1] = (v >> 8) & 0xff;
+  buf[2] = (v >> 16) & 0xff;
+  buf[3] = (v >> 24) & 0xff;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+get_u32(const uint8_t *buf)
+{
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+         ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+/*---------------------------------------------------------------------------*/
+static int
+put_varint(uint8_t *buf, uint32_t v)
+{
+  int len;
+
+  for(len = 0; v >= 0x80; v >>= 7) {
+    buf[len++] = (v & 0x7f) | 0x80;
+  }
+  buf[len++] = v;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+zigzag_encode(int32_t v)
+{
+  return ((uint32_t)v << 1) ^ (uint32_t)(v < 0 ? -1 : 0);
+}
+/*---------------------------------------------------------------------------*/
+static int32_t
+zigzag_decode(uint32_t v)
+{
+  return (int32_t)((v >> 1) ^ (uint32_t)-(int32_t)(v & 1));
+}
+/*---------------------------------------------------------------------------*/
+/* Read the header of the index file of a segment. Returns the open
+   index file, or -1 if the segment does not exist. */
+static int
+open_index(const tsdb_t *db, uint32_t seq, int check_seq,
+           uint32_t *found_seq, uint32_t *base_time)
+{
+  char name[TSDB_NAME_LENGTH + 4];
+  uint8_t header[HEADER_SIZE];
+  int fd;
+
+  file_name(name, db, seq, 1);
+  fd = cfs_open(name, CFS_READ);
+  if(fd < 0) {
+    return -1;
+  }
+
+  if(cfs_read(fd, header, sizeof(header)) != sizeof(header) ||
+     header[8] != HEADER_MAGIC_0 || header[9] != HEADER_MAGIC_1 ||
+     (check_seq && get_u32(&header[0]) != seq)) {
+    cfs_close(fd);
+    return -1;
+  }
+
+  if(found_seq != NULL) {
+    *found_seq = get_u32(&header[0]);
+  }
+  *base_time = get_u32(&header[4]);
+  return fd;
+}
+/*---------------------------------------------------------------------------*/
+static int
+read_entry(int fd, uint32_t entry, uint32_t *time, uint16_t *offset)
+{
+  uint8_t buf[ENTRY_SIZE];
+
+  if(cfs_seek(fd, HEADER_SIZE + entry * ENTRY_SIZE, CFS_SEEK_SET) < 0 ||
+     cfs_read(fd, buf, sizeof(buf)) != sizeof(buf) ||
+     buf[7] != ENTRY_MARKER) {
+    return -1;
+  }
+  *time = get_u32(&buf[0]);
+  *offset = buf[4] | (buf[5] << 8);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+entry_count(int fd)
+{
+  cfs_offset_t size;
+
+  size = cfs_seek(fd, 0, CFS_SEEK_END);
+  if(size < HEADER_SIZE) {
+    return 0;
+  }
+  return (size - HEADER_SIZE) / ENTRY_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static int
+read_byte(tsdb_iterator_t *it)
+{
+  int r;
+
+  if(it->buf_pos == it->buf_len) {
+    r = cfs_read(it->fd, it->buf, sizeof(it->buf));
+    if(r <= 0) {
+      return -1;
+    }
+    it->buf_len = r;
+    it->buf_pos = 0;
+  }
+  return it->buf[it->buf_pos++];
+}
+/*---------------------------------------------------------------------------*/
+/* Returns 1 if a varint was read, 0 at the end of the file, and -1 if
+   the varint is truncated or malformed. */
+static int
+read_varint(tsdb_iterator_t *it, uint32_t *v)
+{
+  int c;
+  int i;
+
+  *v = 0;
+  for(i = 0; i < MAX_VARINT_SIZE; i++) {
+    c = read_byte(it);
+    if(c < 0) {
+      return i == 0 ? 0 : -1;
+    }
+    *v |= (uint32_t)(c & 0x7f) << (7 * i);
+    if((c & 0x80) == 0) {
+      return 1;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns 1 if a sample was read, 0 at the end of the segment, and -1
+   if the segment ends with an incomplete sample. */
+static int
+read_sample(tsdb_iterator_t *it, tsdb_sample_t *sample)
+{
+  uint32_t value;
+  uint32_t time;
+  int r;
+
+  r = read_varint(it, &value);
+  if(r <= 0) {
+    return r;
+  }
+  if(read_varint(it, &time) <= 0 || time == 0) {
+    return -1;
+  }
+
+  if(time & 1) {
+    sample->time = it->base_time + (time >> 1);
+    sample->value = zigzag_decode(value);
+  } else {
+    sample->time = it->prev_time + (time >> 1) - 1;
+    sample->value = (int32_t)((uint32_t)it->prev_value +
+                              (uint32_t)zigzag_decode(value));
+  }
+  it->prev_time = sample->time;
+  it->prev_value = sample->value;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Open the data file of a segment for reading, positioned at the last
+   key sample before the time "from". */
+static int
+open_segment(tsdb_iterator_t *it, uint32_t seq, uint32_t from)
+{
+  char name[TSDB_NAME_LENGTH + 4];
+  uint32_t low, high, mid;
+  uint32_t time;
+  uint16_t offset;
+  uint16_t start;
+  int fd;
+
+  fd = open_index(it->db, seq, 1, NULL, &it->base_time);
+  if(fd < 0) {
+    return -1;
+  }
+
+  /* Find the last entry with a time strictly before "from", so that
+     earlier samples with the same time are not skipped. */
+  start = 0;
+  low = 0;
+  high = entry_count(fd);
+  while(low < high) {
+    mid = low + (high - low) / 2;
+    if(read_entry(fd, mid, &time, &offset) < 0) {
+      break;
+    }
+    if(time < from) {
+      start = offset;
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  cfs_close(fd);
+
+  file_name(name, it->db, seq, 0);
+  it->fd = cfs_open(name, CFS_READ);
+  if(it->fd < 0) {
+    return -1;
+  }
+  if(start > 0 && cfs_seek(it->fd, start, CFS_SEEK_SET) != start) {
+    cfs_close(it->fd);
+    it->fd = -1;
+    return -1;
+  }
+
+  it->seq = seq;
+  it->buf_pos = it->buf_len = 0;
+  it->prev_time = it->base_time;
+  it->prev_value = 0;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+write_index_entry(tsdb_t *db, uint32_t time, uint16_t offset)
+{
+  char name[TSDB_NAME_LENGTH + 4];
+  uint8_t buf[ENTRY_SIZE];
+  int fd;
+  int r;
+
+  put_u32(&buf[0], time);
+  buf[4] = offset & 0xff;
+  buf[5] = offset >> 8;
+  buf[6] = 0;
+  buf[7] = ENTRY_MARKER;
+
+  file_name(name, db, db->seq, 1);
+  fd = cfs_open(name, CFS_WRITE | CFS_APPEND);
+  if(fd < 0) {
+    return -1;
+  }
+  r = cfs_write(fd, buf, sizeof(buf));
+  cfs_close(fd);
+  return r == sizeof(buf) ? 0 : -1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+new_segment(tsdb_t *db, uint32_t base_time)
+{
+  char name[TSDB_NAME_LENGTH + 4];
+  uint8_t header[HEADER_SIZE];
+  uint32_t seq;
+  int fd;
+  int r;
+
+  if(db->fd >= 0) {
+    cfs_close(db->fd);
+    db->fd = -1;
+  }
+
+  /* The new segment replaces the oldest one. */
+  seq = db->has_segment ? db->seq + 1 : 0;
+  file_name(name, db, seq, 0);
+  cfs_remove(name);
+  file_name(name, db, seq, 1);
+  cfs_remove(name);
+
+#if TSDB_COFFEE
+  if(cfs_coffee_reserve(name, INDEX_RESERVE_SIZE) < 0) {
+    return -1;
+  }
+  file_name(name, db, seq, 0);
+  if(cfs_coffee_reserve(name, TSDB_SEGMENT_SIZE) < 0) {
+    return -1;
+  }
+  file_name(name, db, seq, 1);
+#endif /* TSDB_COFFEE */
+
+  put_u32(&header[0], seq);
+  put_u32(&header[4], base_time);
+  header[8] = HEADER_MAGIC_0;
+  header[9] = HEADER_MAGIC_1;
+
+  fd = cfs_open(name, CFS_WRITE | CFS_APPEND);
+  if(fd < 0) {
+    return -1;
+  }
+  r = cfs_write(fd, header, sizeof(header));
+  cfs_close(fd);
+  if(r != sizeof(header)) {
+    return -1;
+  }
+
+  file_name(name, db, seq, 0);
+  db->fd = cfs_open(name, CFS_WRITE | CFS_APPEND);
+  if(db->fd < 0) {
+    return -1;
+  }
+
+  db->seq = seq;
+  db->has_segment = 1;
+  db->base_time = base_time;
+  db->size = 0;
+  db->block_start = 0;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Find the end of the newest segment. If it ends with an incomplete
+   sample, it is left closed so that the next sample starts a new
+   segment. */
+static void
+recover(tsdb_t *db, int index_fd)
+{
+  char name[TSDB_NAME_LENGTH + 4];
+  tsdb_iterator_t it;
+  tsdb_sample_t sample;
+  cfs_offset_t data_size;
+  uint32_t entries;
+  uint16_t offset;
+  int r;
+
+  db->last_time = db->base_time;
+  db->last_value = 0;
+
+  entries = entry_count(index_fd);
+  if(entries == 0 ||
+     read_entry(index_fd, entries - 1, &db->last_time, &offset) < 0) {
+    return;
+  }
+
+  memset(&it, 0, sizeof(it));
+  it.db = db;
+  it.base_time = db->base_time;
+  file_name(name, db, db->seq, 0);
+  it.fd = cfs_open(name, CFS_READ);
+  if(it.fd < 0) {
+    return;
+  }
+  data_size = cfs_seek(it.fd, 0, CFS_SEEK_END);
+  if(data_size <= offset || data_size > TSDB_SEGMENT_SIZE ||
+     cfs_seek(it.fd, offset, CFS_SEEK_SET) != offset) {
+    cfs_close(it.fd);
+    return;
+  }
+
+  while((r = read_sample(&it, &sample)) > 0) {
+    db->last_time = sample.time;
+    db->last_value = sample.value;
+  }
+  cfs_close(it.fd);
+  if(r < 0) {
+    return;
+  }
+
+  db->fd = cfs_open(name, CFS_WRITE | CFS_APPEND);
+  db->size = data_size;
+  db->block_start = offset;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsdb_open(tsdb_t *db, const char *name)
+{
+  uint32_t slot;
+  uint32_t seq;
+  uint32_t base_time;
+  int fd;
+
+  if(strlen(name) > TSDB_NAME_LENGTH) {
+    return -1;
+  }
+
+  memset(db, 0, sizeof(*db));
+  strcpy(db->name, name);
+  db->fd = -1;
+
+  for(slot = 0; slot < TSDB_SEGMENTS; slot++) {
+    fd = open_index(db, slot, 0, &seq, &base_time);
+    if(fd < 0) {
+      continue;
+    }
+    cfs_close(fd);
+    if(seq % TSDB_SEGMENTS == slot &&
+       (!db->has_segment || seq > db->seq)) {
+      db->has_segment = 1;
+      db->seq = seq;
+      db->base_time = base_time;
+    }
+  }
+
+  if(db->has_segment) {
+    fd = open_index(db, db->seq, 1, NULL, &base_time);
+    if(fd >= 0) {
+      recover(db, fd);
+      cfs_close(fd);
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsdb_close(tsdb_t *db)
+{
+  if(db->fd >= 0) {
+    cfs_close(db->fd);
+    db->fd = -1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsdb_remove(tsdb_t *db)
+{
+  char name[TSDB_NAME_LENGTH + 4];
+  uint32_t slot;
+
+  tsdb_close(db);
+  for(slot = 0; slot < TSDB_SEGMENTS; slot++) {
+    file_name(name, db, slot, 0);
+    cfs_remove(name);
+    file_name(name, db, slot, 1);
+    cfs_remove(name);
+  }
+  db->has_segment = 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+encode_sample(const tsdb_t *db, uint32_t time, int32_t value,
+              uint8_t *buf, int *is_key)
+{
+  int len;
+
+  *is_key = db->size == 0 || db->size - db->block_start >= TSDB_BLOCK_SIZE;
+  if(*is_key) {
+    len = put_varint(buf, zigzag_encode(value));
+    len += put_varint(buf + len, ((time - db->base_time) << 1) + 1);
+  } else {
+    len = put_varint(buf, zigzag_encode((int32_t)((uint32_t)value -
+                                                  (uint32_t)db->last_value)));
+    len += put_varint(buf + len, ((time - db->last_time) << 1) + 2);
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsdb_append(tsdb_t *db, uint32_t time, int32_t value)
+{
+  uint8_t buf[MAX_SAMPLE_SIZE];
+  int is_key;
+  int len;
+
+  if(db->has_segment && time < db->last_time) {
+    return -1;
+  }
+
+  if(db->fd < 0 || time - db->base_time > MAX_TIME_OFFSET) {
+    if(new_segment(db, time) < 0) {
+      return -1;
+    }
+  }
+
+  len = encode_sample(db, time, value, buf, &is_key);
+  if(db->size + len > TSDB_SEGMENT_SIZE) {
+    if(new_segment(db, time) < 0) {
+      return -1;
+    }
+    len = encode_sample(db, time, value, buf, &is_key);
+  }
+
+  if(is_key) {
+    if(write_index_entry(db, time, db->size) < 0) {
+      return -1;
+    }
+    db->block_start = db->size;
+  }
+
+  if(cfs_write(db->fd, buf, len) != len) {
+    /* The segment may now end with a partial sample, so the next
+       sample starts a new one. */
+    cfs_close(db->fd);
+    db->fd = -1;
+    db->last_time = time;
+    return -1;
+  }
+
+  db->size += len;
+  db->last_time = time;
+  db->last_value = value;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsdb_range(tsdb_iterator_t *it, tsdb_t *db, uint32_t from, uint32_t to)
+{
+  uint32_t oldest;
+  uint32_t seq;
+  uint32_t base_time;
+  uint32_t start;
+  int found;
+  int fd;
+
+  memset(it, 0, sizeof(*it));
+  it->db = db;
+  it->fd = -1;
+  it->from = from;
+  it->to = to;
+
+  if(!db->has_segment || from > to) {
+    return 0;
+  }
+
+  /* Start in the newest segment that begins before "from", or in the
+     oldest segment if all of them begin later. */
+  oldest = db->seq >= TSDB_SEGMENTS - 1 ? db->seq - (TSDB_SEGMENTS - 1) : 0;
+  found = 0;
+  start = 0;
+  for(seq = db->seq + 1; seq-- > oldest;) {
+    fd = open_index(db, seq, 1, NULL, &base_time);
+    if(fd < 0) {
+      break;
+    }
+    cfs_close(fd);
+    found = 1;
+    start = seq;
+    if(base_time < from) {
+      break;
+    }
+  }
+
+  if(!found) {
+    return 0;
+  }
+  return open_segment(it, start, from);
+}
+/*---------------------------------------------------------------------------*/
+int
+tsdb_next(tsdb_iterator_t *it, tsdb_sample_t *sample)
+{
+  int r;
+
+  if(it->has_pending) {
+    it->has_pending = 0;
+    *sample = it->pending;
+    return 1;
+  }
+
+  while(it->fd >= 0) {
+    r = read_sample(it, sample);
+    if(r <= 0) {
+      /* Continue with the next segment, if there is one. Samples
+         after an incomplete one in the same segment are lost. */
+      cfs_close(it->fd);
+      it->fd = -1;
+      if(it->seq == it->db->seq || open_segment(it, it->seq + 1, 0) < 0) {
+        return 0;
+      }
+      continue;
+    }
+    if(sample->time > it->to) {
+      tsdb_range_close(it);
+      return 0;
+    }
+    if(sample->time >= it->from) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsdb_downsample(tsdb_iterator_t *it, uint32_t interval, tsdb_bucket_t *bucket)
+{
+  tsdb_sample_t sample;
+  int64_t sum;
+  int r;
+
+  if(interval == 0) {
+    return -1;
+  }
+
+  r = tsdb_next(it, &sample);
+  if(r <= 0) {
+    return r;
+  }
+
+  bucket->start = it->from + (sample.time - it->from) / interval * interval;
+  bucket->count = 1;
+  bucket->min = bucket->max = sample.value;
+  sum = sample.value;
+
+  while((r = tsdb_next(it, &sample)) > 0) {
+    if(sample.time - bucket->start >= interval) {
+      it->pending = sample;
+      it->has_pending = 1;
+      break;
+    }
+    bucket->count++;
+    if(sample.value < bucket->min) {
+      bucket->min = sample.value;
+    }
+    if(sample.value > bucket->max) {
+      bucket->max = sample.value;
+    }
+    sum += sample.value;
+  }
+
+  bucket->mean = (int32_t)(sum / (int64_t)bucket->count);
+  return r < 0 ? r : 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsdb_range_close(tsdb_iterator_t *it)
+{
+  if(it->fd >= 0) {
+    cfs_close(it->fd);
+    it->fd = -1;
+  }
+  it->has_pending = 0;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2026, agent <agent@local>.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup sys
+ * @{
+ */
+
+/**
+ * \defgroup tsdb A time-series store for CFS
+ *
+ * The time-series store keeps sequences of (time, value) samples,
+ * such as sensor readings or network statistics, in the Contiki file
+ * system. It is much more compact than a general database relation
+ * for this kind of data:
+ *
+ * - Samples are delta-encoded and written as variable-length
+ *   integers, so a sample with a small change typically takes two or
+ *   three bytes.
+ *
+ * - A series is split into a fixed number of segments of bounded
+ *   size. When the newest segment is full, the oldest one is removed
+ *   and its slot is reused, so the storage used by a series stays
+ *   constant.
+ *
+ * - Every segment has a sparse time index that points to a
+ *   self-contained sample at least every TSDB_BLOCK_SIZE bytes. A
+ *   range read therefore starts close to the first requested sample
+ *   instead of scanning the series from its beginning.
+ *
+ * All files are written strictly append-only, which suits both flash
+ * file systems such as Coffee and other CFS backends. Timestamps must
+ * be non-decreasing within a series; their unit is up to the
+ * application.
+ *
+ * @{
+ */
+
+/**
+ * \file
+ *         Header file for the time-series store.
+ */
+
+#ifndef TSDB_H_
+#define TSDB_H_
+
+#include "contiki.h"
+
+/** The maximum length of a series name. */
+#ifdef TSDB_CONF_NAME_LENGTH
+#define TSDB_NAME_LENGTH TSDB_CONF_NAME_LENGTH
+#else
+#define TSDB_NAME_LENGTH 10
+#endif
+
+/** The number of segments that a series rotates through. */
+#ifdef TSDB_CONF_SEGMENTS
+#define TSDB_SEGMENTS TSDB_CONF_SEGMENTS
+#else
+#define TSDB_SEGMENTS 4
+#endif
+
+/** The maximum size of the sample data in a segment, in bytes. */
+#ifdef TSDB_CONF_SEGMENT_SIZE
+#define TSDB_SEGMENT_SIZE TSDB_CONF_SEGMENT_SIZE
+#else
+#define TSDB_SEGMENT_SIZE 2048
+#endif
+
+/**
+ * The maximum distance, in bytes, between two samples that are
+ * referenced from the time index. Smaller blocks make range reads
+ * start closer to the requested time, at the cost of a larger index.
+ */
+#ifdef TSDB_CONF_BLOCK_SIZE
+#define TSDB_BLOCK_SIZE TSDB_CONF_BLOCK_SIZE
+#else
+#define TSDB_BLOCK_SIZE 64
+#endif
+
+/** The size of the read buffer in an iterator. */
+#ifdef TSDB_CONF_READ_BUFFER_SIZE
+#define TSDB_READ_BUFFER_SIZE TSDB_CONF_READ_BUFFER_SIZE
+#else
+#define TSDB_READ_BUFFER_SIZE 16
+#endif
+
+/**
+ * Set to 1 if the CFS backend is Coffee, in which case the segment
+ * files are reserved at their maximum size when they are created.
+ */
+#ifdef TSDB_CONF_COFFEE
+#define TSDB_COFFEE TSDB_CONF_COFFEE
+#else
+#define TSDB_COFFEE 0
+#endif
+
+#if TSDB_SEGMENTS < 2 || TSDB_SEGMENTS > 10
+#error "TSDB_SEGMENTS must be between 2 and 10."
+#endif
+
+#if TSDB_SEGMENT_SIZE > 65535
+#error "TSDB_SEGMENT_SIZE must be at most 65535."
+#endif
+
+#if TSDB_READ_BUFFER_SIZE > 255
+#error "TSDB_READ_BUFFER_SIZE must be at most 255."
+#endif
+
+/** A single sample in a series. */
+typedef struct tsdb_sample {
+  uint32_t time;
+  int32_t value;
+} tsdb_sample_t;
+
+/** The aggregate of the samples in one downsampling interval. */
+typedef struct tsdb_bucket {
+  uint32_t start;
+  uint32_t count;
+  int32_t min;
+  int32_t max;
+  int32_t mean;
+} tsdb_bucket_t;
+
+/**
+ * The state of an open series. The members are internal and should
+ * not be accessed by the application.
+ */
+typedef struct tsdb {
+  char name[TSDB_NAME_LENGTH + 1];
+  int fd;
+  uint32_t seq;
+  uint32_t base_time;
+  uint32_t last_time;
+  int32_t last_value;
+  uint16_t size;
+  uint16_t block_start;
+  uint8_t has_segment;
+} tsdb_t;
+
+/**
+ * The state of a range read. The members are internal and should not
+ * be accessed by the application.
+ */
+typedef struct tsdb_iterator {
+  tsdb_t *db;
+  int fd;
+  uint32_t seq;
+  uint32_t base_time;
+  uint32_t from;
+  uint32_t to;
+  uint32_t prev_time;
+  int32_t prev_value;
+  tsdb_sample_t pending;
+  uint8_t has_pending;
+  uint8_t buf_pos;
+  uint8_t buf_len;
+  uint8_t buf[TSDB_READ_BUFFER_SIZE];
+} tsdb_iterator_t;
+
+/**
+ * \brief      Open a series, and create it if it does not exist.
+ * \param db   A pointer to the series state.
+ * \param name The name of the series, which is used as the prefix
+ *             of its file names.
+ * \return     0 on success, -1 on failure.
+ *
+ *             The position at which to continue appending is recovered
+ *             from the newest segment of the series.
+ */
+int tsdb_open(tsdb_t *db, const char *name);
+
+/**
+ * \brief      Close a series.
+ * \param db   A pointer to the series state.
+ */
+void tsdb_close(tsdb_t *db);
+
+/**
+ * \brief      Close a series and remove all its files.
+ * \param db   A pointer to the series state.
+ */
+void tsdb_remove(tsdb_t *db);
+
+/**
+ * \brief      Append a sample to a series.
+ * \param db   A pointer to the series state.
+ * \param time The time of the sample, which must not be earlier than
+ *             the time of the previous sample.
+ * \param value The value of the sample.
+ * \return     0 on success, -1 on failure.
+ */
+int tsdb_append(tsdb_t *db, uint32_t time, int32_t value);
+
+/**
+ * \brief      Start reading the samples in a time range.
+ * \param it   A pointer to the iterator state.
+ * \param db   A pointer to the series state.
+ * \param from The earliest time to include.
+ * \param to   The latest time to include.
+ * \return     0 on success, -1 on failure.
+ *
+ *             The iterator holds an open file until tsdb_next() or
+ *             tsdb_downsample() returns 0, or until tsdb_range_close()
+ *             is called.
+ */
+int tsdb_range(tsdb_iterator_t *it, tsdb_t *db, uint32_t from, uint32_t to);
+
+/**
+ * \brief      Get the next sample in a range.
+ * \param it   A pointer to the iterator state.
+ * \param sample A pointer to where the sample is stored.
+ * \return     1 if a sample was found, 0 at the end of the range, and
+ *             -1 on failure.
+ */
+int tsdb_next(tsdb_iterator_t *it, tsdb_sample_t *sample);
+
+/**
+ * \brief      Get the next aggregated interval in a range.
+ * \param it   A pointer to the iterator state.
+ * \param interval The length of the intervals, which are aligned to
+ *             the start of the range.
+ * \param bucket A pointer to where the aggregate is stored.
+ * \return     1 if an interval was aggregated, 0 at the end of the
+ *             range, and -1 on failure.
+ *
+ *             Intervals without any samples are skipped.
+ */
+int tsdb_downsample(tsdb_iterator_t *it, uint32_t interval,
+                    tsdb_bucket_t *bucket);
+
+/**
+ * \brief      Stop a range read before its end.
+ * \param it   A pointer to the iterator state.
+ */
+void tsdb_range_close(tsdb_iterator_t *it);
+
+#endif /* TSDB_H_ */
+
+/**
+ * @}
+ * @}
+ */
@@ -46,10 +46,6 @@
 #include "contiki.h"
 #include "lib/list.h"
 
-LIST(ctimer_list);
-
-static char initialized;
-
 #define DEBUG 0
 #if DEBUG
 #include <stdio.h>
@@ -58,6 +54,261 @@ static char initialized;
 #define PRINTF(...)
 #endif
 
+static char initialized;
+
+#if CTIMER_WHEEL
+/*---------------------------------------------------------------------------*/
+/*
+ * Hashed timer wheel. A pending ctimer sits in the slot of its expiration
+ * tick, linked through next and pprev so that it can be taken out in O(1).
+ * Its etimer is not on the etimer list: etimer.timer holds the start and
+ * interval, and etimer.p is &ctimer_process while it is pending so that
+ * ctimer_expired() and etimer_expired() on it keep working.
+ */
+#define WHEEL_MASK (CTIMER_WHEEL_SIZE - 1)
+#define WHEEL_HALF ((clock_time_t)~(clock_time_t)0 >> 1)
+
+static struct ctimer *wheel[CTIMER_WHEEL_SIZE];
+/* Lower bound of the expiration times in each slot */
+static clock_time_t wheel_min[CTIMER_WHEEL_SIZE];
+/* Drives the wheel, owned by ctimer_process */
+static struct etimer wheel_timer;
+
+PROCESS(ctimer_process, "Ctimer process");
+/*---------------------------------------------------------------------------*/
+/* Ticks until time t, 0 if t has been reached */
+static clock_time_t
+wheel_remaining(clock_time_t t, clock_time_t now)
+{
+  return t - now > WHEEL_HALF ? 0 : t - now;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_link(struct ctimer **head, struct ctimer *c)
+{
+  c->next = *head;
+  if(c->next != NULL) {
+    c->next->pprev = &c->next;
+  }
+  c->pprev = head;
+  *head = c;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_unlink(struct ctimer *c)
+{
+  *c->pprev = c->next;
+  if(c->next != NULL) {
+    c->next->pprev = c->pprev;
+  }
+  c->next = NULL;
+  c->pprev = NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Arm wheel_timer if it would otherwise fire later than wait ticks */
+static void
+wheel_arm(clock_time_t wait, clock_time_t now)
+{
+  if(!initialized) {
+    return;
+  }
+  if(etimer_expired(&wheel_timer)
+     || wheel_remaining(etimer_expiration_time(&wheel_timer), now) > wait) {
+    PROCESS_CONTEXT_BEGIN(&ctimer_process);
+    etimer_set(&wheel_timer, wait);
+    PROCESS_CONTEXT_END(&ctimer_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_add(struct ctimer *c)
+{
+  clock_time_t now;
+  clock_time_t expiration;
+  clock_time_t wait;
+  unsigned slot;
+
+  if(c->etimer.p != PROCESS_NONE) {
+    wheel_unlink(c);
+  }
+  c->etimer.p = &ctimer_process;
+
+  now = clock_time();
+  expiration = etimer_expiration_time(&c->etimer);
+  wait = wheel_remaining(expiration, now);
+  slot = expiration & WHEEL_MASK;
+  if(wheel[slot] == NULL || wheel_remaining(wheel_min[slot], now) > wait) {
+    wheel_min[slot] = expiration;
+  }
+  wheel_link(&wheel[slot], c);
+  wheel_arm(wait, now);
+}
+/*---------------------------------------------------------------------------*/
+/* Set wheel_min of a slot to the earliest expiration time in it */
+static void
+wheel_update_min(unsigned slot, clock_time_t now)
+{
+  struct ctimer *c;
+  clock_time_t expiration;
+
+  for(c = wheel[slot]; c != NULL; c = c->next) {
+    expiration = etimer_expiration_time(&c->etimer);
+    if(c == wheel[slot]
+       || wheel_remaining(expiration, now) < wheel_remaining(wheel_min[slot], now)) {
+      wheel_min[slot] = expiration;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_schedule(void)
+{
+  clock_time_t now;
+  clock_time_t wait;
+  clock_time_t next;
+  uint8_t pending;
+  unsigned slot;
+
+  now = clock_time();
+  pending = 0;
+  next = 0;
+  for(slot = 0; slot < CTIMER_WHEEL_SIZE; slot++) {
+    if(wheel[slot] == NULL) {
+      continue;
+    }
+    wait = wheel_remaining(wheel_min[slot], now);
+    if(!pending || wait < next) {
+      next = wait;
+      pending = 1;
+    }
+  }
+  if(pending) {
+    etimer_set(&wheel_timer, next);
+  } else {
+    etimer_stop(&wheel_timer);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_expire(void)
+{
+  struct ctimer *due;
+  struct ctimer **tail;
+  struct ctimer *c;
+  struct ctimer *n;
+  clock_time_t now;
+  unsigned slot;
+
+  /*
+   * Move everything that is due aside. Only slots whose lower bound has
+   * been reached can hold due ctimers, and their bound is refreshed here,
+   * so a slot whose earliest ctimer was stopped costs one extra wakeup.
+   */
+  due = NULL;
+  tail = &due;
+  now = clock_time();
+  for(slot = 0; slot < CTIMER_WHEEL_SIZE; slot++) {
+    if(wheel[slot] == NULL || wheel_remaining(wheel_min[slot], now) > 0) {
+      continue;
+    }
+    for(c = wheel[slot]; c != NULL; c = n) {
+      n = c->next;
+      if(timer_expired(&c->etimer.timer)) {
+        wheel_unlink(c);
+        c->pprev = tail;
+        *tail = c;
+        tail = &c->next;
+      }
+    }
+    wheel_update_min(slot, now);
+  }
+
+  /* Callbacks may set or stop any ctimer, including the ones still due */
+  while(due != NULL) {
+    c = due;
+    wheel_unlink(c);
+    c->etimer.p = PROCESS_NONE;
+    PROCESS_CONTEXT_BEGIN(c->p);
+    if(c->f != NULL) {
+      c->f(c->ptr);
+    }
+    PROCESS_CONTEXT_END(c->p);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(ctimer_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  initialized = 1;
+  wheel_schedule();
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_TIMER);
+    wheel_expire();
+    wheel_schedule();
+  }
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+void
+ctimer_init(void)
+{
+  initialized = 0;
+  process_start(&ctimer_process, NULL);
+}
+/*---------------------------------------------------------------------------*/
+void
+ctimer_set(struct ctimer *c, clock_time_t t,
+           void (*f)(void *), void *ptr)
+{
+  ctimer_set_with_process(c, t, f, ptr, PROCESS_CURRENT());
+}
+/*---------------------------------------------------------------------------*/
+void
+ctimer_set_with_process(struct ctimer *c, clock_time_t t,
+                        void (*f)(void *), void *ptr, struct process *p)
+{
+  PRINTF("ctimer_set %p %lu\n", c, (unsigned long)t);
+  c->p = p;
+  c->f = f;
+  c->ptr = ptr;
+  timer_set(&c->etimer.timer, t);
+  wheel_add(c);
+}
+/*---------------------------------------------------------------------------*/
+void
+ctimer_reset(struct ctimer *c)
+{
+  timer_reset(&c->etimer.timer);
+  wheel_add(c);
+}
+/*---------------------------------------------------------------------------*/
+void
+ctimer_restart(struct ctimer *c)
+{
+  timer_restart(&c->etimer.timer);
+  wheel_add(c);
+}
+/*---------------------------------------------------------------------------*/
+void
+ctimer_stop(struct ctimer *c)
+{
+  if(c->etimer.p != PROCESS_NONE) {
+    wheel_unlink(c);
+  }
+  c->etimer.p = PROCESS_NONE;
+}
+/*---------------------------------------------------------------------------*/
+int
+ctimer_expired(struct ctimer *c)
+{
+  return etimer_expired(&c->etimer);
+}
+/*---------------------------------------------------------------------------*/
+#else /* CTIMER_WHEEL */
+LIST(ctimer_list);
+
 /*---------------------------------------------------------------------------*/
 PROCESS(ctimer_process, "Ctimer process");
 PROCESS_THREAD(ctimer_process, ev, data)
@@ -172,4 +423,5 @@ ctimer_expired(struct ctimer *c)
   return 1;
 }
 /*---------------------------------------------------------------------------*/
+#endif /* CTIMER_WHEEL */
 /** @} */
@@ -58,8 +58,34 @@
 #include "contiki.h"
 #include "sys/etimer.h"
 
+/**
+ * \brief Set to 1 to run ctimers on a hashed timer wheel
+ *
+ * By default every ctimer is backed by its own etimer. With the wheel,
+ * ctimers are hashed by expiration time into CTIMER_WHEEL_SIZE slots, a
+ * single etimer drives the wheel and all callbacks due at a tick are
+ * called in one batch. Set and stop become O(1).
+ */
+#ifdef CTIMER_CONF_WHEEL
+#define CTIMER_WHEEL CTIMER_CONF_WHEEL
+#else
+#define CTIMER_WHEEL 0
+#endif
+
+/**
+ * \brief Number of timer wheel slots, one clock tick each. Power of two.
+ */
+#ifdef CTIMER_CONF_WHEEL_SIZE
+#define CTIMER_WHEEL_SIZE CTIMER_CONF_WHEEL_SIZE
+#else
+#define CTIMER_WHEEL_SIZE 32
+#endif
+
 struct ctimer {
   struct ctimer *next;
+#if CTIMER_WHEEL
+  struct ctimer **pprev; /* The pointer to this ctimer in its wheel slot */
+#endif
   struct etimer etimer;
   struct process *p;
   void (*f)(void *);
@@ -49,6 +49,7 @@
 #include "sys/etimer.h"
 #include "sys/process.h"
 
+/* Active timers, sorted by expiration time with the earliest first */
 static struct etimer *timerlist;
 static clock_time_t next_expiration;
 
@@ -57,29 +58,65 @@ PROCESS(etimer_process, "Event timer");
 static void
 update_time(void)
 {
-  clock_time_t tdist;
-  clock_time_t now;
-  struct etimer *t;
-
   if(timerlist == NULL) {
     next_expiration = 0;
   } else {
-    now = clock_time();
-    t = timerlist;
-    /* Must calculate distance to next time into account due to wraps */
-    tdist = t->timer.start + t->timer.interval - now;
-    for(t = t->next; t != NULL; t = t->next) {
-      if(t->timer.start + t->timer.interval - now < tdist) {
-        tdist = t->timer.start + t->timer.interval - now;
-      }
+    next_expiration = etimer_expiration_time(timerlist);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Take the timer off the list, if it is on it */
+static void
+remove_timer(struct etimer *timer)
+{
+  struct etimer **t;
+
+  for(t = &timerlist; *t != NULL; t = &(*t)->next) {
+    if(*t == timer) {
+      *t = timer->next;
+      break;
+    }
+  }
+  timer->next = NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Time from now until the timer expires, 0 if it already has expired */
+static clock_time_t
+time_to_expiration(struct etimer *timer, clock_time_t now)
+{
+  clock_time_t elapsed;
+
+  /* Must calculate distances from the start time due to wraps */
+  elapsed = now - timer->timer.start;
+  if(elapsed >= timer->timer.interval) {
+    return 0;
+  }
+  return timer->timer.interval - elapsed;
+}
+/*---------------------------------------------------------------------------*/
+/* Put the timer on the list behind all timers expiring no later than it */
+static void
+insert_timer(struct etimer *timer)
+{
+  struct etimer **t;
+  clock_time_t now;
+  clock_time_t tdist;
+
+  /* Expired timers that have not been serviced yet stay at the head */
+  now = clock_time();
+  tdist = time_to_expiration(timer, now);
+  for(t = &timerlist; *t != NULL; t = &(*t)->next) {
+    if(time_to_expiration(*t, now) > tdist) {
+      break;
     }
-    next_expiration = now + tdist;
   }
+  timer->next = *t;
+  *t = timer;
 }
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(etimer_process, ev, data)
 {
-  struct etimer *t, *u;
+  struct etimer *t;
 
   PROCESS_BEGIN();
 
@@ -110,32 +147,22 @@ PROCESS_THREAD(etimer_process, ev, data)
       continue;
     }
 
-again:
-
-    u = NULL;
-
-    for(t = timerlist; t != NULL; t = t->next) {
-      if(timer_expired(&t->timer)) {
-        if(process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK) {
-
-          /* Reset the process ID of the event timer, to signal that the
-             etimer has expired. This is later checked in the
-             etimer_expired() function. */
-          t->p = PROCESS_NONE;
-          if(u != NULL) {
-            u->next = t->next;
-          } else {
-            timerlist = t->next;
-          }
-          t->next = NULL;
-          update_time();
-          goto again;
-        } else {
-          etimer_request_poll();
-        }
+    /* The list is sorted, so only the timers at its head can be due */
+    while(timerlist != NULL && timer_expired(&timerlist->timer)) {
+      t = timerlist;
+      if(process_post(t->p, PROCESS_EVENT_TIMER, t) != PROCESS_ERR_OK) {
+        etimer_request_poll();
+        break;
       }
-      u = t;
+
+      /* Reset the process ID of the event timer, to signal that the
+         etimer has expired. This is later checked in the
+         etimer_expired() function. */
+      t->p = PROCESS_NONE;
+      timerlist = t->next;
+      t->next = NULL;
     }
+    update_time();
   }
 
   PROCESS_END();
@@ -150,25 +177,15 @@ etimer_request_poll(void)
 static void
 add_timer(struct etimer *timer)
 {
-  struct etimer *t;
-
   etimer_request_poll();
 
+  /* A timer that has expired or been stopped is never on the list */
   if(timer->p != PROCESS_NONE) {
-    for(t = timerlist; t != NULL; t = t->next) {
-      if(t == timer) {
-        /* Timer already on list, bail out. */
-        timer->p = PROCESS_CURRENT();
-        update_time();
-        return;
-      }
-    }
+    remove_timer(timer);
   }
 
-  /* Timer not on list. */
   timer->p = PROCESS_CURRENT();
-  timer->next = timerlist;
-  timerlist = timer;
+  insert_timer(timer);
 
   update_time();
 }
@@ -206,7 +223,11 @@ void
 etimer_adjust(struct etimer *et, int timediff)
 {
   et->timer.start += timediff;
-  update_time();
+  if(et->p != PROCESS_NONE) {
+    remove_timer(et);
+    insert_timer(et);
+    update_time();
+  }
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -242,30 +263,11 @@ etimer_next_expiration_time(void)
 void
 etimer_stop(struct etimer *et)
 {
-  struct etimer *t;
-
-  /* First check if et is the first event timer on the list. */
-  if(et == timerlist) {
-    timerlist = timerlist->next;
+  if(et->p != PROCESS_NONE) {
+    remove_timer(et);
     update_time();
-  } else {
-    /* Else walk through the list and try to find the item before the
-       et timer. */
-    for(t = timerlist; t != NULL && t->next != et; t = t->next) {
-    }
-
-    if(t != NULL) {
-      /* We've found the item before the event timer that we are about
-         to remove. We point the items next pointer to the event after
-         the removed item. */
-      t->next = et->next;
-
-      update_time();
-    }
   }
 
-  /* Remove the next pointer from the item to be removed. */
-  et->next = NULL;
   /* Set the timer as expired */
   et->p = PROCESS_NONE;
 }
@@ -47,6 +47,9 @@
 
 #include "contiki.h"
 #include "sys/process.h"
+#if PROCESS_PRIORITIES
+#include "sys/critical.h"
+#endif /* PROCESS_PRIORITIES */
 
 /*
  * Pointer to the currently running process structure.
@@ -63,11 +66,33 @@ struct event_data {
   process_event_t ev;
   process_data_t data;
   struct process *p;
+#if PROCESS_PRIORITIES
+  process_num_events_t next;
+#endif /* PROCESS_PRIORITIES */
 };
 
 static process_num_events_t nevents, fevent;
 static struct event_data events[PROCESS_CONF_NUMEVENTS];
 
+#if PROCESS_PRIORITIES
+/*
+ * The event slots are shared by one FIFO per priority class, chained
+ * through their next index. Unused slots are on a free list.
+ */
+#define EVENT_NONE PROCESS_CONF_NUMEVENTS
+static process_num_events_t event_head[PROCESS_PRIO_NUM];
+static process_num_events_t event_tail[PROCESS_PRIO_NUM];
+static process_num_events_t event_free;
+
+/* Processes waiting to be polled, one list per priority class */
+static struct process *poll_list[PROCESS_PRIO_NUM];
+
+/* The order in which the priority classes are served */
+static const unsigned char prio_order[PROCESS_PRIO_NUM] = {
+  PROCESS_PRIO_HIGH, PROCESS_PRIO_NORMAL, PROCESS_PRIO_BACKGROUND
+};
+#endif /* PROCESS_PRIORITIES */
+
 #if PROCESS_CONF_STATS
 process_num_events_t process_maxevents;
 #endif
@@ -210,6 +235,17 @@ process_init(void)
   lastevent = PROCESS_EVENT_MAX;
 
   nevents = fevent = 0;
+#if PROCESS_PRIORITIES
+  for(fevent = 0; fevent < PROCESS_PRIO_NUM; fevent++) {
+    event_head[fevent] = event_tail[fevent] = EVENT_NONE;
+    poll_list[fevent] = NULL;
+  }
+  for(fevent = 0; fevent < PROCESS_CONF_NUMEVENTS; fevent++) {
+    events[fevent].next = fevent + 1;
+  }
+  event_free = 0;
+  fevent = 0;
+#endif /* PROCESS_PRIORITIES */
 #if PROCESS_CONF_STATS
   process_maxevents = 0;
 #endif /* PROCESS_CONF_STATS */
@@ -221,6 +257,36 @@ process_init(void)
  * Call each process' poll handler.
  */
 /*---------------------------------------------------------------------------*/
+#if PROCESS_PRIORITIES
+static void
+do_poll(void)
+{
+  struct process *p;
+  unsigned char i;
+  int_master_status_t status;
+
+  poll_requested = 0;
+  /* Call the processes that needs to be polled, highest class first. */
+  for(i = 0; i < PROCESS_PRIO_NUM; i++) {
+    status = critical_enter();
+    p = poll_list[prio_order[i]];
+    poll_list[prio_order[i]] = NULL;
+    critical_exit(status);
+
+    while(p != NULL) {
+      struct process *next = p->pollnext;
+      p->pollnext = NULL;
+      p->needspoll = 0;
+      /* The process may have exited after it was polled */
+      if(process_is_running(p)) {
+        p->state = PROCESS_STATE_RUNNING;
+        call_process(p, PROCESS_EVENT_POLL, NULL);
+      }
+      p = next;
+    }
+  }
+}
+#else /* PROCESS_PRIORITIES */
 static void
 do_poll(void)
 {
@@ -236,6 +302,7 @@ do_poll(void)
     }
   }
 }
+#endif /* PROCESS_PRIORITIES */
 /*---------------------------------------------------------------------------*/
 /*
  * Process the next event in the event queue and deliver it to
@@ -249,6 +316,9 @@ do_event(void)
   process_data_t data;
   struct process *receiver;
   struct process *p;
+#if PROCESS_PRIORITIES
+  const unsigned char *prio;
+#endif /* PROCESS_PRIORITIES */
 
   /*
    * If there are any events in the queue, take the first one and walk
@@ -260,6 +330,12 @@ do_event(void)
 
   if(nevents > 0) {
 
+#if PROCESS_PRIORITIES
+    /* Take the first event of the highest class that has any. */
+    for(prio = prio_order; event_head[*prio] == EVENT_NONE; prio++);
+    fevent = event_head[*prio];
+#endif /* PROCESS_PRIORITIES */
+
     /* There are events that we should deliver. */
     ev = events[fevent].ev;
 
@@ -268,7 +344,16 @@ do_event(void)
 
     /* Since we have seen the new event, we move pointer upwards
        and decrease the number of events. */
+#if PROCESS_PRIORITIES
+    event_head[*prio] = events[fevent].next;
+    if(event_head[*prio] == EVENT_NONE) {
+      event_tail[*prio] = EVENT_NONE;
+    }
+    events[fevent].next = event_free;
+    event_free = fevent;
+#else /* PROCESS_PRIORITIES */
     fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
+#endif /* PROCESS_PRIORITIES */
     --nevents;
 
     /* If this is a broadcast event, we deliver it to all events, in
@@ -322,6 +407,9 @@ int
 process_post(struct process *p, process_event_t ev, process_data_t data)
 {
   process_num_events_t snum;
+#if PROCESS_PRIORITIES
+  unsigned char prio;
+#endif /* PROCESS_PRIORITIES */
 
   if(PROCESS_CURRENT() == NULL) {
     PRINTF("process_post: NULL process posts event %d to process '%s', nevents %d\n",
@@ -343,7 +431,21 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
     return PROCESS_ERR_FULL;
   }
 
+#if PROCESS_PRIORITIES
+  /* Broadcasts are queued in the normal class */
+  prio = p == PROCESS_BROADCAST ? PROCESS_PRIO_NORMAL : p->priority;
+  snum = event_free;
+  event_free = events[snum].next;
+  events[snum].next = EVENT_NONE;
+  if(event_tail[prio] == EVENT_NONE) {
+    event_head[prio] = snum;
+  } else {
+    events[event_tail[prio]].next = snum;
+  }
+  event_tail[prio] = snum;
+#else /* PROCESS_PRIORITIES */
   snum = (process_num_events_t)(fevent + nevents) % PROCESS_CONF_NUMEVENTS;
+#endif /* PROCESS_PRIORITIES */
   events[snum].ev = ev;
   events[snum].data = data;
   events[snum].p = p;
@@ -370,15 +472,57 @@ process_post_synch(struct process *p, process_event_t ev, process_data_t data)
 void
 process_poll(struct process *p)
 {
+#if PROCESS_PRIORITIES
+  int_master_status_t status;
+#endif /* PROCESS_PRIORITIES */
+
   if(p != NULL) {
     if(p->state == PROCESS_STATE_RUNNING ||
        p->state == PROCESS_STATE_CALLED) {
+#if PROCESS_PRIORITIES
+      /* May be called from an interrupt, and do_poll() takes the lists */
+      status = critical_enter();
+      if(!p->needspoll) {
+        p->pollnext = poll_list[p->priority];
+        poll_list[p->priority] = p;
+      }
+      p->needspoll = 1;
+      critical_exit(status);
+#else /* PROCESS_PRIORITIES */
       p->needspoll = 1;
+#endif /* PROCESS_PRIORITIES */
       poll_requested = 1;
     }
   }
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_PRIORITIES
+void
+process_set_priority(struct process *p, unsigned char priority)
+{
+  int_master_status_t status;
+  struct process **q;
+
+  if(priority >= PROCESS_PRIO_NUM || p->priority == priority) {
+    return;
+  }
+  status = critical_enter();
+  if(p->needspoll) {
+    /* Move a pending poll over to the new class */
+    for(q = &poll_list[p->priority]; *q != NULL; q = &(*q)->pollnext) {
+      if(*q == p) {
+        *q = p->pollnext;
+        p->pollnext = poll_list[priority];
+        poll_list[priority] = p;
+        break;
+      }
+    }
+  }
+  p->priority = priority;
+  critical_exit(status);
+}
+#endif /* PROCESS_PRIORITIES */
+/*---------------------------------------------------------------------------*/
 int
 process_is_running(struct process *p)
 {
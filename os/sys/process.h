@@ -88,6 +88,29 @@ typedef unsigned char process_num_events_t;
 #define PROCESS_CONF_NUMEVENTS 32
 #endif /* PROCESS_CONF_NUMEVENTS */
 
+/**
+ * When PROCESS_CONF_PRIORITIES is set to 1, every process belongs to a
+ * priority class. Polls and events for the high class are dispatched
+ * before those for the normal class, which in turn go before the
+ * background class. All classes share the PROCESS_CONF_NUMEVENTS event
+ * slots.
+ */
+#ifdef PROCESS_CONF_PRIORITIES
+#define PROCESS_PRIORITIES PROCESS_CONF_PRIORITIES
+#else
+#define PROCESS_PRIORITIES 0
+#endif /* PROCESS_CONF_PRIORITIES */
+
+/**
+ * \name Process priority classes
+ * @{
+ */
+#define PROCESS_PRIO_NORMAL     0 /**< Default for every process */
+#define PROCESS_PRIO_HIGH       1 /**< Latency-sensitive processing */
+#define PROCESS_PRIO_BACKGROUND 2 /**< Bulk work that may wait */
+#define PROCESS_PRIO_NUM        3
+/** @} */
+
 #define PROCESS_EVENT_NONE            0x80
 #define PROCESS_EVENT_INIT            0x81
 #define PROCESS_EVENT_POLL            0x82
@@ -323,6 +346,10 @@ struct process {
   PT_THREAD((* thread)(struct pt *, process_event_t, process_data_t));
   struct pt pt;
   unsigned char state, needspoll;
+#if PROCESS_PRIORITIES
+  unsigned char priority;
+  struct process *pollnext;
+#endif /* PROCESS_PRIORITIES */
 };
 
 /**
@@ -469,6 +496,20 @@ process_event_t process_alloc_event(void);
  */
 void process_poll(struct process *p);
 
+#if PROCESS_PRIORITIES
+/**
+ * Set the priority class of a process.
+ *
+ * Processes are in the #PROCESS_PRIO_NORMAL class unless moved with
+ * this function. Events already queued for the process are delivered
+ * in the class they were posted in.
+ *
+ * \param p A pointer to the process' process structure.
+ * \param priority One of the PROCESS_PRIO_ classes.
+ */
+void process_set_priority(struct process *p, unsigned char priority);
+#endif /* PROCESS_PRIORITIES */
+
 /** @} */
 
 /**
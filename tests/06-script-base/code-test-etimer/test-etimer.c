@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2026, agent <agent@local>.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "sys/int-master.h"
+
+static clock_time_t now;
+static struct etimer et_a;
+static struct etimer et_b;
+static struct etimer *fired[4];
+static clock_time_t fired_at[4];
+static int num_fired;
+
+PROCESS(test_process, "etimer test");
+/*---------------------------------------------------------------------------*/
+clock_time_t
+clock_time(void)
+{
+  return now;
+}
+/*---------------------------------------------------------------------------*/
+int_master_status_t
+int_master_read_and_disable(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+int_master_status_set(int_master_status_t status)
+{
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+    if(num_fired < 4) {
+      fired[num_fired] = data;
+      fired_at[num_fired] = now;
+      num_fired++;
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+run(void)
+{
+  while(process_run() > 0);
+}
+/*---------------------------------------------------------------------------*/
+/* Advance the clock tick by tick, servicing the timers */
+static void
+advance(clock_time_t ticks)
+{
+  while(ticks-- > 0) {
+    now++;
+    if(etimer_pending() && (int32_t)(now - etimer_next_expiration_time()) >= 0) {
+      etimer_request_poll();
+    }
+    run();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+check(const char *name, struct etimer *first, clock_time_t first_at,
+      struct etimer *second, clock_time_t second_at)
+{
+  if(num_fired != 2 || fired[0] != first || fired_at[0] != first_at ||
+     fired[1] != second || fired_at[1] != second_at) {
+    printf("test failed: %s\n", name);
+    return -1;
+  }
+  printf("- %s is OK\n", name);
+  num_fired = 0;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+main(void)
+{
+  now = 1000;
+  process_init();
+  process_start(&etimer_process, NULL);
+  process_start(&test_process, NULL);
+  run();
+
+  /* Timers fire in the order of their expiration times */
+  PROCESS_CONTEXT_BEGIN(&test_process);
+  etimer_set(&et_b, 20);
+  etimer_set(&et_a, 10);
+  PROCESS_CONTEXT_END(&test_process);
+  advance(30);
+  if(check("sorted expiration", &et_a, 1010, &et_b, 1020) < 0) {
+    return -1;
+  }
+
+  /*
+   * A timer that has expired but has not been serviced yet must not be
+   * held back by a timer that is set later with a later expiration.
+   */
+  PROCESS_CONTEXT_BEGIN(&test_process);
+  etimer_set(&et_a, 10);
+  PROCESS_CONTEXT_END(&test_process);
+  now += 100;
+  PROCESS_CONTEXT_BEGIN(&test_process);
+  etimer_set(&et_b, 2000);
+  PROCESS_CONTEXT_END(&test_process);
+  run();
+  advance(2000);
+  if(check("expired timer before a later one", &et_a, 1130, &et_b, 3130) < 0) {
+    return -1;
+  }
+
+  /* The same for a timer reset to an expiration in the past */
+  PROCESS_CONTEXT_BEGIN(&test_process);
+  etimer_set(&et_b, 2000);
+  et_a.timer.start = now - 50;
+  et_a.timer.interval = 20;
+  etimer_reset(&et_a);
+  PROCESS_CONTEXT_END(&test_process);
+  run();
+  advance(2000);
+  if(check("reset to a past expiration", &et_a, 3130, &et_b, 5130) < 0) {
+    return -1;
+  }
+
+  /* Expiration times that wrap around the clock are still sorted */
+  now = (clock_time_t)-15;
+  PROCESS_CONTEXT_BEGIN(&test_process);
+  etimer_set(&et_b, 30);
+  etimer_set(&et_a, 10);
+  PROCESS_CONTEXT_END(&test_process);
+  advance(40);
+  if(check("clock wrap", &et_a, (clock_time_t)-5, &et_b, 15) < 0) {
+    return -1;
+  }
+
+  printf("all tests passed\n");
+  return 0;
+}